@@ -0,0 +1,371 @@
+//! Throughput benchmarks for Cuprate's epee and Levin codecs.
+//!
+//! This decodes p2p traffic through [`MoneroWireCodec`] (Levin buckets and
+//! the `cuprate-wire` epee messages) and reports, per message type, the
+//! throughput (MB/second) and the allocations per decoded message.
+//!
+//! ```bash
+//! cargo run --release -p cuprate-codec-bench
+//! ```
+//!
+//! By default synthetic messages shaped like real traffic are decoded.
+//!
+//! Setting `CUPRATE_BENCH_CORPUS_DIR` to a directory will also replay every
+//! file in it. Each file should be the raw bytes received on one p2p
+//! connection, starting at the first bucket, e.g. one direction of a TCP
+//! stream exported from a packet capture as raw bytes.
+
+//---------------------------------------------------------------------------------------------------- Import
+use std::{
+    alloc::{GlobalAlloc, Layout, System},
+    collections::BTreeMap,
+    hint::black_box,
+    net::{Ipv4Addr, SocketAddrV4},
+    path::Path,
+    sync::atomic::{AtomicU64, Ordering},
+    time::{Duration, Instant},
+};
+
+use bytes::{Bytes, BytesMut};
+use rand::{rngs::StdRng, Rng, RngCore, SeedableRng};
+use tokio_util::codec::{Decoder, Encoder};
+
+use cuprate_levin::LevinMessage;
+use cuprate_wire::{
+    admin::{HandshakeRequest, HandshakeResponse, TimedSyncResponse},
+    common::{
+        BasicNodeData, BlockCompleteEntry, CoreSyncData, PeerListEntryBase, PeerSupportFlags,
+        TransactionBlobs,
+    },
+    protocol::{ChainResponse, GetObjectsResponse, NewFluffyBlock},
+    Message, MoneroWireCodec, ProtocolMessage, RequestMessage, ResponseMessage,
+};
+
+//---------------------------------------------------------------------------------------------------- Constants
+/// How long each corpus is replayed for.
+const DURATION: Duration = Duration::from_secs(2);
+
+/// Approximate size of each synthetic corpus.
+///
+/// Synthetic messages are repeated to this size, up to [`MAX_MESSAGES`] times.
+const CORPUS_SIZE: usize = 32 * 1024 * 1024;
+
+/// Maximum amount of times a synthetic message is repeated in its corpus.
+const MAX_MESSAGES: usize = 4_096;
+
+/// Amount of peers in handshake and timed sync responses, `monerod` sends up to 250.
+const PEERS: usize = 250;
+
+/// Amount of blocks in a `GetObjectsResponse`.
+const BLOCKS: usize = 100;
+
+/// Amount of transactions in each block of a `GetObjectsResponse`.
+const TXS_PER_BLOCK: usize = 20;
+
+/// Amount of block IDs in a `ChainResponse`.
+const BLOCK_IDS: usize = 10_000;
+
+/// Size of a synthetic block blob.
+const BLOCK_SIZE: usize = 2_000;
+
+/// Size of a synthetic transaction blob.
+const TX_SIZE: usize = 2_500;
+
+//---------------------------------------------------------------------------------------------------- Allocator
+/// Amount of allocations (and reallocations) made.
+static ALLOCATIONS: AtomicU64 = AtomicU64::new(0);
+
+/// Amount of bytes allocated.
+static ALLOCATED_BYTES: AtomicU64 = AtomicU64::new(0);
+
+/// The [`System`] allocator, counting allocations.
+struct CountingAllocator;
+
+// SAFETY: this only forwards to `System`.
+unsafe impl GlobalAlloc for CountingAllocator {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        ALLOCATIONS.fetch_add(1, Ordering::Relaxed);
+        ALLOCATED_BYTES.fetch_add(layout.size() as u64, Ordering::Relaxed);
+        System.alloc(layout)
+    }
+
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        System.dealloc(ptr, layout);
+    }
+
+    unsafe fn realloc(&self, ptr: *mut u8, layout: Layout, new_size: usize) -> *mut u8 {
+        ALLOCATIONS.fetch_add(1, Ordering::Relaxed);
+        ALLOCATED_BYTES.fetch_add(new_size as u64, Ordering::Relaxed);
+        System.realloc(ptr, layout, new_size)
+    }
+}
+
+#[global_allocator]
+static GLOBAL: CountingAllocator = CountingAllocator;
+
+//---------------------------------------------------------------------------------------------------- Main
+fn main() {
+    println!("synthetic:");
+    for (name, message) in synthetic_messages() {
+        let corpus = encode(message);
+        replay(name, &corpus);
+    }
+
+    if let Some(corpus_dir) = std::env::var_os("CUPRATE_BENCH_CORPUS_DIR") {
+        let mut files = std::fs::read_dir(&corpus_dir)
+            .unwrap()
+            .map(|entry| entry.unwrap().path())
+            .filter(|path| path.is_file())
+            .collect::<Vec<_>>();
+        files.sort();
+
+        for file in files {
+            println!("\nreplay: {}", file.display());
+            replay_file(&file);
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------- Replay
+/// Statistics of one message type.
+#[derive(Default)]
+struct Stats {
+    messages: u64,
+    bytes: u64,
+    time: Duration,
+    allocations: u64,
+    allocated_bytes: u64,
+}
+
+/// Replay a captured corpus file, printing the stats of every message type in it.
+fn replay_file(file: &Path) {
+    let corpus = std::fs::read(file).unwrap();
+
+    for (name, stats) in decode_for(&corpus, DURATION) {
+        print_stats(&name, &stats);
+    }
+}
+
+/// Replay a synthetic corpus, printing the stats of its messages.
+///
+/// The corpus starts with a handshake (to lift the pre-handshake
+/// size limit), which is not included in the stats.
+fn replay(name: &str, corpus: &[u8]) {
+    let stats = decode_for(corpus, DURATION)
+        .into_iter()
+        .filter(|(name, _)| name != "Handshake (request)")
+        .fold(Stats::default(), |mut total, (_, stats)| {
+            total.messages += stats.messages;
+            total.bytes += stats.bytes;
+            total.time += stats.time;
+            total.allocations += stats.allocations;
+            total.allocated_bytes += stats.allocated_bytes;
+            total
+        });
+
+    print_stats(name, &stats);
+}
+
+/// Decode `corpus` repeatedly, for at least `duration`.
+///
+/// Returns the stats of each message type.
+fn decode_for(corpus: &[u8], duration: Duration) -> BTreeMap<String, Stats> {
+    let mut stats = BTreeMap::<String, Stats>::new();
+
+    let start = Instant::now();
+    while start.elapsed() < duration {
+        let mut src = BytesMut::from(corpus);
+        let mut codec = MoneroWireCodec::default();
+
+        loop {
+            let len = src.len();
+            let allocations = ALLOCATIONS.load(Ordering::Relaxed);
+            let allocated_bytes = ALLOCATED_BYTES.load(Ordering::Relaxed);
+
+            let now = Instant::now();
+            let Some(message) = codec.decode(&mut src).unwrap() else {
+                // The rest of the corpus is an incomplete message.
+                break;
+            };
+            let time = now.elapsed();
+
+            let allocations = ALLOCATIONS.load(Ordering::Relaxed) - allocations;
+            let allocated_bytes = ALLOCATED_BYTES.load(Ordering::Relaxed) - allocated_bytes;
+
+            let entry = stats.entry(message_name(&message)).or_default();
+            entry.messages += 1;
+            entry.bytes += (len - src.len()) as u64;
+            entry.time += time;
+            entry.allocations += allocations;
+            entry.allocated_bytes += allocated_bytes;
+
+            black_box(message);
+        }
+    }
+
+    stats
+}
+
+/// Print one line of [`Stats`].
+#[allow(clippy::cast_precision_loss)]
+fn print_stats(name: &str, stats: &Stats) {
+    if stats.messages == 0 {
+        println!("{name:<32} no messages");
+        return;
+    }
+
+    let messages = stats.messages as f64;
+    let mb_per_second = stats.bytes as f64 / stats.time.as_secs_f64() / 1_000_000.0;
+
+    println!(
+        "{name:<32} {:>10.0} bytes/msg {mb_per_second:>10.1} MB/s {:>10.1} allocs/msg {:>12.0} alloc bytes/msg",
+        stats.bytes as f64 / messages,
+        stats.allocations as f64 / messages,
+        stats.allocated_bytes as f64 / messages,
+    );
+}
+
+/// The name of a message type, used to group stats.
+fn message_name(message: &Message) -> String {
+    let ty = match message {
+        Message::Request(_) => "request",
+        Message::Response(_) => "response",
+        Message::Protocol(_) => "notification",
+    };
+
+    format!("{:?} ({ty})", message.command())
+}
+
+//---------------------------------------------------------------------------------------------------- Synthetic messages
+/// Encode `message` into a corpus, after a handshake request.
+///
+/// The message is repeated to fill [`CORPUS_SIZE`].
+fn encode(message: Message) -> Bytes {
+    let mut codec = MoneroWireCodec::default();
+    let mut corpus = BytesMut::new();
+
+    let handshake = Message::Request(RequestMessage::Handshake(HandshakeRequest {
+        node_data: node_data(),
+        payload_data: core_sync_data(),
+    }));
+
+    codec
+        .encode(LevinMessage::Body(handshake), &mut corpus)
+        .unwrap();
+    let handshake_len = corpus.len();
+
+    codec
+        .encode(LevinMessage::Body(message), &mut corpus)
+        .unwrap();
+    let message = corpus.split_off(handshake_len).freeze();
+
+    let count = (CORPUS_SIZE / message.len()).clamp(1, MAX_MESSAGES);
+    for _ in 0..count {
+        corpus.extend_from_slice(&message);
+    }
+
+    corpus.freeze()
+}
+
+/// The synthetic messages benchmarked, and their names.
+fn synthetic_messages() -> Vec<(&'static str, Message)> {
+    let mut rng = StdRng::seed_from_u64(0x5EED);
+
+    vec![
+        (
+            "HandshakeResponse",
+            Message::Response(ResponseMessage::Handshake(HandshakeResponse {
+                node_data: node_data(),
+                payload_data: core_sync_data(),
+                local_peerlist_new: peer_list(&mut rng),
+            })),
+        ),
+        (
+            "TimedSyncResponse",
+            Message::Response(ResponseMessage::TimedSync(TimedSyncResponse {
+                payload_data: core_sync_data(),
+                local_peerlist_new: peer_list(&mut rng),
+            })),
+        ),
+        (
+            "NewFluffyBlock",
+            Message::Protocol(ProtocolMessage::NewFluffyBlock(NewFluffyBlock {
+                b: block_entry(&mut rng, 2),
+                current_blockchain_height: 3_000_000,
+            })),
+        ),
+        (
+            "GetObjectsResponse",
+            Message::Protocol(ProtocolMessage::GetObjectsResponse(GetObjectsResponse {
+                blocks: (0..BLOCKS)
+                    .map(|_| block_entry(&mut rng, TXS_PER_BLOCK))
+                    .collect(),
+                missed_ids: Vec::new().into(),
+                current_blockchain_height: 3_000_000,
+            })),
+        ),
+        (
+            "ChainResponse",
+            Message::Protocol(ProtocolMessage::ChainEntryResponse(ChainResponse {
+                start_height: 3_000_000,
+                total_height: 3_000_000 + BLOCK_IDS as u64,
+                cumulative_difficulty_low64: u64::MAX,
+                cumulative_difficulty_top64: 1,
+                m_block_ids: (0..BLOCK_IDS).map(|_| rng.gen()).collect::<Vec<_>>().into(),
+                m_block_weights: (0..BLOCK_IDS).map(|_| rng.gen_range(0..300_000)).collect(),
+                first_block: blob(&mut rng, BLOCK_SIZE),
+            })),
+        ),
+    ]
+}
+
+/// [`BasicNodeData`] of a mainnet node.
+fn node_data() -> BasicNodeData {
+    BasicNodeData {
+        my_port: 18080,
+        network_id: [
+            0x12, 0x30, 0xF1, 0x71, 0x61, 0x04, 0x41, 0x61, 0x17, 0x31, 0x00, 0x82, 0x16, 0xA1,
+            0xA1, 0x10,
+        ],
+        peer_id: 0x1234_5678_9ABC_DEF0,
+        support_flags: PeerSupportFlags::FLUFFY_BLOCKS,
+        rpc_port: 18089,
+        rpc_credits_per_hash: 0,
+    }
+}
+
+/// [`CoreSyncData`] of a synced node.
+fn core_sync_data() -> CoreSyncData {
+    CoreSyncData::new(u128::from(u64::MAX) * 3, 3_000_000, 0, [0xAA; 32], 16)
+}
+
+/// A full peer list.
+fn peer_list(rng: &mut StdRng) -> Vec<PeerListEntryBase> {
+    (0..PEERS)
+        .map(|_| PeerListEntryBase {
+            adr: SocketAddrV4::new(Ipv4Addr::from(rng.gen::<u32>()), 18080).into(),
+            id: rng.gen(),
+            last_seen: 1_700_000_000,
+            pruning_seed: 0,
+            rpc_port: 0,
+            rpc_credits_per_hash: 0,
+        })
+        .collect()
+}
+
+/// A block with `txs` transaction blobs.
+fn block_entry(rng: &mut StdRng, txs: usize) -> BlockCompleteEntry {
+    BlockCompleteEntry {
+        pruned: false,
+        block: blob(rng, BLOCK_SIZE),
+        block_weight: 0,
+        txs: TransactionBlobs::Normal((0..txs).map(|_| blob(rng, TX_SIZE)).collect()),
+    }
+}
+
+/// A random blob of `len` bytes.
+fn blob(rng: &mut StdRng, len: usize) -> Bytes {
+    let mut blob = vec![0; len];
+    rng.fill_bytes(&mut blob);
+    blob.into()
+}
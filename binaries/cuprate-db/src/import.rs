@@ -0,0 +1,686 @@
+//! `cuprate-db import-monerod`.
+//!
+//! Bulk import the blocks of a synced `monerod` LMDB database (`lmdb/data.mdb`)
+//! into Cuprate's database, without having to sync from the network.
+//!
+//! This reads the raw `monerod` tables and re-adds each block with
+//! [`add_block`], so Cuprate's tables are created exactly as if the
+//! blocks came from the network. The import is split into 3 stages:
+//!
+//! 1. Reading (main thread): block blobs, block metadata and transaction blobs
+//!    are read from `monerod` [`Args::blocks_per_tx`] blocks at a time
+//! 2. Transforming (`rayon` thread-pool): transactions are deserialized,
+//!    hashed and checked against their block in parallel
+//! 3. Writing (writer thread): each batch of blocks is added within
+//!    1 write transaction, using [`SyncMode::Fast`]
+//!
+//! Stage 1 & 2 for the next batch run while stage 3 writes the current one.
+//! Once all blocks are written, the database is fully synced to disk.
+//!
+//! # Trust
+//! `monerod`'s data is trusted, blocks are not re-verified by consensus.
+//! Only the block/transaction relations (hashes, heights) are checked.
+//!
+//! # Resuming
+//! Importing into a database that already contains blocks continues from
+//! its chain height, as long as its top block matches `monerod`'s block.
+//!
+//! # Limitations
+//! - `monerod` must not be running while importing
+//! - Pruned `monerod` databases cannot be imported, as
+//!   Cuprate stores full transaction blobs
+
+//---------------------------------------------------------------------------------------------------- Import
+use std::{
+    borrow::Cow,
+    path::{Path, PathBuf},
+    time::Instant,
+};
+
+use heed::{types::Bytes, Database, EnvFlags, EnvOpenOptions, RoTxn};
+use monero_serai::{block::Block, transaction::Transaction};
+use rayon::iter::{IntoParallelIterator, ParallelIterator};
+
+use cuprate_blockchain::{
+    config::ConfigBuilder,
+    cuprate_database::{
+        config::SyncMode, ConcreteEnv, DatabaseRo, Env, EnvInner, InitError, RuntimeError, TxRw,
+    },
+    ops::{block::add_block, blockchain::chain_height},
+    tables::Tables,
+    OpenTables,
+};
+use cuprate_types::{VerifiedBlockInformation, VerifiedTransactionInformation};
+
+//---------------------------------------------------------------------------------------------------- Constants
+/// The `monerod` database version this importer can read.
+///
+/// <https://github.com/monero-project/monero/blob/c8214782fb2a769c57382a999eaf099691c836e7/src/blockchain_db/lmdb/db_lmdb.cpp#L82>
+const MONEROD_DB_VERSION: u32 = 5;
+
+/// The maximum amount of named tables in a `monerod` database.
+const MONEROD_MAX_DBS: u32 = 32;
+
+/// The default [`Args::blocks_per_tx`].
+const DEFAULT_BLOCKS_PER_TX: u64 = 1_000;
+
+/// How many transformed batches can wait for the writer thread.
+const WRITE_QUEUE_LEN: usize = 2;
+
+//---------------------------------------------------------------------------------------------------- Args
+/// `import-monerod` arguments.
+#[derive(clap::Args)]
+pub struct Args {
+    /// The `monerod` LMDB directory, i.e. the directory containing `data.mdb`.
+    monerod_lmdb: PathBuf,
+
+    /// Stop importing before this height, by default all blocks are imported.
+    #[arg(long)]
+    to_height: Option<u64>,
+
+    /// The amount of blocks added per write transaction.
+    #[arg(long, default_value_t = DEFAULT_BLOCKS_PER_TX)]
+    blocks_per_tx: u64,
+}
+
+//---------------------------------------------------------------------------------------------------- ImportError
+/// Errors that can occur while importing.
+#[derive(Debug, thiserror::Error)]
+pub enum ImportError {
+    /// `monerod`'s database could not be read.
+    #[error("monerod database error: {0}")]
+    Monerod(#[from] heed::Error),
+
+    /// `monerod`'s database is not in the expected format.
+    #[error("invalid monerod database: {0}")]
+    InvalidMonerod(String),
+
+    /// Cuprate's database could not be opened.
+    #[error("failed to open the database: {0}")]
+    Init(#[from] InitError),
+
+    /// Cuprate's database returned an error.
+    #[error("database error: {0}")]
+    Database(#[from] RuntimeError),
+
+    /// A block or transaction could not be deserialized.
+    #[error("failed to deserialize block {height}: {error}")]
+    Deserialize {
+        /// The height of the block.
+        height: u64,
+        /// The deserialization error.
+        error: std::io::Error,
+    },
+}
+
+//---------------------------------------------------------------------------------------------------- Run
+/// Run `import-monerod`.
+///
+/// # Errors
+/// See [`ImportError`].
+pub fn run(db_directory: Option<PathBuf>, args: &Args) -> Result<(), ImportError> {
+    let monerod = Monerod::open(&args.monerod_lmdb)?;
+
+    let mut config = ConfigBuilder::new().sync_mode(SyncMode::Fast);
+    if let Some(db_directory) = db_directory {
+        config = config.db_directory(Cow::Owned(db_directory));
+    }
+    let env = cuprate_blockchain::open(config.build())?;
+
+    let rtxn = monerod.env.read_txn()?;
+    let monerod_height = monerod.blocks.len(&rtxn)?;
+    let end_height = args
+        .to_height
+        .map_or(monerod_height, |h| h.min(monerod_height));
+
+    // Resume from our current chain height.
+    let (start_height, first_tx_id) = {
+        let env_inner = env.env_inner();
+        let tx_ro = env_inner.tx_ro()?;
+        let tables = env_inner.open_tables(&tx_ro)?;
+        let height = chain_height(tables.block_heights())?;
+
+        if let Some(top_height) = height.checked_sub(1) {
+            let top_hash = tables.block_infos().get(&top_height)?.block_hash;
+            let monerod_info = monerod.block_infos(&rtxn, top_height)?.next().transpose()?;
+            if monerod_info.map(|info| info.hash) != Some(top_hash) {
+                return Err(ImportError::InvalidMonerod(format!(
+                    "block {top_height} is not the same as the database's top block"
+                )));
+            }
+        }
+
+        (height, tables.tx_ids().len()?)
+    };
+
+    if start_height >= end_height {
+        println!("nothing to import, chain height: {start_height}");
+        return Ok(());
+    }
+
+    println!("importing blocks {start_height}..{end_height}");
+    let start = Instant::now();
+
+    std::thread::scope(|scope| -> Result<(), ImportError> {
+        let (sender, receiver) =
+            crossbeam::channel::bounded::<Vec<VerifiedBlockInformation>>(WRITE_QUEUE_LEN);
+
+        let writer = scope.spawn(|| -> Result<(), ImportError> {
+            for batch in receiver {
+                write_batch(&env, &batch)?;
+
+                let height = batch.last().map_or(0, |block| block.height + 1);
+                println!(
+                    "imported {height}/{end_height} blocks ({:.0} blocks/s)",
+                    (height - start_height) as f64 / start.elapsed().as_secs_f64()
+                );
+            }
+            Ok(())
+        });
+
+        let read_result = monerod.read_batches(
+            &rtxn,
+            start_height..end_height,
+            first_tx_id,
+            args.blocks_per_tx.max(1),
+            |raw_blocks| {
+                let batch = raw_blocks
+                    .into_par_iter()
+                    .map(RawBlock::into_verified_block)
+                    .collect::<Result<Vec<_>, _>>()?;
+
+                // The writer hung up, its error is returned below.
+                Ok(sender.send(batch).is_ok())
+            },
+        );
+
+        drop(sender);
+        let write_result = writer.join().unwrap();
+
+        // Prefer the writer's error, the reader
+        // would have stopped because of it.
+        write_result.and(read_result)
+    })?;
+
+    println!("syncing database to disk");
+    env.sync()?;
+    println!(
+        "imported {} blocks in {:?}",
+        end_height - start_height,
+        start.elapsed()
+    );
+
+    Ok(())
+}
+
+/// Add all blocks in `batch` within 1 write transaction.
+///
+/// The database is resized and the transaction retried if needed.
+fn write_batch(env: &ConcreteEnv, batch: &[VerifiedBlockInformation]) -> Result<(), ImportError> {
+    loop {
+        let result = {
+            let env_inner = env.env_inner();
+            let tx_rw = env_inner.tx_rw()?;
+
+            let result = {
+                let mut tables_mut = env_inner.open_tables_mut(&tx_rw)?;
+                batch
+                    .iter()
+                    .try_for_each(|block| add_block(block, &mut tables_mut))
+            };
+
+            match result {
+                Ok(()) => TxRw::commit(tx_rw),
+                Err(e) => {
+                    TxRw::abort(tx_rw)?;
+                    Err(e)
+                }
+            }
+        };
+
+        match result {
+            Err(RuntimeError::ResizeNeeded) => {
+                env.resize_map(None);
+            }
+            result => return Ok(result?),
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------- Monerod
+/// A read-only handle to a `monerod` database.
+///
+/// Table layouts are from:
+/// <https://github.com/monero-project/monero/blob/c8214782fb2a769c57382a999eaf099691c836e7/src/blockchain_db/lmdb/db_lmdb.cpp#L145-L200>
+struct Monerod {
+    /// The database environment.
+    env: heed::Env,
+    /// `blocks`: block height (native `u64`) -> block blob.
+    blocks: Database<Bytes, Bytes>,
+    /// `block_info`: zero key -> duplicate [`MonerodBlockInfo`]s sorted by height.
+    block_info: Database<Bytes, Bytes>,
+    /// `txs_pruned`: transaction ID (native `u64`) -> pruned transaction blob.
+    txs_pruned: Database<Bytes, Bytes>,
+    /// `txs_prunable`: transaction ID (native `u64`) -> prunable transaction blob.
+    txs_prunable: Database<Bytes, Bytes>,
+}
+
+impl Monerod {
+    /// Open the `monerod` database in the `lmdb` directory, read-only.
+    fn open(lmdb: &Path) -> Result<Self, ImportError> {
+        let map_size = std::fs::metadata(lmdb.join("data.mdb"))
+            .map_err(|e| ImportError::InvalidMonerod(format!("{}: {e}", lmdb.display())))?
+            .len();
+
+        let mut env_open_options = EnvOpenOptions::new();
+        env_open_options.max_dbs(MONEROD_MAX_DBS);
+        env_open_options.map_size(usize::try_from(map_size).unwrap());
+
+        // SAFETY: the environment is opened read-only, and `monerod` must not be
+        // modifying it, see <https://docs.rs/heed/0.20.0/heed/struct.EnvOpenOptions.html#method.open>.
+        let env = unsafe {
+            env_open_options.flags(EnvFlags::READ_ONLY);
+            env_open_options.open(lmdb)?
+        };
+
+        let rtxn = env.read_txn()?;
+
+        let open = |name: &str| -> Result<Database<Bytes, Bytes>, ImportError> {
+            env.open_database(&rtxn, Some(name))?
+                .ok_or_else(|| ImportError::InvalidMonerod(format!("missing table: {name}")))
+        };
+
+        let properties = open("properties")?;
+        let blocks = open("blocks")?;
+        let block_info = open("block_info")?;
+        let txs_pruned = open("txs_pruned")?;
+        let txs_prunable = open("txs_prunable")?;
+
+        // `monerod` stores C strings, including the null terminator.
+        let version = properties
+            .get(&rtxn, b"version\0")?
+            .and_then(|v| v.try_into().ok())
+            .map(u32::from_ne_bytes);
+        if version != Some(MONEROD_DB_VERSION) {
+            return Err(ImportError::InvalidMonerod(format!(
+                "unsupported version: {version:?}, expected: {MONEROD_DB_VERSION}"
+            )));
+        }
+
+        drop(rtxn);
+
+        Ok(Self {
+            env,
+            blocks,
+            block_info,
+            txs_pruned,
+            txs_prunable,
+        })
+    }
+
+    /// Iterate over the [`MonerodBlockInfo`]s, starting at `height`.
+    ///
+    /// `block_info` uses a custom duplicate comparison function which cannot be
+    /// set here, so this walks the table in order instead of seeking to `height`.
+    fn block_infos<'t>(
+        &self,
+        rtxn: &'t RoTxn<'_>,
+        height: u64,
+    ) -> Result<impl Iterator<Item = Result<MonerodBlockInfo, ImportError>> + 't, ImportError> {
+        let mut expected_height = height;
+
+        #[allow(clippy::cast_possible_truncation)]
+        Ok(self
+            .block_info
+            .iter(rtxn)?
+            .skip(height as usize)
+            .map(move |result| {
+                let (_, value) = result?;
+                let info = MonerodBlockInfo::from_bytes(value)?;
+
+                if info.height != expected_height {
+                    return Err(ImportError::InvalidMonerod(format!(
+                        "expected block info for height {expected_height}, found {}",
+                        info.height
+                    )));
+                }
+                expected_height += 1;
+
+                Ok(info)
+            }))
+    }
+
+    /// Read the full transaction blob with `tx_id`.
+    ///
+    /// `monerod` stores transactions split into a pruned and prunable part.
+    fn tx_blob(&self, rtxn: &RoTxn<'_>, tx_id: u64) -> Result<Vec<u8>, ImportError> {
+        let key = tx_id.to_ne_bytes();
+
+        let pruned = self
+            .txs_pruned
+            .get(rtxn, &key)?
+            .ok_or_else(|| ImportError::InvalidMonerod(format!("missing transaction: {tx_id}")))?;
+        let prunable = self.txs_prunable.get(rtxn, &key)?.ok_or_else(|| {
+            ImportError::InvalidMonerod(format!(
+                "missing prunable data of transaction {tx_id}, pruned databases are not supported"
+            ))
+        })?;
+
+        let mut tx_blob = Vec::with_capacity(pruned.len() + prunable.len());
+        tx_blob.extend_from_slice(pruned);
+        tx_blob.extend_from_slice(prunable);
+        Ok(tx_blob)
+    }
+
+    /// Read blocks in `heights`, passing them to `f` in batches of `batch_len`.
+    ///
+    /// `first_tx_id` must be the ID of the miner transaction of the 1st block.
+    ///
+    /// Reading stops early if `f` returns `Ok(false)`.
+    fn read_batches(
+        &self,
+        rtxn: &RoTxn<'_>,
+        heights: std::ops::Range<u64>,
+        first_tx_id: u64,
+        batch_len: u64,
+        mut f: impl FnMut(Vec<RawBlock>) -> Result<bool, ImportError>,
+    ) -> Result<(), ImportError> {
+        let mut tx_id = first_tx_id;
+        let mut block_infos = self.block_infos(rtxn, heights.start)?;
+
+        // The cumulative generated coins of the block before `heights.start`.
+        let mut prev_coins = match heights.start.checked_sub(1) {
+            Some(height) => self
+                .block_infos(rtxn, height)?
+                .next()
+                .transpose()?
+                .map_or(0, |info| info.coins),
+            None => 0,
+        };
+
+        #[allow(clippy::cast_possible_truncation)]
+        let mut batch = Vec::with_capacity(batch_len as usize);
+
+        for height in heights.clone() {
+            let block_blob = self
+                .blocks
+                .get(rtxn, &height.to_ne_bytes())?
+                .ok_or_else(|| ImportError::InvalidMonerod(format!("missing block: {height}")))?
+                .to_vec();
+
+            let info = block_infos.next().ok_or_else(|| {
+                ImportError::InvalidMonerod(format!("missing block info: {height}"))
+            })??;
+
+            let block = Block::read(&mut block_blob.as_slice())
+                .map_err(|error| ImportError::Deserialize { height, error })?;
+
+            // The miner transaction is part of the block blob.
+            tx_id += 1;
+            let tx_blobs = (0..block.txs.len())
+                .map(|_| {
+                    let tx_blob = self.tx_blob(rtxn, tx_id);
+                    tx_id += 1;
+                    tx_blob
+                })
+                .collect::<Result<Vec<_>, _>>()?;
+
+            batch.push(RawBlock {
+                height,
+                block,
+                block_blob,
+                tx_blobs,
+                generated_coins: info.coins - prev_coins,
+                info,
+            });
+            prev_coins = info.coins;
+
+            if batch.len() as u64 == batch_len || height + 1 == heights.end {
+                if !f(std::mem::take(&mut batch))? {
+                    return Ok(());
+                }
+            }
+        }
+
+        Ok(())
+    }
+}
+
+/// `monerod`'s `mdb_block_info_4`, all integers are native endian.
+///
+/// <https://github.com/monero-project/monero/blob/c8214782fb2a769c57382a999eaf099691c836e7/src/blockchain_db/lmdb/db_lmdb.cpp#L291-L302>
+#[derive(Copy, Clone)]
+struct MonerodBlockInfo {
+    /// `bi_height`.
+    height: u64,
+    /// `bi_coins`, the cumulative generated coins.
+    coins: u64,
+    /// `bi_weight`.
+    weight: u64,
+    /// `bi_diff_lo`, the low 64 bits of the cumulative difficulty.
+    cumulative_difficulty_low: u64,
+    /// `bi_diff_hi`, the high 64 bits of the cumulative difficulty.
+    cumulative_difficulty_high: u64,
+    /// `bi_hash`.
+    hash: [u8; 32],
+    /// `bi_long_term_block_weight`.
+    long_term_weight: u64,
+}
+
+impl MonerodBlockInfo {
+    /// The byte size of `mdb_block_info_4`.
+    const SIZE: usize = 96;
+
+    /// Parse `mdb_block_info_4` bytes.
+    fn from_bytes(bytes: &[u8]) -> Result<Self, ImportError> {
+        if bytes.len() != Self::SIZE {
+            return Err(ImportError::InvalidMonerod(format!(
+                "block info is {} bytes, expected {}",
+                bytes.len(),
+                Self::SIZE
+            )));
+        }
+
+        let u64_at =
+            |offset: usize| u64::from_ne_bytes(bytes[offset..offset + 8].try_into().unwrap());
+
+        Ok(Self {
+            height: u64_at(0),
+            // 8: bi_timestamp, this is read from the block header.
+            coins: u64_at(16),
+            weight: u64_at(24),
+            cumulative_difficulty_low: u64_at(32),
+            cumulative_difficulty_high: u64_at(40),
+            hash: bytes[48..80].try_into().unwrap(),
+            // 80: bi_cum_rct, Cuprate calculates this itself.
+            long_term_weight: u64_at(88),
+        })
+    }
+}
+
+//---------------------------------------------------------------------------------------------------- RawBlock
+/// A block read from `monerod` with its transactions still serialized.
+struct RawBlock {
+    /// The block's height.
+    height: u64,
+    /// The block.
+    block: Block,
+    /// The block's blob.
+    block_blob: Vec<u8>,
+    /// The blobs of [`Block::txs`], in the same order.
+    tx_blobs: Vec<Vec<u8>>,
+    /// The coins generated in this block.
+    generated_coins: u64,
+    /// The block's metadata.
+    info: MonerodBlockInfo,
+}
+
+impl RawBlock {
+    /// Deserialize the transactions and create a [`VerifiedBlockInformation`].
+    ///
+    /// # Errors
+    /// Returns an error if a transaction fails to deserialize or
+    /// doesn't have the hash the block says it should.
+    fn into_verified_block(self) -> Result<VerifiedBlockInformation, ImportError> {
+        let height = self.height;
+
+        let txs = self
+            .tx_blobs
+            .into_iter()
+            .zip(&self.block.txs)
+            .map(|(tx_blob, expected_hash)| {
+                let tx = Transaction::read(&mut tx_blob.as_slice())
+                    .map_err(|error| ImportError::Deserialize { height, error })?;
+
+                let tx_hash = tx.hash();
+                if &tx_hash != expected_hash {
+                    return Err(ImportError::InvalidMonerod(format!(
+                        "transaction hash mismatch in block {height}"
+                    )));
+                }
+
+                Ok(VerifiedTransactionInformation {
+                    tx_weight: tx.weight(),
+                    fee: tx.rct_signatures.base.fee,
+                    tx_hash,
+                    tx_blob,
+                    tx,
+                })
+            })
+            .collect::<Result<Vec<_>, ImportError>>()?;
+
+        Ok(VerifiedBlockInformation {
+            block_hash: self.info.hash,
+            // Not stored in the database.
+            pow_hash: [0; 32],
+            height,
+            generated_coins: self.generated_coins,
+            weight: self.info.weight as usize,
+            long_term_weight: self.info.long_term_weight as usize,
+            cumulative_difficulty: u128::from(self.info.cumulative_difficulty_low)
+                | (u128::from(self.info.cumulative_difficulty_high) << 64),
+            block: self.block,
+            block_blob: self.block_blob,
+            txs,
+        })
+    }
+}
+
+//---------------------------------------------------------------------------------------------------- Tests
+#[cfg(test)]
+mod test {
+    use cuprate_test_utils::data::{block_v16_tx0, block_v9_tx3};
+
+    use super::*;
+
+    /// Serialize a [`MonerodBlockInfo`] the same way `monerod` does.
+    fn block_info_bytes(info: &MonerodBlockInfo) -> Vec<u8> {
+        let mut bytes = Vec::with_capacity(MonerodBlockInfo::SIZE);
+        bytes.extend_from_slice(&info.height.to_ne_bytes());
+        bytes.extend_from_slice(&u64::MAX.to_ne_bytes()); // bi_timestamp
+        bytes.extend_from_slice(&info.coins.to_ne_bytes());
+        bytes.extend_from_slice(&info.weight.to_ne_bytes());
+        bytes.extend_from_slice(&info.cumulative_difficulty_low.to_ne_bytes());
+        bytes.extend_from_slice(&info.cumulative_difficulty_high.to_ne_bytes());
+        bytes.extend_from_slice(&info.hash);
+        bytes.extend_from_slice(&u64::MAX.to_ne_bytes()); // bi_cum_rct
+        bytes.extend_from_slice(&info.long_term_weight.to_ne_bytes());
+        bytes
+    }
+
+    /// Create the [`RawBlock`] `monerod` would store for `block`.
+    fn raw_block(block: &VerifiedBlockInformation) -> RawBlock {
+        RawBlock {
+            height: block.height,
+            block: block.block.clone(),
+            block_blob: block.block_blob.clone(),
+            tx_blobs: block.txs.iter().map(|tx| tx.tx_blob.clone()).collect(),
+            generated_coins: block.generated_coins,
+            info: MonerodBlockInfo {
+                height: block.height,
+                coins: block.generated_coins,
+                weight: block.weight as u64,
+                cumulative_difficulty_low: block.cumulative_difficulty as u64,
+                cumulative_difficulty_high: (block.cumulative_difficulty >> 64) as u64,
+                hash: block.block_hash,
+                long_term_weight: block.long_term_weight as u64,
+            },
+        }
+    }
+
+    /// Assert [`MonerodBlockInfo::from_bytes`] reads each field from the right offset.
+    #[test]
+    fn block_info_from_bytes() {
+        let info = MonerodBlockInfo {
+            height: 1,
+            coins: 2,
+            weight: 3,
+            cumulative_difficulty_low: 4,
+            cumulative_difficulty_high: 5,
+            hash: [6; 32],
+            long_term_weight: 7,
+        };
+
+        let bytes = block_info_bytes(&info);
+        assert_eq!(bytes.len(), MonerodBlockInfo::SIZE);
+
+        let parsed = MonerodBlockInfo::from_bytes(&bytes).unwrap();
+        assert_eq!(parsed.height, info.height);
+        assert_eq!(parsed.coins, info.coins);
+        assert_eq!(parsed.weight, info.weight);
+        assert_eq!(
+            parsed.cumulative_difficulty_low,
+            info.cumulative_difficulty_low
+        );
+        assert_eq!(
+            parsed.cumulative_difficulty_high,
+            info.cumulative_difficulty_high
+        );
+        assert_eq!(parsed.hash, info.hash);
+        assert_eq!(parsed.long_term_weight, info.long_term_weight);
+    }
+
+    /// Assert [`MonerodBlockInfo::from_bytes`] rejects the wrong amount of bytes.
+    #[test]
+    fn block_info_wrong_size() {
+        for len in [0, MonerodBlockInfo::SIZE - 1, MonerodBlockInfo::SIZE + 1] {
+            assert!(matches!(
+                MonerodBlockInfo::from_bytes(&vec![0; len]),
+                Err(ImportError::InvalidMonerod(_))
+            ));
+        }
+    }
+
+    /// Assert [`RawBlock::into_verified_block`] recreates the block it was made from.
+    #[test]
+    fn into_verified_block() {
+        for block in [block_v9_tx3(), block_v16_tx0()] {
+            let mut expected = block.clone();
+            // `monerod` does not store the PoW hash.
+            expected.pow_hash = [0; 32];
+
+            assert_eq!(raw_block(block).into_verified_block().unwrap(), expected);
+        }
+    }
+
+    /// Assert [`RawBlock::into_verified_block`] rejects transactions that are
+    /// not the ones in the block, or that can't be deserialized.
+    #[test]
+    fn into_verified_block_invalid_txs() {
+        let block = block_v9_tx3();
+
+        let mut swapped = raw_block(block);
+        swapped.tx_blobs.swap(0, 1);
+        assert!(matches!(
+            swapped.into_verified_block(),
+            Err(ImportError::InvalidMonerod(_))
+        ));
+
+        let mut truncated = raw_block(block);
+        truncated.tx_blobs[0].truncate(8);
+        assert!(matches!(
+            truncated.into_verified_block(),
+            Err(ImportError::Deserialize { height, .. }) if height == block.height
+        ));
+    }
+}
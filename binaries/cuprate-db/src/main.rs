@@ -0,0 +1,66 @@
+//! `cuprate-db`, a tool for working with Cuprate's blockchain database.
+//!
+//! ```bash
+//! # Import the blocks of a synced `monerod` (which must not be running).
+//! cuprate-db import-monerod ~/.bitmonero/lmdb
+//!
+//! # Print the size and statistics of all tables.
+//! cuprate-db stats
+//! ```
+//!
+//! See `cuprate-db --help` for all commands.
+
+//---------------------------------------------------------------------------------------------------- Lints
+#![forbid(unsafe_op_in_unsafe_fn)]
+#![deny(unused_crate_dependencies, unused_mut, nonstandard_style)]
+
+//---------------------------------------------------------------------------------------------------- Import
+use std::{path::PathBuf, process::ExitCode};
+
+use clap::{Parser, Subcommand};
+
+mod import;
+mod stats;
+
+//---------------------------------------------------------------------------------------------------- CLI
+/// Cuprate's blockchain database tool.
+#[derive(Parser)]
+#[command(version, about, long_about = None)]
+struct Cli {
+    /// The Cuprate database directory, the default directory is used if not set.
+    #[arg(long, global = true)]
+    db_directory: Option<PathBuf>,
+
+    #[command(subcommand)]
+    command: Command,
+}
+
+/// All `cuprate-db` commands.
+#[derive(Subcommand)]
+enum Command {
+    /// Import the blocks of a synced `monerod` LMDB database.
+    ImportMonerod(import::Args),
+
+    /// Print database and per-table statistics.
+    Stats(stats::Args),
+}
+
+//---------------------------------------------------------------------------------------------------- Main
+fn main() -> ExitCode {
+    let cli = Cli::parse();
+
+    let result = match cli.command {
+        Command::ImportMonerod(args) => {
+            import::run(cli.db_directory, &args).map_err(|e| e.to_string())
+        }
+        Command::Stats(args) => stats::run(cli.db_directory, &args).map_err(|e| e.to_string()),
+    };
+
+    match result {
+        Ok(()) => ExitCode::SUCCESS,
+        Err(e) => {
+            eprintln!("error: {e}");
+            ExitCode::FAILURE
+        }
+    }
+}
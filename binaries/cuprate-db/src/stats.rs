@@ -0,0 +1,122 @@
+//! `cuprate-db stats`.
+//!
+//! Print the environment statistics and per-table statistics
+//! of Cuprate's database, e.g. to find which tables take up the
+//! most space or to measure the effect of a schema change.
+//!
+//! Values a backend does not track are printed as `-`.
+
+//---------------------------------------------------------------------------------------------------- Import
+use std::{borrow::Cow, path::PathBuf};
+
+use cuprate_blockchain::{
+    config::ConfigBuilder,
+    cuprate_database::{Env, EnvInner, InitError, RuntimeError, TableStats},
+    tables::Tables,
+    OpenTables,
+};
+
+//---------------------------------------------------------------------------------------------------- Args
+/// `stats` arguments.
+#[derive(clap::Args)]
+pub struct Args {
+    /// Sort the tables by name instead of by total pages.
+    #[arg(long)]
+    sort_by_name: bool,
+}
+
+//---------------------------------------------------------------------------------------------------- StatsError
+/// Errors that can occur while reading statistics.
+#[derive(Debug, thiserror::Error)]
+pub enum StatsError {
+    /// There is no database at the given path.
+    #[error("no database found at: {}", .0.display())]
+    NotFound(PathBuf),
+
+    /// Cuprate's database could not be opened.
+    #[error("failed to open the database: {0}")]
+    Init(#[from] InitError),
+
+    /// Cuprate's database returned an error.
+    #[error("database error: {0}")]
+    Database(#[from] RuntimeError),
+}
+
+//---------------------------------------------------------------------------------------------------- Run
+/// Run `cuprate-db stats`.
+///
+/// # Errors
+/// This returns an error if the database does not exist, or could not be opened or read.
+pub fn run(db_directory: Option<PathBuf>, args: &Args) -> Result<(), StatsError> {
+    let mut config = ConfigBuilder::new();
+    if let Some(db_directory) = db_directory {
+        config = config.db_directory(Cow::Owned(db_directory));
+    }
+    let config = config.build();
+
+    // Opening creates the database if it doesn't exist, which
+    // would print the statistics of a new empty database instead.
+    let db_file = config.db_config.db_file();
+    if !db_file.is_file() {
+        return Err(StatsError::NotFound(db_file.to_path_buf()));
+    }
+
+    let env = cuprate_blockchain::open(config)?;
+
+    let env_stats = env.stats()?;
+
+    let mut table_stats = {
+        let env_inner = env.env_inner();
+        let tx_ro = env_inner.tx_ro()?;
+        let tables = env_inner.open_tables(&tx_ro)?;
+        tables.all_tables_stats()?
+    };
+
+    if args.sort_by_name {
+        table_stats.sort_unstable_by_key(|(name, _)| *name);
+    } else {
+        table_stats.sort_unstable_by_key(|(_, stats)| std::cmp::Reverse(stats.pages()));
+    }
+
+    // TODO: use tracing.
+    println!("page size:       {}", env_stats.page_size);
+    println!("allocated pages: {}", env_stats.allocated_pages);
+    println!("used pages:      {}", env_stats.used_pages());
+    println!("free pages:      {}", env_stats.free_pages);
+    println!(
+        "map size:        {}",
+        env_stats
+            .map_size
+            .map_or_else(|| "-".to_string(), |m| m.to_string())
+    );
+    println!();
+
+    println!(
+        "{:<32} {:>12} {:>5} {:>10} {:>10} {:>10} {:>14}",
+        "table", "entries", "depth", "branch", "leaf", "overflow", "stored bytes"
+    );
+    for (name, stats) in &table_stats {
+        print_table(name, stats);
+    }
+
+    Ok(())
+}
+
+/// Print a single row of the table statistics.
+fn print_table(name: &str, stats: &TableStats) {
+    /// Print [`None`] as `-`.
+    fn opt(value: Option<u64>) -> String {
+        value.map_or_else(|| "-".to_string(), |v| v.to_string())
+    }
+
+    println!(
+        "{:<32} {:>12} {:>5} {:>10} {:>10} {:>10} {:>14}",
+        name,
+        stats.entries,
+        stats.depth,
+        stats.branch_pages,
+        stats.leaf_pages,
+        opt(stats.overflow_pages),
+        opt(stats.stored_bytes),
+    );
+}
@@ -8,10 +8,7 @@ use std::{
 };
 
 use futures::FutureExt;
-use monero_serai::{
-    block::Block,
-    transaction::{Input, Transaction},
-};
+use monero_serai::{block::Block, transaction::Input};
 use rayon::prelude::*;
 use tower::{Service, ServiceExt};
 use tracing::instrument;
@@ -26,7 +23,9 @@ use cuprate_consensus_rules::{
     ConsensusError, HardFork,
 };
 use cuprate_helper::asynch::rayon_spawn_async;
-use cuprate_types::{VerifiedBlockInformation, VerifiedTransactionInformation};
+use cuprate_types::{
+    UnverifiedBlockInformation, VerifiedBlockInformation, VerifiedTransactionInformation,
+};
 
 use crate::{
     context::{
@@ -67,6 +66,23 @@ impl PreparedBlockExPow {
     /// - Hard-fork values are invalid
     /// - Miner transaction is missing a miner input
     pub fn new(block: Block) -> Result<PreparedBlockExPow, ConsensusError> {
+        Self::new_hashed(block.serialize(), block.hash(), block)
+    }
+
+    /// Prepare a new block, using its already calculated blob and hash.
+    ///
+    /// `block_blob` and `block_hash` must be equal to [`Block::serialize`] and [`Block::hash`],
+    /// this is not checked.
+    ///
+    /// # Errors
+    /// This errors if either the `block`'s:
+    /// - Hard-fork values are invalid
+    /// - Miner transaction is missing a miner input
+    pub fn new_hashed(
+        block_blob: Vec<u8>,
+        block_hash: [u8; 32],
+        block: Block,
+    ) -> Result<PreparedBlockExPow, ConsensusError> {
         let (hf_version, hf_vote) =
             HardFork::from_block_header(&block.header).map_err(BlockError::HardForkError)?;
 
@@ -77,11 +93,11 @@ impl PreparedBlockExPow {
         };
 
         Ok(PreparedBlockExPow {
-            block_blob: block.serialize(),
+            block_blob,
             hf_vote,
             hf_version,
 
-            block_hash: block.hash(),
+            block_hash,
             height: *height,
 
             miner_tx_weight: block.miner_tx.weight(),
@@ -173,7 +189,7 @@ impl PreparedBlock {
                 &block.hf_version,
             )?,
 
-            miner_tx_weight: block.block.miner_tx.weight(),
+            miner_tx_weight: block.miner_tx_weight,
             block: block.block,
         })
     }
@@ -196,7 +212,9 @@ pub enum VerifyBlockRequest {
     /// Batch prepares a list of blocks and transactions for verification.
     MainChainBatchPrepareBlocks {
         /// The list of blocks and their transactions (not necessarily in the order given in the block).
-        blocks: Vec<(Block, Vec<Transaction>)>,
+        ///
+        /// The blobs and hashes in these are used as is, they are not calculated again.
+        blocks: Vec<UnverifiedBlockInformation>,
     },
 }
 
@@ -305,7 +323,7 @@ where
 /// Batch prepares a list of blocks for verification.
 #[instrument(level = "debug", name = "batch_prep_blocks", skip_all, fields(amt = blocks.len()))]
 async fn batch_prepare_main_chain_block<C>(
-    blocks: Vec<(Block, Vec<Transaction>)>,
+    blocks: Vec<UnverifiedBlockInformation>,
     mut context_svc: C,
 ) -> Result<VerifyBlockResponse, ExtendedConsensusError>
 where
@@ -317,13 +335,18 @@ where
         + 'static,
     C::Future: Send + 'static,
 {
-    let (blocks, txs): (Vec<_>, Vec<_>) = blocks.into_iter().unzip();
+    let (blocks, txs): (Vec<_>, Vec<_>) = blocks
+        .into_iter()
+        .map(|block| ((block.block_blob, block.block_hash, block.block), block.txs))
+        .unzip();
 
-    tracing::debug!("Calculating block hashes.");
+    tracing::debug!("Preparing blocks.");
     let blocks: Vec<PreparedBlockExPow> = rayon_spawn_async(|| {
         blocks
             .into_iter()
-            .map(PreparedBlockExPow::new)
+            .map(|(block_blob, block_hash, block)| {
+                PreparedBlockExPow::new_hashed(block_blob, block_hash, block)
+            })
             .collect::<Result<Vec<_>, _>>()
     })
     .await?;
@@ -468,7 +491,7 @@ where
                 let mut txs = txs
                     .into_par_iter()
                     .map(|tx| {
-                        let tx = TransactionVerificationData::new(tx)?;
+                        let tx = TransactionVerificationData::new_unverified(tx)?;
                         Ok::<_, ConsensusError>((tx.tx_hash, tx))
                     })
                     .collect::<Result<HashMap<_, _>, _>>()?;
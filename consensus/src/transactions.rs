@@ -28,7 +28,10 @@ use cuprate_consensus_rules::{
     ConsensusError, HardFork, TxVersion,
 };
 use cuprate_helper::asynch::rayon_spawn_async;
-use cuprate_types::blockchain::{BCReadRequest, BCResponse};
+use cuprate_types::{
+    blockchain::{BCReadRequest, BCResponse},
+    UnverifiedTransactionInformation,
+};
 
 use crate::{
     batch_verifier::MultiThreadedBatchVerifier,
@@ -100,8 +103,27 @@ pub struct TransactionVerificationData {
 impl TransactionVerificationData {
     /// Creates a new [`TransactionVerificationData`] from the given [`Transaction`].
     pub fn new(tx: Transaction) -> Result<TransactionVerificationData, ConsensusError> {
-        let tx_hash = tx.hash();
-        let tx_blob = tx.serialize();
+        Self::new_unverified(UnverifiedTransactionInformation {
+            tx_hash: tx.hash(),
+            tx_blob: tx.serialize(),
+            tx,
+        })
+    }
+
+    /// Creates a new [`TransactionVerificationData`] from an [`UnverifiedTransactionInformation`].
+    ///
+    /// This uses the already calculated blob and hash, instead of serialising and hashing `tx` again.
+    ///
+    /// The blob and hash must be equal to [`Transaction::serialize`] and [`Transaction::hash`],
+    /// this is not checked.
+    pub fn new_unverified(
+        tx: UnverifiedTransactionInformation,
+    ) -> Result<TransactionVerificationData, ConsensusError> {
+        let UnverifiedTransactionInformation {
+            tx,
+            tx_blob,
+            tx_hash,
+        } = tx;
 
         // the tx weight is only different from the blobs length for bp(+) txs.
         let tx_weight = match tx.rct_signatures.rct_type() {
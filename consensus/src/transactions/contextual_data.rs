@@ -153,22 +153,25 @@ pub async fn batch_get_ring_member_info<D: Database>(
             .map_err(ConsensusError::Transaction)?;
     }
 
-    let BCResponse::Outputs(outputs) = database
+    // The amounts we need the output count of are the
+    // same as the amounts of the outputs we request.
+    let amounts = output_ids.keys().copied().collect();
+
+    // Request both in the same batch, so they are from the same database snapshot.
+    let BCResponse::Batch(responses) = database
         .ready()
         .await?
-        .call(BCReadRequest::Outputs(output_ids))
+        .call(BCReadRequest::Batch(vec![
+            BCReadRequest::Outputs(output_ids),
+            BCReadRequest::NumberOutputsWithAmount(amounts),
+        ]))
         .await?
     else {
         panic!("Database sent incorrect response!")
     };
 
-    let BCResponse::NumberOutputsWithAmount(outputs_with_amount) = database
-        .ready()
-        .await?
-        .call(BCReadRequest::NumberOutputsWithAmount(
-            outputs.keys().copied().collect(),
-        ))
-        .await?
+    let [BCResponse::Outputs(outputs), BCResponse::NumberOutputsWithAmount(outputs_with_amount)] =
+        <[BCResponse; 2]>::try_from(responses).expect("Database sent incorrect response!")
     else {
         panic!("Database sent incorrect response!")
     };
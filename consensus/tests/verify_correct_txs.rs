@@ -23,29 +23,39 @@ use cuprate_test_utils::data::TX_E2D393;
 fn dummy_database(outputs: BTreeMap<u64, OutputOnChain>) -> impl Database + Clone {
     let outputs = Arc::new(outputs);
 
-    service_fn(move |req: BCReadRequest| {
-        ready(Ok(match req {
-            BCReadRequest::NumberOutputsWithAmount(_) => {
-                BCResponse::NumberOutputsWithAmount(HashMap::new())
-            }
-            BCReadRequest::Outputs(outs) => {
-                let idxs = outs.get(&0).unwrap();
-
-                let mut ret = HashMap::new();
-
-                ret.insert(
-                    0_u64,
-                    idxs.iter()
-                        .map(|idx| (*idx, *outputs.get(idx).unwrap()))
-                        .collect::<HashMap<_, _>>(),
-                );
-
-                BCResponse::Outputs(ret)
-            }
-            BCReadRequest::KeyImagesSpent(_) => BCResponse::KeyImagesSpent(false),
-            _ => panic!("Database request not needed for this test"),
-        }))
-    })
+    service_fn(move |req: BCReadRequest| ready(Ok(dummy_database_response(&outputs, req))))
+}
+
+fn dummy_database_response(
+    outputs: &BTreeMap<u64, OutputOnChain>,
+    req: BCReadRequest,
+) -> BCResponse {
+    match req {
+        BCReadRequest::NumberOutputsWithAmount(_) => {
+            BCResponse::NumberOutputsWithAmount(HashMap::new())
+        }
+        BCReadRequest::Outputs(outs) => {
+            let idxs = outs.get(&0).unwrap();
+
+            let mut ret = HashMap::new();
+
+            ret.insert(
+                0_u64,
+                idxs.iter()
+                    .map(|idx| (*idx, *outputs.get(idx).unwrap()))
+                    .collect::<HashMap<_, _>>(),
+            );
+
+            BCResponse::Outputs(ret)
+        }
+        BCReadRequest::KeyImagesSpent(_) => BCResponse::KeyImagesSpent(false),
+        BCReadRequest::Batch(reqs) => BCResponse::Batch(
+            reqs.into_iter()
+                .map(|req| dummy_database_response(outputs, req))
+                .collect(),
+        ),
+        _ => panic!("Database request not needed for this test"),
+    }
 }
 
 macro_rules! test_verify_valid_v2_tx {
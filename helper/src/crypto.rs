@@ -0,0 +1,148 @@
+//! Cryptographic related functions.
+//!
+//! This module provides functions for (cheaply) computing
+//! commonly used Monero cryptographic values.
+//!
+//! `std` is required.
+
+//---------------------------------------------------------------------------------------------------- Use
+use std::sync::OnceLock;
+
+use curve25519_dalek::{constants::ED25519_BASEPOINT_POINT, EdwardsPoint, Scalar};
+use monero_serai::H;
+
+//---------------------------------------------------------------------------------------------------- Decomposed amounts
+/// All decomposed amounts, in ascending order.
+///
+/// These are the output amounts that are `d * 10^n` where `d` is a single digit (`1..=9`).
+///
+/// ref: <https://monero-book.cuprate.org/consensus_rules/blocks/miner_tx.html#output-amounts>
+#[rustfmt::skip]
+pub const DECOMPOSED_AMOUNTS: [u64; 172] = [
+    1,                   2,                   3,                   4,                   5,                   6,                   7,                   8,                   9,
+    10,                  20,                  30,                  40,                  50,                  60,                  70,                  80,                  90,
+    100,                 200,                 300,                 400,                 500,                 600,                 700,                 800,                 900,
+    1000,                2000,                3000,                4000,                5000,                6000,                7000,                8000,                9000,
+    10000,               20000,               30000,               40000,               50000,               60000,               70000,               80000,               90000,
+    100000,              200000,              300000,              400000,              500000,              600000,              700000,              800000,              900000,
+    1000000,             2000000,             3000000,             4000000,             5000000,             6000000,             7000000,             8000000,             9000000,
+    10000000,            20000000,            30000000,            40000000,            50000000,            60000000,            70000000,            80000000,            90000000,
+    100000000,           200000000,           300000000,           400000000,           500000000,           600000000,           700000000,           800000000,           900000000,
+    1000000000,          2000000000,          3000000000,          4000000000,          5000000000,          6000000000,          7000000000,          8000000000,          9000000000,
+    10000000000,         20000000000,         30000000000,         40000000000,         50000000000,         60000000000,         70000000000,         80000000000,         90000000000,
+    100000000000,        200000000000,        300000000000,        400000000000,        500000000000,        600000000000,        700000000000,        800000000000,        900000000000,
+    1000000000000,       2000000000000,       3000000000000,       4000000000000,       5000000000000,       6000000000000,       7000000000000,       8000000000000,       9000000000000,
+    10000000000000,      20000000000000,      30000000000000,      40000000000000,      50000000000000,      60000000000000,      70000000000000,      80000000000000,      90000000000000,
+    100000000000000,     200000000000000,     300000000000000,     400000000000000,     500000000000000,     600000000000000,     700000000000000,     800000000000000,     900000000000000,
+    1000000000000000,    2000000000000000,    3000000000000000,    4000000000000000,    5000000000000000,    6000000000000000,    7000000000000000,    8000000000000000,    9000000000000000,
+    10000000000000000,   20000000000000000,   30000000000000000,   40000000000000000,   50000000000000000,   60000000000000000,   70000000000000000,   80000000000000000,   90000000000000000,
+    100000000000000000,  200000000000000000,  300000000000000000,  400000000000000000,  500000000000000000,  600000000000000000,  700000000000000000,  800000000000000000,  900000000000000000,
+    1000000000000000000, 2000000000000000000, 3000000000000000000, 4000000000000000000, 5000000000000000000, 6000000000000000000, 7000000000000000000, 8000000000000000000, 9000000000000000000,
+    10000000000000000000
+];
+
+//---------------------------------------------------------------------------------------------------- Zero commitments
+/// A zero commitment, in both point and compressed form.
+type ZeroCommitment = (EdwardsPoint, [u8; 32]);
+
+/// Lookup table of zero commitments for [`DECOMPOSED_AMOUNTS`].
+///
+/// Index `i` holds the commitment for `DECOMPOSED_AMOUNTS[i]`.
+///
+/// This is built on first use, see [`zero_commitment_table`].
+static ZERO_COMMITMENT_TABLE: OnceLock<[ZeroCommitment; 172]> = OnceLock::new();
+
+/// Get (or build) the [`ZERO_COMMITMENT_TABLE`].
+fn zero_commitment_table() -> &'static [ZeroCommitment; 172] {
+    ZERO_COMMITMENT_TABLE.get_or_init(|| {
+        DECOMPOSED_AMOUNTS.map(|amount| {
+            let commitment = compute_zero_commitment_uncached(amount);
+            (commitment, commitment.compress().to_bytes())
+        })
+    })
+}
+
+/// Lookup the table entry for `amount`, if it is a decomposed amount.
+#[inline]
+fn zero_commitment_lookup(amount: u64) -> Option<&'static ZeroCommitment> {
+    DECOMPOSED_AMOUNTS
+        .binary_search(&amount)
+        .ok()
+        .map(|i| &zero_commitment_table()[i])
+}
+
+/// Compute the zero commitment without the lookup table.
+#[inline]
+fn compute_zero_commitment_uncached(amount: u64) -> EdwardsPoint {
+    ED25519_BASEPOINT_POINT + H() * Scalar::from(amount)
+}
+
+/// Compute the zero commitment of `amount`, i.e. `G + H * amount`.
+///
+/// This is the commitment used for outputs with a
+/// plain amount, e.g. pre-RCT or RCT miner outputs.
+///
+/// [`DECOMPOSED_AMOUNTS`] (which almost all plain amounts are)
+/// are read from a lookup table instead of being computed.
+///
+/// ref: <https://github.com/monero-project/monero/blob/c8214782fb2a769c57382a999eaf099691c836e7/src/ringct/rctOps.cpp#L322>
+///
+/// ```rust
+/// # use cuprate_helper::crypto::*;
+/// # use curve25519_dalek::{constants::ED25519_BASEPOINT_POINT, Scalar};
+/// for amount in [0, 1, 2, 21, 900, u64::MAX] {
+///     let commitment = ED25519_BASEPOINT_POINT + monero_serai::H() * Scalar::from(amount);
+///     assert_eq!(compute_zero_commitment(amount), commitment);
+/// }
+/// ```
+#[inline]
+pub fn compute_zero_commitment(amount: u64) -> EdwardsPoint {
+    match zero_commitment_lookup(amount) {
+        Some((commitment, _)) => *commitment,
+        None => compute_zero_commitment_uncached(amount),
+    }
+}
+
+/// Same as [`compute_zero_commitment`] but returns the compressed commitment.
+///
+/// ```rust
+/// # use cuprate_helper::crypto::*;
+/// for amount in [0, 1, 2, 21, 900, u64::MAX] {
+///     let commitment = compute_zero_commitment(amount).compress().to_bytes();
+///     assert_eq!(compute_zero_commitment_compressed(amount), commitment);
+/// }
+/// ```
+#[inline]
+pub fn compute_zero_commitment_compressed(amount: u64) -> [u8; 32] {
+    match zero_commitment_lookup(amount) {
+        Some((_, compressed)) => *compressed,
+        None => compute_zero_commitment_uncached(amount)
+            .compress()
+            .to_bytes(),
+    }
+}
+
+//---------------------------------------------------------------------------------------------------- Tests
+#[cfg(test)]
+mod test {
+    use super::*;
+
+    /// [`DECOMPOSED_AMOUNTS`] must be sorted for the binary search.
+    #[test]
+    fn decomposed_amounts_sorted() {
+        assert!(DECOMPOSED_AMOUNTS.windows(2).all(|w| w[0] < w[1]));
+    }
+
+    /// The lookup table must match the computed commitments.
+    #[test]
+    fn zero_commitment_lookup_table() {
+        for amount in DECOMPOSED_AMOUNTS {
+            let commitment = compute_zero_commitment_uncached(amount);
+            assert_eq!(compute_zero_commitment(amount), commitment);
+            assert_eq!(
+                compute_zero_commitment_compressed(amount),
+                commitment.compress().to_bytes()
+            );
+        }
+    }
+}
@@ -69,6 +69,7 @@ pub const CUPRATE_DIR: &str = {
 /// - [`cuprate_config_dir()`]
 /// - [`cuprate_data_dir()`]
 /// - [`cuprate_blockchain_dir()`]
+/// - [`cuprate_txpool_dir()`]
 ///
 /// FIXME: Use `LazyLock` when stabilized.
 /// <https://github.com/rust-lang/rust/issues/109736>.
@@ -178,6 +179,19 @@ impl_path_oncelock_and_fn! {
     cuprate_blockchain_dir,
     data_dir,
     "blockchain",
+
+    /// Cuprate's transaction pool directory.
+    ///
+    /// This is the PATH used for any Cuprate txpool files.
+    ///
+    /// | OS      | PATH                                                       |
+    /// |---------|------------------------------------------------------------|
+    /// | Windows | `C:\Users\Alice\AppData\Roaming\Cuprate\txpool\`           |
+    /// | macOS   | `/Users/Alice/Library/Application Support/Cuprate/txpool/` |
+    /// | Linux   | `/home/alice/.local/share/cuprate/txpool/`                 |
+    cuprate_txpool_dir,
+    data_dir,
+    "txpool",
 }
 
 //---------------------------------------------------------------------------------------------------- Tests
@@ -196,6 +210,7 @@ mod test {
         assert!(cuprate_config_dir().is_absolute());
         assert!(cuprate_data_dir().is_absolute());
         assert!(cuprate_blockchain_dir().is_absolute());
+        assert!(cuprate_txpool_dir().is_absolute());
 
         if cfg!(target_os = "windows") {
             let dir = cuprate_cache_dir();
@@ -213,6 +228,10 @@ mod test {
             let dir = cuprate_blockchain_dir();
             println!("cuprate_blockchain_dir: {dir:?}");
             assert!(dir.ends_with(r"AppData\Roaming\Cuprate\blockchain"));
+
+            let dir = cuprate_txpool_dir();
+            println!("cuprate_txpool_dir: {dir:?}");
+            assert!(dir.ends_with(r"AppData\Roaming\Cuprate\txpool"));
         } else if cfg!(target_os = "macos") {
             let dir = cuprate_cache_dir();
             println!("cuprate_cache_dir: {dir:?}");
@@ -229,6 +248,10 @@ mod test {
             let dir = cuprate_blockchain_dir();
             println!("cuprate_blockchain_dir: {dir:?}");
             assert!(dir.ends_with("Library/Application Support/Cuprate/blockchain"));
+
+            let dir = cuprate_txpool_dir();
+            println!("cuprate_txpool_dir: {dir:?}");
+            assert!(dir.ends_with("Library/Application Support/Cuprate/txpool"));
         } else {
             // Assumes Linux.
             let dir = cuprate_cache_dir();
@@ -246,6 +269,10 @@ mod test {
             let dir = cuprate_blockchain_dir();
             println!("cuprate_blockchain_dir: {dir:?}");
             assert!(dir.ends_with(".local/share/cuprate/blockchain"));
+
+            let dir = cuprate_txpool_dir();
+            println!("cuprate_txpool_dir: {dir:?}");
+            assert!(dir.ends_with(".local/share/cuprate/txpool"));
         }
     }
 }
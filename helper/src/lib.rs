@@ -43,6 +43,9 @@ pub mod atomic;
 #[cfg(feature = "constants")]
 pub mod constants;
 
+#[cfg(feature = "crypto")]
+pub mod crypto;
+
 #[cfg(feature = "fs")]
 pub mod fs;
 
@@ -0,0 +1,168 @@
+//! `cuprate-epee-encoding` decoding benchmarks.
+//!
+//! ```bash
+//! cargo bench -p cuprate-epee-encoding --bench decode
+//! ```
+//!
+//! Each workload encodes a synthetic object once, then decodes it
+//! repeatedly from a [`Bytes`] and reports the throughput (MB/second)
+//! and the average time per decode.
+
+//---------------------------------------------------------------------------------------------------- Import
+use std::{
+    hint::black_box,
+    time::{Duration, Instant},
+};
+
+use bytes::Bytes;
+
+use cuprate_epee_encoding::{epee_object, from_bytes, to_bytes, EpeeObject};
+use cuprate_fixed_bytes::ByteArrayVec;
+
+//---------------------------------------------------------------------------------------------------- Constants
+/// Amount of block IDs in the chain entry workload, the most `monerod` sends in one `ChainResponse`.
+const BLOCK_IDS: u64 = 10_000;
+
+/// Amount of output indices in the output indices workload.
+const OUTPUT_INDICES: u64 = 100_000;
+
+/// Amount of objects in the object sequence workload.
+const OBJECTS: u64 = 10_000;
+
+/// How long each workload is ran for.
+const DURATION: Duration = Duration::from_secs(2);
+
+//---------------------------------------------------------------------------------------------------- Types
+/// A `ChainResponse`.
+struct ChainEntry {
+    start_height: u64,
+    total_height: u64,
+    m_block_ids: ByteArrayVec<32>,
+    m_block_weights: Vec<u64>,
+}
+
+epee_object!(
+    ChainEntry,
+    start_height: u64,
+    total_height: u64,
+    m_block_ids: ByteArrayVec<32>,
+    m_block_weights: Vec<u64>,
+);
+
+/// Output indices, as returned by the `get_o_indexes.bin` RPC call.
+struct OutputIndices {
+    indices: Vec<u64>,
+}
+
+epee_object!(
+    OutputIndices,
+    indices: Vec<u64>,
+);
+
+/// Hashes as a sequence of strings, instead of a single blob.
+struct Hashes {
+    hashes: Vec<[u8; 32]>,
+}
+
+epee_object!(
+    Hashes,
+    hashes: Vec<[u8; 32]>,
+);
+
+/// A small object, similar to a peer list entry.
+struct Entry {
+    id: u64,
+    last_seen: i64,
+    port: u16,
+    pruning_seed: u32,
+}
+
+epee_object!(
+    Entry,
+    id: u64,
+    last_seen: i64,
+    port: u16,
+    pruning_seed: u32,
+);
+
+/// A sequence of small objects.
+struct Entries {
+    entries: Vec<Entry>,
+}
+
+epee_object!(
+    Entries,
+    entries: Vec<Entry>,
+);
+
+//---------------------------------------------------------------------------------------------------- Main
+fn main() {
+    bench::<ChainEntry>(
+        "ChainEntry",
+        ChainEntry {
+            start_height: 3_000_000,
+            total_height: 3_000_000 + BLOCK_IDS,
+            m_block_ids: (0..BLOCK_IDS).map(hash).collect::<Vec<_>>().into(),
+            m_block_weights: (0..BLOCK_IDS).map(|i| 300_000 + i).collect(),
+        },
+    );
+
+    bench::<OutputIndices>(
+        "OutputIndices",
+        OutputIndices {
+            indices: (0..OUTPUT_INDICES).map(|i| i * 7).collect(),
+        },
+    );
+
+    bench::<Hashes>(
+        "Hashes",
+        Hashes {
+            hashes: (0..BLOCK_IDS).map(hash).collect(),
+        },
+    );
+
+    bench::<Entries>(
+        "Entries",
+        Entries {
+            entries: (0..OBJECTS)
+                .map(|i| Entry {
+                    id: i,
+                    last_seen: 1_700_000_000,
+                    port: 18080,
+                    pruning_seed: 384,
+                })
+                .collect(),
+        },
+    );
+}
+
+//---------------------------------------------------------------------------------------------------- Free functions
+/// Encode `val` once, then decode it for [`DURATION`] and print the throughput.
+fn bench<T: EpeeObject>(name: &str, val: T) {
+    let bytes: Bytes = to_bytes(val).unwrap().freeze();
+
+    let mut iterations = 0_u32;
+    let start = Instant::now();
+    while start.elapsed() < DURATION {
+        black_box(from_bytes::<T, _>(&mut bytes.clone()).unwrap());
+        iterations += 1;
+    }
+    let total = start.elapsed();
+
+    #[allow(clippy::cast_precision_loss)]
+    let mb_per_second =
+        (bytes.len() as f64 * f64::from(iterations)) / total.as_secs_f64() / 1_000_000.0;
+    let per_decode = total / iterations;
+
+    println!(
+        "{name:<16} {:>10} bytes {mb_per_second:>10.1} MB/s    {per_decode:>12.3?}/decode",
+        bytes.len()
+    );
+}
+
+/// A unique hash for `i`.
+fn hash(i: u64) -> [u8; 32] {
+    let mut hash = [0; 32];
+    hash[..8].copy_from_slice(&i.to_le_bytes());
+    hash
+}
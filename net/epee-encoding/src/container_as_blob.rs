@@ -49,6 +49,11 @@ impl<T: Containerable + EpeeValue> EpeeValue for ContainerAsBlob<T> {
         Some(ContainerAsBlob(vec![]))
     }
 
+    fn epee_size(&self) -> usize {
+        let len = self.0.len() * T::SIZE;
+        crate::varint_size(len as u64) + len
+    }
+
     fn write<B: BufMut>(self, w: &mut B) -> crate::Result<()> {
         let mut buf = BytesMut::with_capacity(self.0.len() * T::SIZE);
         self.0.iter().for_each(|tt| tt.push_bytes(&mut buf));
@@ -11,7 +11,11 @@ pub fn checked_read_primitive<B: Buf, R: Sized>(
 }
 
 #[inline]
-pub fn checked_read<B: Buf, R>(b: &mut B, read: impl Fn(&mut B) -> R, size: usize) -> Result<R> {
+pub fn checked_read<B: Buf, R>(
+    b: &mut B,
+    read: impl FnOnce(&mut B) -> R,
+    size: usize,
+) -> Result<R> {
     if b.remaining() < size {
         Err(Error::IO("Not enough bytes in buffer to build object."))?;
     }
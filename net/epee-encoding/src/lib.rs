@@ -8,7 +8,7 @@
 //!
 //! example without macro:
 //! ```rust
-//! # use cuprate_epee_encoding::{EpeeObject, EpeeObjectBuilder, read_epee_value, write_field, to_bytes, from_bytes};
+//! # use cuprate_epee_encoding::{EpeeObject, EpeeObjectBuilder, read_epee_value, write_field, field_size, to_bytes, from_bytes};
 //! # use bytes::{Buf, BufMut};
 //!
 //! pub struct Test {
@@ -45,6 +45,10 @@
 //!         1
 //!     }
 //!
+//!     fn size_of_fields(&self) -> usize {
+//!         field_size(&self.val, "val")
+//!     }
+//!
 //!     fn write_fields<B: BufMut>(self, w: &mut B) -> cuprate_epee_encoding::error::Result<()> {
 //!        // write the fields
 //!        write_field(self.val, "val", w)
@@ -61,9 +65,9 @@
 
 extern crate alloc;
 
-use core::{ops::Deref, str::from_utf8 as str_from_utf8};
+use core::str::from_utf8 as str_from_utf8;
 
-use bytes::{Buf, BufMut, Bytes, BytesMut};
+use bytes::{Buf, BufMut, BytesMut};
 
 pub mod container_as_blob;
 pub mod error;
@@ -77,7 +81,7 @@ pub use error::*;
 use io::*;
 pub use marker::{InnerMarker, Marker};
 pub use value::EpeeValue;
-pub use varint::{read_varint, write_varint};
+pub use varint::{read_varint, varint_size, write_varint};
 
 /// Header that needs to be at the beginning of every binary blob that follows
 /// this binary serialization format.
@@ -88,6 +92,8 @@ const MAX_STRING_LEN_POSSIBLE: u64 = 2000000000;
 const MAX_DEPTH_OF_SKIPPED_OBJECTS: u8 = 20;
 /// The maximum number of fields in an object.
 const MAX_NUM_FIELDS: u64 = 1000;
+/// The maximum length of a field name, the length is encoded in a single byte.
+const MAX_FIELD_NAME_LEN: usize = u8::MAX as usize;
 
 /// A trait for an object that can build a type `T` from the epee format.
 pub trait EpeeObjectBuilder<T>: Default + Sized {
@@ -109,26 +115,49 @@ pub trait EpeeObject: Sized {
     /// Returns the number of fields to be encoded.
     fn number_of_fields(&self) -> u64;
 
+    /// Returns the amount of bytes [`Self::write_fields`] will write.
+    ///
+    /// This is used to allocate the buffer once when encoding, see [`field_size`].
+    fn size_of_fields(&self) -> usize;
+
     /// write the objects fields into the writer.
     fn write_fields<B: BufMut>(self, w: &mut B) -> Result<()>;
 }
 
 /// Read the object `T` from a byte array.
+///
+/// Field names and the header are read without allocating.
+///
+/// [`Bytes`](bytes::Bytes) backed values ([`ByteArray`](cuprate_fixed_bytes::ByteArray),
+/// [`ByteArrayVec`](cuprate_fixed_bytes::ByteArrayVec), ...) are read with [`Buf::copy_to_bytes`],
+/// so when `buf` is a `Bytes` they are slices of it instead of copies.
 pub fn from_bytes<T: EpeeObject, B: Buf>(buf: &mut B) -> Result<T> {
     read_head_object(buf)
 }
 
 /// Turn the object into epee bytes.
+///
+/// The size of the encoded object is calculated first, so the buffer is only allocated once.
 pub fn to_bytes<T: EpeeObject>(val: T) -> Result<BytesMut> {
-    let mut buf = BytesMut::new();
+    let size = HEADER.len() + val.epee_size();
+
+    let mut buf = BytesMut::with_capacity(size);
     write_head_object(val, &mut buf)?;
+
+    debug_assert_eq!(
+        buf.len(),
+        size,
+        "Epee object size was calculated incorrectly"
+    );
+
     Ok(buf)
 }
 
 fn read_header<B: Buf>(r: &mut B) -> Result<()> {
-    let buf = checked_read(r, |b: &mut B| b.copy_to_bytes(HEADER.len()), HEADER.len())?;
+    let mut buf = [0; HEADER.len()];
+    checked_read(r, |b: &mut B| b.copy_to_slice(&mut buf), HEADER.len())?;
 
-    if buf.deref() != HEADER {
+    if buf != HEADER {
         return Err(Error::Format("Data does not contain header"));
     }
     Ok(())
@@ -149,10 +178,18 @@ fn read_head_object<T: EpeeObject, B: Buf>(r: &mut B) -> Result<T> {
     read_object(r, &mut skipped_objects)
 }
 
-fn read_field_name_bytes<B: Buf>(r: &mut B) -> Result<Bytes> {
-    let len: usize = r.get_u8().into();
-
-    checked_read(r, |b: &mut B| b.copy_to_bytes(len), len)
+/// Read a field name into `buf`, returning the part of `buf` that was filled.
+///
+/// Field names are at most [`u8::MAX`] bytes long, so they are read onto the stack.
+fn read_field_name_bytes<'a, B: Buf>(
+    r: &mut B,
+    buf: &'a mut [u8; MAX_FIELD_NAME_LEN],
+) -> Result<&'a [u8]> {
+    let len: usize = checked_read_primitive(r, Buf::get_u8)?.into();
+
+    let name = &mut buf[..len];
+    checked_read(r, |b: &mut B| b.copy_to_slice(name), len)?;
+    Ok(&buf[..len])
 }
 
 fn write_field_name<B: BufMut>(val: &str, w: &mut B) -> Result<()> {
@@ -181,9 +218,11 @@ fn read_object<T: EpeeObject, B: Buf>(r: &mut B, skipped_objects: &mut u8) -> Re
         ));
     }
 
+    let mut field_name_buf = [0; MAX_FIELD_NAME_LEN];
+
     for _ in 0..number_o_field {
-        let field_name_bytes = read_field_name_bytes(r)?;
-        let field_name = str_from_utf8(field_name_bytes.deref())?;
+        let field_name_bytes = read_field_name_bytes(r, &mut field_name_buf)?;
+        let field_name = str_from_utf8(field_name_bytes)?;
 
         if !object_builder.add_field(field_name, r)? {
             skip_epee_value(r, skipped_objects)?;
@@ -198,6 +237,25 @@ pub fn read_marker<B: Buf>(r: &mut B) -> Result<Marker> {
     Marker::try_from(checked_read_primitive(r, Buf::get_u8)?)
 }
 
+/// Returns the amount of bytes [`write_field`] writes for this field.
+///
+/// # Example
+/// ```rust
+/// let mut w = vec![];
+///
+/// cuprate_epee_encoding::write_field(5_u32, "val", &mut w).unwrap();
+///
+/// assert_eq!(cuprate_epee_encoding::field_size(&5_u32, "val"), w.len());
+/// ```
+pub fn field_size<T: EpeeValue>(val: &T, field_name: &str) -> usize {
+    if val.should_write() {
+        // The field name length, field name, marker and value.
+        1 + field_name.len() + 1 + val.epee_size()
+    } else {
+        0
+    }
+}
+
 /// Read an epee value from the stream, an epee value is the part after the key
 /// including the marker.
 pub fn read_epee_value<T: EpeeValue, B: Buf>(r: &mut B) -> Result<T> {
@@ -253,6 +311,12 @@ pub fn write_bytes<T: AsRef<[u8]>, B: BufMut>(t: T, w: &mut B) -> Result<()> {
     Ok(())
 }
 
+/// Returns the amount of bytes [`write_bytes`] writes for `t`.
+pub fn bytes_size<T: AsRef<[u8]>>(t: T) -> usize {
+    let len = t.as_ref().len();
+    varint_size(len as u64) + len
+}
+
 /// Write an [`Iterator`] of [`EpeeValue`]s to `w` with [`write_varint`].
 ///
 /// This function:
@@ -293,6 +357,15 @@ where
     Ok(())
 }
 
+/// Returns the amount of bytes [`write_iterator`] writes for the items of `iterator`.
+pub fn iterator_size<'a, T, I>(iterator: I) -> usize
+where
+    T: EpeeValue + 'a,
+    I: Iterator<Item = &'a T> + ExactSizeIterator,
+{
+    varint_size(iterator.len() as u64) + iterator.map(EpeeValue::epee_size).sum::<usize>()
+}
+
 /// A helper object builder that just skips every field.
 #[derive(Default)]
 struct SkipObjectBuilder;
@@ -317,6 +390,10 @@ impl EpeeObject for SkipObject {
         panic!("This is a helper function to use when de-serialising")
     }
 
+    fn size_of_fields(&self) -> usize {
+        panic!("This is a helper function to use when de-serialising")
+    }
+
     fn write_fields<B: BufMut>(self, _w: &mut B) -> Result<()> {
         panic!("This is a helper function to use when de-serialising")
     }
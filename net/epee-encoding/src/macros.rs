@@ -58,9 +58,9 @@ pub use paste::paste;
 ///         b: u8 = 0,
 ///         // `as ALT-TYPE` encodes the data using the alt type, the alt type must impl Into<Type> and From<&Type>
 ///         c: u8 as u8,
-///         // `=> read_fn, write_fn, should_write_fn,` allows you to specify alt field encoding functions.
+///         // `=> read_fn, write_fn, should_write_fn, size_fn,` allows you to specify alt field encoding functions.
 ///         //  for the required args see the default functions, which are used here:
-///         d: u8 => cuprate_epee_encoding::read_epee_value, cuprate_epee_encoding::write_field, <u8 as cuprate_epee_encoding::EpeeValue>::should_write,
+///         d: u8 => cuprate_epee_encoding::read_epee_value, cuprate_epee_encoding::write_field, <u8 as cuprate_epee_encoding::EpeeValue>::should_write, cuprate_epee_encoding::field_size,
 ///         // `!flatten` can be used on fields which are epee objects, and it flattens the fields of that object into this object.
 ///         // So for this example `e_f` will not appear in the data but e will.
 ///         // You can't use the other options with this.
@@ -122,7 +122,7 @@ macro_rules! epee_object {
     // ------------------------------------------------------------------------ Entry Point
     (
         $obj:ident,
-        $($field: ident $(($alt_name: literal))?: $ty:ty $(as $ty_as:ty )? $(= $default:expr)?  $(=> $read_fn:expr, $write_fn:expr, $should_write_fn:expr)?, )*
+        $($field: ident $(($alt_name: literal))?: $ty:ty $(as $ty_as:ty )? $(= $default:expr)?  $(=> $read_fn:expr, $write_fn:expr, $should_write_fn:expr, $size_fn:expr)?, )*
         $(!flatten: $flat_field: ident: $flat_ty:ty ,)*
 
     ) => {
@@ -209,6 +209,25 @@ macro_rules! epee_object {
                     fields
                 }
 
+                fn size_of_fields(&self) -> usize {
+                    let mut size = 0;
+
+                    $(
+                    let field = cuprate_epee_encoding::epee_object!(@internal_try_right_then_left &self.$field, $(<&$ty_as>::from(&self.$field))? );
+
+                      if $((field) != &$default &&)? cuprate_epee_encoding::epee_object!(@internal_try_right_then_left cuprate_epee_encoding::EpeeValue::should_write, $($should_write_fn)?)(field )
+                      {
+                          size += cuprate_epee_encoding::epee_object!(@internal_try_right_then_left cuprate_epee_encoding::field_size, $($size_fn)?)(field, cuprate_epee_encoding::epee_object!(@internal_field_name$field, $($alt_name)?));
+                      }
+                    )*
+
+                    $(
+                        size += self.$flat_field.size_of_fields();
+                    )*
+
+                    size
+                }
+
                 fn write_fields<B: cuprate_epee_encoding::macros::bytes::BufMut>(self, w: &mut B) -> cuprate_epee_encoding::error::Result<()> {
                     $(
                     let field = cuprate_epee_encoding::epee_object!(@internal_try_right_then_left self.$field, $(<$ty_as>::from(self.$field))? );
@@ -9,8 +9,10 @@ use bytes::{Buf, BufMut, Bytes, BytesMut};
 use cuprate_fixed_bytes::{ByteArray, ByteArrayVec};
 
 use crate::{
+    bytes_size,
     io::{checked_read_primitive, checked_write_primitive},
-    varint::{read_varint, write_varint},
+    iterator_size,
+    varint::{read_varint, varint_size, write_varint},
     write_bytes, write_iterator, EpeeObject, Error, InnerMarker, Marker, Result,
     MAX_STRING_LEN_POSSIBLE,
 };
@@ -36,6 +38,9 @@ pub trait EpeeValue: Sized {
         None
     }
 
+    /// Returns the amount of bytes [`EpeeValue::write`] will write.
+    fn epee_size(&self) -> usize;
+
     fn write<B: BufMut>(self, w: &mut B) -> Result<()>;
 }
 
@@ -51,6 +56,10 @@ impl<T: EpeeObject> EpeeValue for T {
         crate::read_object(r, &mut skipped_objects)
     }
 
+    fn epee_size(&self) -> usize {
+        varint_size(self.number_of_fields()) + self.size_of_fields()
+    }
+
     fn write<B: BufMut>(self, w: &mut B) -> Result<()> {
         write_varint(self.number_of_fields(), w)?;
         self.write_fields(w)
@@ -85,6 +94,10 @@ impl<T: EpeeObject> EpeeValue for Vec<T> {
         Some(Vec::new())
     }
 
+    fn epee_size(&self) -> usize {
+        iterator_size(self.iter())
+    }
+
     fn write<B: BufMut>(self, w: &mut B) -> Result<()> {
         write_iterator(self.into_iter(), w)
     }
@@ -103,13 +116,41 @@ impl<T: EpeeObject + Debug, const N: usize> EpeeValue for [T; N] {
         Ok(vec.try_into().unwrap())
     }
 
+    fn epee_size(&self) -> usize {
+        iterator_size(self.iter())
+    }
+
     fn write<B: BufMut>(self, w: &mut B) -> Result<()> {
         write_iterator(self.into_iter(), w)
     }
 }
 
+/// A fixed size number, that can be read in bulk by [`read_numb_seq`].
+trait EpeeNumb: EpeeValue {
+    /// The size of the number in bytes.
+    const SIZE: usize;
+
+    /// Read the number from `bytes`, which is [`Self::SIZE`] long.
+    fn from_le_slice(bytes: &[u8]) -> Self;
+
+    /// Read the number from `r`, which has [`Self::SIZE`] bytes remaining.
+    fn get_le<B: Buf>(r: &mut B) -> Self;
+}
+
 macro_rules! epee_numb {
     ($numb:ty, $marker:ident, $read_fn:ident, $write_fn:ident) => {
+        impl EpeeNumb for $numb {
+            const SIZE: usize = core::mem::size_of::<$numb>();
+
+            fn from_le_slice(bytes: &[u8]) -> Self {
+                <$numb>::from_le_bytes(bytes.try_into().unwrap())
+            }
+
+            fn get_le<B: Buf>(r: &mut B) -> Self {
+                r.$read_fn()
+            }
+        }
+
         impl EpeeValue for $numb {
             const MARKER: Marker = Marker::new(InnerMarker::$marker);
 
@@ -121,6 +162,10 @@ macro_rules! epee_numb {
                 checked_read_primitive(r, Buf::$read_fn)
             }
 
+            fn epee_size(&self) -> usize {
+                core::mem::size_of::<$numb>()
+            }
+
             fn write<B: BufMut>(self, w: &mut B) -> Result<()> {
                 checked_write_primitive(w, BufMut::$write_fn, self)
             }
@@ -149,6 +194,10 @@ impl EpeeValue for bool {
         Ok(checked_read_primitive(r, Buf::get_u8)? != 0)
     }
 
+    fn epee_size(&self) -> usize {
+        1
+    }
+
     fn write<B: BufMut>(self, w: &mut B) -> Result<()> {
         checked_write_primitive(w, BufMut::put_u8, if self { 1 } else { 0 })
     }
@@ -185,6 +234,10 @@ impl EpeeValue for Vec<u8> {
         !self.is_empty()
     }
 
+    fn epee_size(&self) -> usize {
+        bytes_size(self)
+    }
+
     fn write<B: BufMut>(self, w: &mut B) -> Result<()> {
         write_bytes(self, w)
     }
@@ -218,6 +271,10 @@ impl EpeeValue for Bytes {
         !self.is_empty()
     }
 
+    fn epee_size(&self) -> usize {
+        bytes_size(self)
+    }
+
     fn write<B: BufMut>(self, w: &mut B) -> Result<()> {
         write_bytes(self, w)
     }
@@ -254,6 +311,10 @@ impl EpeeValue for BytesMut {
         !self.is_empty()
     }
 
+    fn epee_size(&self) -> usize {
+        bytes_size(self)
+    }
+
     fn write<B: BufMut>(self, w: &mut B) -> Result<()> {
         write_bytes(self, w)
     }
@@ -288,6 +349,11 @@ impl<const N: usize> EpeeValue for ByteArrayVec<N> {
         !self.is_empty()
     }
 
+    fn epee_size(&self) -> usize {
+        let len = self.len() * N;
+        varint_size(len as u64) + len
+    }
+
     fn write<B: BufMut>(self, w: &mut B) -> Result<()> {
         let bytes = self.take_bytes();
         write_bytes(bytes, w)
@@ -315,6 +381,10 @@ impl<const N: usize> EpeeValue for ByteArray<N> {
             .map_err(|_| Error::Format("Field has invalid length"))
     }
 
+    fn epee_size(&self) -> usize {
+        varint_size(N as u64) + N
+    }
+
     fn write<B: BufMut>(self, w: &mut B) -> Result<()> {
         let bytes = self.take_bytes();
         write_bytes(bytes, w)
@@ -337,6 +407,10 @@ impl EpeeValue for String {
         Some(String::new())
     }
 
+    fn epee_size(&self) -> usize {
+        bytes_size(self)
+    }
+
     fn write<B: BufMut>(self, w: &mut B) -> Result<()> {
         write_bytes(self, w)
     }
@@ -346,13 +420,27 @@ impl<const N: usize> EpeeValue for [u8; N] {
     const MARKER: Marker = Marker::new(InnerMarker::String);
 
     fn read<B: Buf>(r: &mut B, marker: &Marker) -> Result<Self> {
-        let bytes = Vec::<u8>::read(r, marker)?;
+        if marker != &Self::MARKER {
+            return Err(Error::Format("Marker does not match expected Marker"));
+        }
 
-        if bytes.len() != N {
+        let len = read_varint(r)?;
+        if len != N as u64 {
             return Err(Error::Format("Byte array has incorrect length"));
         }
 
-        Ok(bytes.try_into().unwrap())
+        if r.remaining() < N {
+            return Err(Error::IO("Not enough bytes to fill object"));
+        }
+
+        let mut res = [0; N];
+        r.copy_to_slice(&mut res);
+
+        Ok(res)
+    }
+
+    fn epee_size(&self) -> usize {
+        bytes_size(self)
     }
 
     fn write<B: BufMut>(self, w: &mut B) -> Result<()> {
@@ -389,32 +477,96 @@ impl<const N: usize> EpeeValue for Vec<[u8; N]> {
         Some(Vec::new())
     }
 
+    fn epee_size(&self) -> usize {
+        iterator_size(self.iter())
+    }
+
     fn write<B: BufMut>(self, w: &mut B) -> Result<()> {
         write_iterator(self.into_iter(), w)
     }
 }
 
+/// Read a sequence of [`EpeeValue`]s one at a time.
+fn read_seq<T: EpeeValue, B: Buf>(r: &mut B, marker: &Marker) -> Result<Vec<T>> {
+    if !marker.is_seq {
+        return Err(Error::Format(
+            "Marker is not sequence when a sequence was expected",
+        ));
+    }
+
+    let len = read_varint(r)?;
+
+    let individual_marker = Marker::new(marker.inner_marker);
+
+    let mut res = Vec::with_capacity(len.try_into()?);
+    for _ in 0..len {
+        res.push(T::read(r, &individual_marker)?);
+    }
+    Ok(res)
+}
+
+/// Read a sequence of numbers in bulk.
+///
+/// Numbers are fixed size, so the whole sequence can be bounds checked up front
+/// and then converted straight from the contiguous chunks of `r`.
+fn read_numb_seq<T: EpeeNumb, B: Buf>(r: &mut B, marker: &Marker) -> Result<Vec<T>> {
+    if !marker.is_seq {
+        return Err(Error::Format(
+            "Marker is not sequence when a sequence was expected",
+        ));
+    }
+
+    let len: usize = read_varint(r)?.try_into()?;
+
+    // The marker of a zero length sequence is not checked, see `read_seq`.
+    if len == 0 {
+        return Ok(Vec::new());
+    }
+
+    if Marker::new(marker.inner_marker) != T::MARKER {
+        return Err(Error::Format("Marker does not match expected Marker"));
+    }
+
+    let size = len
+        .checked_mul(T::SIZE)
+        .ok_or(Error::Value("List is too big".to_string()))?;
+
+    if r.remaining() < size {
+        return Err(Error::IO("Not enough bytes to fill object"));
+    }
+
+    let mut res = Vec::with_capacity(len);
+    while res.len() < len {
+        let chunk = r.chunk();
+        let count = (chunk.len() / T::SIZE).min(len - res.len());
+
+        if count == 0 {
+            // The next number is split across chunks.
+            res.push(T::get_le(r));
+            continue;
+        }
+
+        res.extend(
+            chunk[..count * T::SIZE]
+                .chunks_exact(T::SIZE)
+                .map(T::from_le_slice),
+        );
+        r.advance(count * T::SIZE);
+    }
+
+    Ok(res)
+}
+
 macro_rules! epee_seq {
     ($val:ty) => {
+        epee_seq!($val, read_seq);
+    };
+    ($val:ty, $read_seq:ident) => {
         impl EpeeValue for Vec<$val> {
             const MARKER: Marker = <$val>::MARKER.into_seq();
 
             fn read<B: Buf>(r: &mut B, marker: &Marker) -> Result<Self> {
-                if !marker.is_seq {
-                    return Err(Error::Format(
-                        "Marker is not sequence when a sequence was expected",
-                    ));
-                }
-
-                let len = read_varint(r)?;
-
-                let individual_marker = Marker::new(marker.inner_marker.clone());
-
-                let mut res = Vec::with_capacity(len.try_into()?);
-                for _ in 0..len {
-                    res.push(<$val>::read(r, &individual_marker)?);
-                }
-                Ok(res)
+                $read_seq(r, marker)
             }
 
             fn should_write(&self) -> bool {
@@ -425,6 +577,10 @@ macro_rules! epee_seq {
                 Some(Vec::new())
             }
 
+            fn epee_size(&self) -> usize {
+                iterator_size(self.iter())
+            }
+
             fn write<B: BufMut>(self, w: &mut B) -> Result<()> {
                 write_iterator(self.into_iter(), w)
             }
@@ -443,6 +599,10 @@ macro_rules! epee_seq {
                 Ok(vec.try_into().unwrap())
             }
 
+            fn epee_size(&self) -> usize {
+                iterator_size(self.iter())
+            }
+
             fn write<B: BufMut>(self, w: &mut B) -> Result<()> {
                 write_iterator(self.into_iter(), w)
             }
@@ -450,14 +610,14 @@ macro_rules! epee_seq {
     };
 }
 
-epee_seq!(i64);
-epee_seq!(i32);
-epee_seq!(i16);
-epee_seq!(i8);
-epee_seq!(u64);
-epee_seq!(u32);
-epee_seq!(u16);
-epee_seq!(f64);
+epee_seq!(i64, read_numb_seq);
+epee_seq!(i32, read_numb_seq);
+epee_seq!(i16, read_numb_seq);
+epee_seq!(i8, read_numb_seq);
+epee_seq!(u64, read_numb_seq);
+epee_seq!(u32, read_numb_seq);
+epee_seq!(u16, read_numb_seq);
+epee_seq!(f64, read_numb_seq);
 epee_seq!(bool);
 epee_seq!(Vec<u8>);
 epee_seq!(String);
@@ -482,6 +642,13 @@ impl<T: EpeeValue> EpeeValue for Option<T> {
         Some(None)
     }
 
+    fn epee_size(&self) -> usize {
+        match self {
+            Some(t) => t.epee_size(),
+            None => 0,
+        }
+    }
+
     fn write<B: BufMut>(self, w: &mut B) -> Result<()> {
         match self {
             Some(t) => t.write(w)?,
@@ -20,6 +20,16 @@ const FITS_IN_FOUR_BYTES: u64 = 2_u64.pow(32 - SIZE_OF_SIZE_MARKER) - 1;
 /// assert_eq!(read_varint(&mut [3, 0, 0, 0, 1, 0, 0, 0].as_slice()).unwrap(), 1_073_741_824);
 /// ```
 pub fn read_varint<B: Buf>(r: &mut B) -> Result<u64> {
+    // Fast path: if the next 8 bytes are contiguous, the varint can be read
+    // from a single little endian load, masked down to its length.
+    if let Some(bytes) = r.chunk().get(..8) {
+        let raw = u64::from_le_bytes(bytes.try_into().unwrap());
+        let len = 1_usize << (raw & 0b11);
+
+        r.advance(len);
+        return Ok((raw & (u64::MAX >> (64 - len * 8))) >> 2);
+    }
+
     if !r.has_remaining() {
         Err(Error::IO("Not enough bytes to build VarInt"))?
     }
@@ -38,6 +48,25 @@ pub fn read_varint<B: Buf>(r: &mut B) -> Result<u64> {
     Ok(vi)
 }
 
+/// Returns the amount of bytes [`write_varint`] writes for `number`.
+///
+/// ```rust
+/// use cuprate_epee_encoding::varint_size;
+///
+/// assert_eq!(varint_size(63), 1);
+/// assert_eq!(varint_size(64), 2);
+/// assert_eq!(varint_size(16_384), 4);
+/// assert_eq!(varint_size(1_073_741_824), 8);
+/// ```
+pub const fn varint_size(number: u64) -> usize {
+    match number {
+        0..=FITS_IN_ONE_BYTE => 1,
+        64..=FITS_IN_TWO_BYTES => 2,
+        16384..=FITS_IN_FOUR_BYTES => 4,
+        _ => 8,
+    }
+}
+
 /// Write an epee variable sized number into `w`.
 ///
 /// ```rust
@@ -95,12 +124,23 @@ mod tests {
         let mut w = Vec::new();
         write_varint(number, &mut w).unwrap();
         assert_eq!(w.len(), len);
+        assert_eq!(varint_size(number), len);
     }
 
     fn assert_varint_val(mut varint: &[u8], val: u64) {
         assert_eq!(read_varint(&mut varint).unwrap(), val);
     }
 
+    /// Read `varint` from a buffer with trailing bytes, taking the 8 byte fast path.
+    fn assert_varint_val_padded(varint: &[u8], val: u64) {
+        let mut buf = varint.to_vec();
+        buf.extend_from_slice(&[0xff; 8]);
+
+        let mut r = buf.as_slice();
+        assert_eq!(read_varint(&mut r).unwrap(), val);
+        assert_eq!(r, [0xff; 8]);
+    }
+
     #[test]
     fn varint_write_length() {
         assert_varint_length(FITS_IN_ONE_BYTE, 1);
@@ -120,4 +160,14 @@ mod tests {
         assert_varint_val(&[254, 255, 255, 255], FITS_IN_FOUR_BYTES);
         assert_varint_val(&[3, 0, 0, 0, 1, 0, 0, 0], FITS_IN_FOUR_BYTES + 1);
     }
+
+    #[test]
+    fn varint_read_fast_path() {
+        assert_varint_val_padded(&[252], FITS_IN_ONE_BYTE);
+        assert_varint_val_padded(&[1, 1], FITS_IN_ONE_BYTE + 1);
+        assert_varint_val_padded(&[253, 255], FITS_IN_TWO_BYTES);
+        assert_varint_val_padded(&[2, 0, 1, 0], FITS_IN_TWO_BYTES + 1);
+        assert_varint_val_padded(&[254, 255, 255, 255], FITS_IN_FOUR_BYTES);
+        assert_varint_val_padded(&[3, 0, 0, 0, 1, 0, 0, 0], FITS_IN_FOUR_BYTES + 1);
+    }
 }
@@ -1,4 +1,6 @@
-use cuprate_epee_encoding::{epee_object, from_bytes};
+use bytes::Buf;
+
+use cuprate_epee_encoding::{epee_object, from_bytes, to_bytes};
 
 struct ObjSeq {
     seq: Vec<ObjSeq>,
@@ -58,3 +60,17 @@ fn seq_with_non_zero_len_must_have_correct_marker() {
     data.extend_from_slice(&1_i64.to_le_bytes());
     (from_bytes::<ValSeq, _>(&mut data.as_slice()).unwrap());
 }
+
+#[test]
+fn seq_split_across_chunks() {
+    let seq = (0..100).collect::<Vec<i64>>();
+    let data = to_bytes(ValSeq { seq: seq.clone() }).unwrap();
+
+    // Split the data at every position, so numbers are split across the two chunks.
+    for split in 0..data.len() {
+        let (a, b) = data.split_at(split);
+
+        let val_seq = from_bytes::<ValSeq, _>(&mut a.chain(b)).unwrap();
+        assert_eq!(val_seq.seq, seq);
+    }
+}
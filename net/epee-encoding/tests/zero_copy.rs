@@ -0,0 +1,53 @@
+use bytes::Bytes;
+
+use cuprate_epee_encoding::{epee_object, from_bytes, to_bytes};
+use cuprate_fixed_bytes::ByteArrayVec;
+
+struct Blobs {
+    blob: Bytes,
+    blobs: Vec<Bytes>,
+    hashes: ByteArrayVec<32>,
+}
+
+epee_object!(
+    Blobs,
+    blob: Bytes,
+    blobs: Vec<Bytes>,
+    hashes: ByteArrayVec<32>,
+);
+
+/// Returns `true` if `slice` is inside `buf`.
+fn is_inside(buf: &Bytes, slice: &[u8]) -> bool {
+    let range = buf.as_ptr_range();
+    range.start <= slice.as_ptr() && slice.as_ptr_range().end <= range.end
+}
+
+#[test]
+fn bytes_values_borrow_from_source() {
+    let blobs = Blobs {
+        blob: Bytes::from_static(&[1; 100]),
+        blobs: vec![Bytes::from_static(&[2; 50]), Bytes::from_static(&[3; 70])],
+        hashes: ByteArrayVec::try_from(Bytes::from_static(&[4; 64])).unwrap(),
+    };
+
+    let source = to_bytes(blobs).unwrap().freeze();
+    let decoded: Blobs = from_bytes(&mut source.clone()).unwrap();
+
+    assert_eq!(decoded.blob, [1; 100].as_slice());
+    assert!(is_inside(&source, &decoded.blob));
+
+    assert_eq!(decoded.blobs.len(), 2);
+    for blob in &decoded.blobs {
+        assert!(is_inside(&source, blob));
+    }
+
+    assert_eq!(decoded.hashes.len(), 2);
+    assert!(is_inside(&source, &decoded.hashes[0]));
+}
+
+#[test]
+fn truncated_field_name_errors() {
+    let data = [1, 17, 1, 1, 1, 1, 2, 1, 1, 4];
+
+    assert!(from_bytes::<Blobs, _>(&mut data.as_slice()).is_err());
+}
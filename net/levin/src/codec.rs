@@ -15,9 +15,9 @@
 
 //! A tokio-codec for levin buckets
 
-use std::{fmt::Debug, marker::PhantomData};
+use std::{collections::VecDeque, fmt::Debug, marker::PhantomData};
 
-use bytes::{Buf, BufMut, BytesMut};
+use bytes::{Buf, BufMut, Bytes, BytesMut};
 use tokio_util::codec::{Decoder, Encoder};
 
 use crate::{
@@ -155,16 +155,128 @@ impl<C: LevinCommand> Encoder<Bucket<C>> for LevinBucketCodec<C> {
     }
 }
 
+/// Fragments smaller than this are copied instead of being kept as the [`Bytes`] they were received in.
+///
+/// A [`Bytes`] could point to a large allocation even if the [`Bytes`] itself is small, so is not
+/// safe to keep around for long. Only keeping large fragments means a peer has to send at least
+/// this many bytes for each allocation it keeps alive while we wait for the rest of the message.
+const MIN_ZERO_COPY_FRAGMENT_SIZE: usize = 64 * 1024;
+
 #[derive(Default, Debug, Clone)]
 enum MessageState {
     #[default]
     WaitingForBucket,
     /// Waiting for the rest of a fragmented message.
+    WaitingForRestOfFragment(FragmentedBody),
+}
+
+/// The body of a fragmented message, kept as the chain of the fragments' bodies.
+///
+/// This implements [`Buf`] over all the fragments, so the message can be decoded
+/// without first copying the fragments into one buffer.
+#[derive(Default, Debug, Clone)]
+struct FragmentedBody {
+    /// The fragments' bodies, none of these are empty.
+    fragments: VecDeque<Bytes>,
+    /// The total length of `fragments`.
+    len: usize,
+}
+
+impl FragmentedBody {
+    /// Start a fragmented message with its first fragment's body.
     ///
-    /// We keep the fragmented message as a Vec<u8> instead of [`Bytes`](bytes::Bytes) as [`Bytes`](bytes::Bytes) could point to a
-    /// large allocation even if the [`Bytes`](bytes::Bytes) itself is small, so is not safe to keep around for long.
-    /// To prevent this attack vector completely we just use Vec<u8> for fragmented messages.
-    WaitingForRestOfFragment(Vec<u8>),
+    /// If the body contains the message's header, the fragment list is
+    /// pre-sized for the amount of (equally sized) fragments the message needs.
+    fn new<C: LevinCommand>(first: Bytes) -> Self {
+        let fragments = if first.len() >= HEADER_SIZE {
+            let header = BucketHead::<C>::from_bytes(&mut BytesMut::from(&first[..HEADER_SIZE]));
+            let total_len = usize::try_from(header.size)
+                .unwrap_or(usize::MAX)
+                .saturating_add(HEADER_SIZE);
+
+            // Limit this to protect against a peer claiming a huge size.
+            VecDeque::with_capacity(total_len.div_ceil(first.len()).min(1024))
+        } else {
+            VecDeque::new()
+        };
+
+        let mut this = Self { fragments, len: 0 };
+        this.push(first);
+        this
+    }
+
+    /// Add the next fragment's body.
+    fn push(&mut self, body: Bytes) {
+        if body.is_empty() {
+            return;
+        }
+
+        let body = if body.len() < MIN_ZERO_COPY_FRAGMENT_SIZE {
+            Bytes::copy_from_slice(&body)
+        } else {
+            body
+        };
+
+        self.len += body.len();
+        self.fragments.push_back(body);
+    }
+}
+
+impl Buf for FragmentedBody {
+    fn remaining(&self) -> usize {
+        self.len
+    }
+
+    fn chunk(&self) -> &[u8] {
+        self.fragments.front().map_or(&[], Bytes::as_ref)
+    }
+
+    fn advance(&mut self, mut cnt: usize) {
+        assert!(
+            cnt <= self.len,
+            "cannot advance past `remaining`: {cnt} > {}",
+            self.len
+        );
+        self.len -= cnt;
+
+        while cnt > 0 {
+            let front = self.fragments.front_mut().unwrap();
+
+            if cnt < front.len() {
+                front.advance(cnt);
+                return;
+            }
+
+            cnt -= front.len();
+            self.fragments.pop_front();
+        }
+    }
+
+    fn copy_to_bytes(&mut self, len: usize) -> Bytes {
+        // Within a single fragment, this is zero-copy.
+        if let Some(front) = self.fragments.front_mut() {
+            if len < front.len() {
+                self.len -= len;
+                return front.split_to(len);
+            }
+
+            if len == front.len() {
+                self.len -= len;
+                return self.fragments.pop_front().unwrap();
+            }
+        }
+
+        assert!(
+            len <= self.len,
+            "`len` greater than remaining: {len} > {}",
+            self.len
+        );
+
+        // Spans multiple fragments.
+        let mut bytes = BytesMut::with_capacity(len);
+        bytes.put((&mut *self).take(len));
+        bytes.freeze()
+    }
 }
 
 /// A tokio-codec for levin messages or in other words the decoded body
@@ -221,7 +333,10 @@ impl<T: LevinBody> Decoder for LevinMessageCodec<T> {
                         #[cfg(feature = "tracing")]
                         tracing::debug!("Bucket is a fragment, waiting for rest of message.");
 
-                        self.state = MessageState::WaitingForRestOfFragment(bucket.body.to_vec());
+                        self.state =
+                            MessageState::WaitingForRestOfFragment(
+                                FragmentedBody::new::<T::Command>(bucket.body),
+                            );
 
                         continue;
                     }
@@ -239,7 +354,7 @@ impl<T: LevinBody> Decoder for LevinMessageCodec<T> {
                         bucket.header.command,
                     )?));
                 }
-                MessageState::WaitingForRestOfFragment(bytes) => {
+                MessageState::WaitingForRestOfFragment(body) => {
                     let Some(bucket) = self.bucket_codec.decode(src)? else {
                         return Ok(None);
                     };
@@ -263,7 +378,7 @@ impl<T: LevinBody> Decoder for LevinMessageCodec<T> {
                     .try_into()
                     .expect("Levin max message size is too large, does not fit into a usize.");
 
-                    if bytes.len().saturating_add(bucket.body.len()) > max_size {
+                    if body.remaining().saturating_add(bucket.body.len()) > max_size {
                         return Err(BucketError::InvalidFragmentedMessage(
                             "Fragmented message exceeded maximum size",
                         ));
@@ -272,26 +387,25 @@ impl<T: LevinBody> Decoder for LevinMessageCodec<T> {
                     #[cfg(feature = "tracing")]
                     tracing::trace!("Received another bucket fragment.");
 
-                    bytes.extend_from_slice(bucket.body.as_ref());
-
-                    if flags.contains(Flags::END_FRAGMENT) {
-                        // make sure we only look at the internal bucket and don't use this.
-                        drop(bucket);
+                    let end_fragment = flags.contains(Flags::END_FRAGMENT);
+                    body.push(bucket.body);
 
-                        let MessageState::WaitingForRestOfFragment(bytes) =
+                    if end_fragment {
+                        let MessageState::WaitingForRestOfFragment(mut body) =
                             std::mem::replace(&mut self.state, MessageState::WaitingForBucket)
                         else {
                             unreachable!();
                         };
 
                         // Check there are enough bytes in the fragment to build a header.
-                        if bytes.len() < HEADER_SIZE {
+                        if body.remaining() < HEADER_SIZE {
                             return Err(BucketError::InvalidFragmentedMessage(
                                 "Fragmented message is not large enough to build a bucket.",
                             ));
                         }
 
-                        let mut header_bytes = BytesMut::from(&bytes[0..HEADER_SIZE]);
+                        let mut header_bytes = BytesMut::with_capacity(HEADER_SIZE);
+                        header_bytes.put((&mut body).take(HEADER_SIZE));
 
                         let header = BucketHead::<T::Command>::from_bytes(&mut header_bytes);
 
@@ -300,7 +414,7 @@ impl<T: LevinBody> Decoder for LevinMessageCodec<T> {
                         }
 
                         // Check the fragmented message contains enough bytes to build the message.
-                        if bytes.len().saturating_sub(HEADER_SIZE)
+                        if body.remaining()
                             < header
                                 .size
                                 .try_into()
@@ -332,7 +446,7 @@ impl<T: LevinBody> Decoder for LevinMessageCodec<T> {
                         }
 
                         return Ok(Some(T::decode_message(
-                            &mut &bytes[HEADER_SIZE..],
+                            &mut body,
                             message_type,
                             header.command,
                         )?));
@@ -20,7 +20,8 @@ pub enum LevinMessage<T: LevinBody> {
     ///
     /// This bucket will be sent to the peer directly with no extra information.
     ///
-    /// This should only be used to send fragmented messages: [`make_fragmented_messages`]
+    /// This should only be used to send fragmented messages: [`make_fragmented_messages`], or
+    /// messages that were encoded once to be sent to many peers.
     Bucket(Bucket<T::Command>),
     /// A dummy message.
     ///
@@ -114,6 +114,45 @@ async fn codec_fragmented_messages() {
     }
 }
 
+#[tokio::test]
+async fn codec_large_fragmented_messages() {
+    // Set up the fake connection
+    let (write, read) = duplex(100_000);
+
+    let mut read = FramedRead::new(read, LevinMessageCodec::<TestBody>::default());
+    let mut write = FramedWrite::new(write, LevinMessageCodec::<TestBody>::default());
+
+    // Create the message to fragment, the fragments are large enough to not be copied.
+    let mut buf = BytesMut::from(vec![0; 200_000].as_slice());
+    let mut rng = rand::thread_rng();
+    buf.try_fill(&mut rng).unwrap();
+
+    let message = TestBody::Bytes(buf.len(), buf.freeze());
+
+    let fragments =
+        make_fragmented_messages(&Protocol::default(), 70_000, message.clone()).unwrap();
+
+    // The fragments do not fit in the connection's buffer, so send them concurrently.
+    let writer = tokio::spawn(async move {
+        for frag in fragments {
+            write.send(frag.into()).await.unwrap();
+        }
+    });
+
+    // only one message should be received.
+    let message2 = timeout(TEST_TIMEOUT, read.next())
+        .await
+        .unwrap()
+        .unwrap()
+        .unwrap();
+
+    timeout(TEST_TIMEOUT, writer).await.unwrap().unwrap();
+
+    match (message, message2) {
+        (TestBody::Bytes(_, buf), TestBody::Bytes(_, buf2)) => assert_eq!(buf, buf2),
+    }
+}
+
 proptest! {
     #[test]
     fn make_fragmented_messages_correct_size(fragment_size in 100_usize..5000, message_size in 0_usize..100_000) {
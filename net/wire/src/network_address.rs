@@ -45,6 +45,10 @@ impl EpeeObject for NetworkAddress {
         2
     }
 
+    fn size_of_fields(&self) -> usize {
+        TaggedNetworkAddress::from(*self).size_of_fields()
+    }
+
     fn write_fields<B: BufMut>(self, w: &mut B) -> cuprate_epee_encoding::Result<()> {
         TaggedNetworkAddress::from(self).write_fields(w)
     }
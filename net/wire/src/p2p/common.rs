@@ -238,7 +238,7 @@ epee_object!(
     pruned: bool = false,
     block: Bytes,
     block_weight: u64 = 0_u64,
-    txs: TransactionBlobs = TransactionBlobs::None => tx_blob_read, tx_blob_write, should_write_tx_blobs,
+    txs: TransactionBlobs = TransactionBlobs::None => tx_blob_read, tx_blob_write, should_write_tx_blobs, tx_blob_size,
 );
 
 fn tx_blob_read<B: Buf>(b: &mut B) -> cuprate_epee_encoding::Result<TransactionBlobs> {
@@ -275,6 +275,14 @@ fn should_write_tx_blobs(val: &TransactionBlobs) -> bool {
     !val.is_empty()
 }
 
+fn tx_blob_size(val: &TransactionBlobs, field_name: &str) -> usize {
+    match val {
+        TransactionBlobs::Normal(bytes) => cuprate_epee_encoding::field_size(bytes, field_name),
+        TransactionBlobs::Pruned(obj) => cuprate_epee_encoding::field_size(obj, field_name),
+        TransactionBlobs::None => 0,
+    }
+}
+
 #[cfg(test)]
 mod tests {
 
@@ -4,23 +4,26 @@
 //!
 //! Weight is used to bound the channel, on creation you specify a max weight and for each value you
 //! specify a weight.
+//!
+//! Internally this is a single ring buffer ([`VecDeque`]) shared by both sides behind a lock, with slots
+//! allocated up front. Slots are reused as items are taken out, so sending items does not allocate once the
+//! buffer has grown to the amount of items it holds at once. The weight in the buffer is only changed with
+//! the lock held, so the capacity seen by the [`BufferAppender`] is always exact.
 use std::{
     cmp::min,
+    collections::VecDeque,
     future::Future,
     pin::Pin,
-    sync::{
-        atomic::{AtomicUsize, Ordering},
-        Arc,
-    },
-    task::{Context, Poll},
+    sync::{Arc, Mutex, MutexGuard},
+    task::{Context, Poll, Waker},
 };
 
-use futures::{
-    channel::mpsc::{unbounded, UnboundedReceiver, UnboundedSender},
-    ready,
-    task::AtomicWaker,
-    Stream, StreamExt,
-};
+use futures::{future::poll_fn, Stream};
+
+/// The amount of slots allocated when creating a buffer.
+///
+/// The buffer grows past this if more items are added, it is bound by weight, not by the amount of items.
+const INITIAL_SLOTS: usize = 32;
 
 #[derive(thiserror::Error, Debug, Copy, Clone, Eq, PartialEq)]
 pub enum BufferError {
@@ -39,71 +42,219 @@ pub enum BufferError {
 /// i.e. if the capacity is 5 and there are no items in the buffer then any item even if it's weight is >5 will be
 /// accepted.
 pub fn new_buffer<T>(max_item_weight: usize) -> (BufferAppender<T>, BufferStream<T>) {
-    let (tx, rx) = unbounded();
-    let sink_waker = Arc::new(AtomicWaker::new());
-    let capacity_atomic = Arc::new(AtomicUsize::new(max_item_weight));
+    let shared = Arc::new(Mutex::new(Shared {
+        queue: VecDeque::with_capacity(INITIAL_SLOTS),
+        weight: 0,
+        appender_waker: None,
+        stream_waker: None,
+        appender_dropped: false,
+        stream_dropped: false,
+    }));
 
     (
         BufferAppender {
-            queue: tx,
-            sink_waker: sink_waker.clone(),
-            capacity: capacity_atomic.clone(),
+            shared: shared.clone(),
             max_item_weight,
         },
         BufferStream {
-            queue: rx,
-            sink_waker,
-            capacity: capacity_atomic,
+            shared,
+            max_item_weight,
         },
     )
 }
 
+/// The occupancy of a buffer, see [`BufferAppender::occupancy`] and [`BufferStream::occupancy`].
+#[derive(Debug, Copy, Clone, Eq, PartialEq)]
+pub struct BufferOccupancy {
+    /// The amount of items in the buffer.
+    pub items: usize,
+    /// The combined weight of all items in the buffer.
+    pub weight: usize,
+    /// The max combined weight of all items in the buffer.
+    pub max_weight: usize,
+}
+
+/// The state shared between the [`BufferAppender`] and [`BufferStream`].
+struct Shared<T> {
+    /// The items in the buffer, with their weights.
+    queue: VecDeque<(T, usize)>,
+    /// The combined weight of all items in [`Self::queue`].
+    weight: usize,
+
+    /// The waker for the [`BufferAppender`], set when it is waiting for capacity.
+    appender_waker: Option<Waker>,
+    /// The waker for the [`BufferStream`], set when it is waiting for items.
+    stream_waker: Option<Waker>,
+
+    /// If the [`BufferAppender`] was dropped.
+    appender_dropped: bool,
+    /// If the [`BufferStream`] was dropped.
+    stream_dropped: bool,
+}
+
+/// Locks the shared state of the buffer.
+fn lock<T>(shared: &Mutex<Shared<T>>) -> MutexGuard<'_, Shared<T>> {
+    shared
+        .lock()
+        .expect("The other end of the buffer panicked while holding the lock")
+}
+
+/// Sets `slot` to `waker`, if it would not already wake the same task.
+fn register_waker(slot: &mut Option<Waker>, waker: &Waker) {
+    match slot {
+        Some(old) if old.will_wake(waker) => (),
+        _ => *slot = Some(waker.clone()),
+    }
+}
+
 /// The stream side of the buffer.
 pub struct BufferStream<T> {
-    /// The internal queue of items.
-    queue: UnboundedReceiver<(T, usize)>,
-    /// The waker for the [`BufferAppender`]
-    sink_waker: Arc<AtomicWaker>,
-    /// The current capacity of the buffer.
-    capacity: Arc<AtomicUsize>,
+    /// The state shared with the [`BufferAppender`].
+    shared: Arc<Mutex<Shared<T>>>,
+    /// The max weight of an item, equal to the total allowed weight of the buffer.
+    max_item_weight: usize,
+}
+
+impl<T> BufferStream<T> {
+    /// Returns the current occupancy of the buffer.
+    pub fn occupancy(&self) -> BufferOccupancy {
+        let shared = lock(&self.shared);
+
+        BufferOccupancy {
+            items: shared.queue.len(),
+            weight: shared.weight,
+            max_weight: self.max_item_weight,
+        }
+    }
+
+    /// Polls to take up to `limit` items out of the buffer, adding them to `buf`.
+    ///
+    /// Returns the amount of items added, `0` means the [`BufferAppender`] was dropped and the buffer is
+    /// empty, or `limit` is `0`.
+    pub fn poll_pop_many(
+        &mut self,
+        cx: &mut Context<'_>,
+        buf: &mut Vec<T>,
+        limit: usize,
+    ) -> Poll<usize> {
+        if limit == 0 {
+            return Poll::Ready(0);
+        }
+
+        let mut shared = lock(&self.shared);
+
+        if shared.queue.is_empty() {
+            if shared.appender_dropped {
+                return Poll::Ready(0);
+            }
+
+            register_waker(&mut shared.stream_waker, cx.waker());
+            return Poll::Pending;
+        }
+
+        let amount = min(limit, shared.queue.len());
+        buf.reserve(amount);
+
+        let mut weight = 0;
+        buf.extend(shared.queue.drain(..amount).map(|(item, size)| {
+            weight += size;
+            item
+        }));
+
+        // add the capacity back to the buffer.
+        shared.weight -= weight;
+
+        // wake the sink.
+        let waker = shared.appender_waker.take();
+        drop(shared);
+        if let Some(waker) = waker {
+            waker.wake();
+        }
+
+        Poll::Ready(amount)
+    }
+
+    /// Takes up to `limit` items out of the buffer, adding them to `buf`, waiting for at least one if it
+    /// is empty.
+    ///
+    /// Returns the amount of items added, `0` means the [`BufferAppender`] was dropped and the buffer is
+    /// empty, or `limit` is `0`.
+    pub async fn pop_many(&mut self, buf: &mut Vec<T>, limit: usize) -> usize {
+        poll_fn(|cx| self.poll_pop_many(cx, buf, limit)).await
+    }
 }
 
 impl<T> Stream for BufferStream<T> {
     type Item = T;
 
-    fn poll_next(mut self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Option<Self::Item>> {
-        let Some((item, size)) = ready!(self.queue.poll_next_unpin(cx)) else {
-            return Poll::Ready(None);
+    fn poll_next(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Option<Self::Item>> {
+        let mut shared = lock(&self.shared);
+
+        let Some((item, size)) = shared.queue.pop_front() else {
+            if shared.appender_dropped {
+                return Poll::Ready(None);
+            }
+
+            register_waker(&mut shared.stream_waker, cx.waker());
+            return Poll::Pending;
         };
 
         // add the capacity back to the buffer.
-        self.capacity.fetch_add(size, Ordering::AcqRel);
+        shared.weight -= size;
+
         // wake the sink.
-        self.sink_waker.wake();
+        let waker = shared.appender_waker.take();
+        drop(shared);
+        if let Some(waker) = waker {
+            waker.wake();
+        }
 
         Poll::Ready(Some(item))
     }
 }
 
+impl<T> Drop for BufferStream<T> {
+    fn drop(&mut self) {
+        let mut shared = lock(&self.shared);
+        shared.stream_dropped = true;
+
+        // wake the sink, so it sees we disconnected.
+        let waker = shared.appender_waker.take();
+        drop(shared);
+        if let Some(waker) = waker {
+            waker.wake();
+        }
+    }
+}
+
 /// The appender/sink side of the buffer.
 pub struct BufferAppender<T> {
-    /// The internal queue of items.
-    queue: UnboundedSender<(T, usize)>,
-    /// Our waker.
-    sink_waker: Arc<AtomicWaker>,
-    /// The current capacity of the buffer.
-    capacity: Arc<AtomicUsize>,
+    /// The state shared with the [`BufferStream`].
+    shared: Arc<Mutex<Shared<T>>>,
     /// The max weight of an item, equal to the total allowed weight of the buffer.
     max_item_weight: usize,
 }
 
 impl<T> BufferAppender<T> {
+    /// Returns the current occupancy of the buffer.
+    pub fn occupancy(&self) -> BufferOccupancy {
+        let shared = lock(&self.shared);
+
+        BufferOccupancy {
+            items: shared.queue.len(),
+            weight: shared.weight,
+            max_weight: self.max_item_weight,
+        }
+    }
+
     /// Returns a future that resolves when the channel has enough capacity for
     /// a single message of `size_needed`.
     ///
     /// It should be noted that if there are no items in the buffer then a single item of any capacity is accepted.
     /// i.e. if the capacity is 5 and there are no items in the buffer then any item even if it's weight is >5 will be
     /// accepted.
+    ///
+    /// This future also resolves if the [`BufferStream`] was dropped.
     pub fn ready(&mut self, size_needed: usize) -> BufferSinkReady<'_, T> {
         let size_needed = min(self.max_item_weight, size_needed);
 
@@ -120,18 +271,25 @@ impl<T> BufferAppender<T> {
     pub fn try_send(&mut self, item: T, size_needed: usize) -> Result<(), BufferError> {
         let size_needed = min(self.max_item_weight, size_needed);
 
-        if self.capacity.load(Ordering::Acquire) < size_needed {
-            return Err(BufferError::NotEnoughCapacity);
+        let mut shared = lock(&self.shared);
+
+        if shared.stream_dropped {
+            return Err(BufferError::Disconnected);
         }
 
-        let prev_size = self.capacity.fetch_sub(size_needed, Ordering::AcqRel);
+        if self.max_item_weight - shared.weight < size_needed {
+            return Err(BufferError::NotEnoughCapacity);
+        }
 
-        // make sure we haven't wrapped the capacity around.
-        assert!(prev_size >= size_needed);
+        shared.weight += size_needed;
+        shared.queue.push_back((item, size_needed));
 
-        self.queue
-            .unbounded_send((item, size_needed))
-            .map_err(|_| BufferError::Disconnected)?;
+        // wake the stream.
+        let waker = shared.stream_waker.take();
+        drop(shared);
+        if let Some(waker) = waker {
+            waker.wake();
+        }
 
         Ok(())
     }
@@ -145,6 +303,20 @@ impl<T> BufferAppender<T> {
     }
 }
 
+impl<T> Drop for BufferAppender<T> {
+    fn drop(&mut self) {
+        let mut shared = lock(&self.shared);
+        shared.appender_dropped = true;
+
+        // wake the stream, so it sees we disconnected.
+        let waker = shared.stream_waker.take();
+        drop(shared);
+        if let Some(waker) = waker {
+            waker.wake();
+        }
+    }
+}
+
 /// A [`Future`] for adding an item to the buffer.
 #[pin_project::pin_project]
 pub struct BufferSinkSend<'a, T> {
@@ -187,19 +359,15 @@ impl<'a, T> Future for BufferSinkReady<'a, T> {
     type Output = ();
 
     fn poll(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Self::Output> {
-        // Check before setting the waker just in case it has capacity now,
-        if self.sink.capacity.load(Ordering::Acquire) >= self.size_needed {
+        let mut shared = lock(&self.sink.shared);
+
+        // The capacity is only changed with the lock held, so there is no race with the stream here.
+        if shared.stream_dropped || self.sink.max_item_weight - shared.weight >= self.size_needed {
             return Poll::Ready(());
         }
 
-        // set the waker
-        self.sink.sink_waker.register(cx.waker());
+        register_waker(&mut shared.appender_waker, cx.waker());
 
-        // check the capacity again to avoid a race condition that would result in lost notifications.
-        if self.sink.capacity.load(Ordering::Acquire) >= self.size_needed {
-            Poll::Ready(())
-        } else {
-            Poll::Pending
-        }
+        Poll::Pending
     }
 }
@@ -1,6 +1,6 @@
 use futures::{FutureExt, StreamExt};
 
-use cuprate_async_buffer::new_buffer;
+use cuprate_async_buffer::{new_buffer, BufferError};
 
 #[tokio::test]
 async fn async_buffer_send_rec() {
@@ -35,3 +35,66 @@ async fn single_item_over_capacity() {
 
     assert_eq!(rx.next().await.unwrap(), 4);
 }
+
+#[tokio::test]
+async fn pop_many() {
+    let (mut tx, mut rx) = new_buffer(1000);
+
+    for i in 0..5 {
+        tx.send(i, 100).await.unwrap();
+    }
+
+    let mut buf = Vec::new();
+    assert_eq!(rx.pop_many(&mut buf, 3).await, 3);
+    assert_eq!(buf, [0, 1, 2]);
+
+    assert_eq!(rx.pop_many(&mut buf, 10).await, 2);
+    assert_eq!(buf, [0, 1, 2, 3, 4]);
+
+    drop(tx);
+    assert_eq!(rx.pop_many(&mut buf, 10).await, 0);
+}
+
+#[tokio::test]
+async fn occupancy() {
+    let (mut tx, mut rx) = new_buffer(1000);
+
+    tx.send(4, 300).await.unwrap();
+    assert_eq!(tx.try_send(8, 800), Err(BufferError::NotEnoughCapacity));
+    tx.send(8, 200).await.unwrap();
+
+    let occupancy = tx.occupancy();
+    assert_eq!(occupancy.items, 2);
+    assert_eq!(occupancy.weight, 500);
+    assert_eq!(occupancy.max_weight, 1000);
+
+    rx.next().await.unwrap();
+
+    let occupancy = rx.occupancy();
+    assert_eq!(occupancy.items, 1);
+    assert_eq!(occupancy.weight, 200);
+}
+
+#[tokio::test]
+async fn stream_dropped() {
+    let (mut tx, rx) = new_buffer(1000);
+
+    tx.send(4, 1000).await.unwrap();
+
+    let fut = tx.ready(1000);
+    drop(rx);
+
+    assert!(fut.now_or_never().is_some());
+    assert_eq!(tx.send(8, 1000).await, Err(BufferError::Disconnected));
+}
+
+#[tokio::test]
+async fn appender_dropped() {
+    let (mut tx, mut rx) = new_buffer(1000);
+
+    tx.send(4, 5).await.unwrap();
+    drop(tx);
+
+    assert_eq!(rx.next().await, Some(4));
+    assert_eq!(rx.next().await, None);
+}
@@ -17,7 +17,10 @@ use tokio::{
 use tokio_stream::wrappers::ReceiverStream;
 use tower::ServiceExt;
 
-use cuprate_wire::{LevinCommand, Message, ProtocolMessage};
+use cuprate_wire::{
+    levin::{Bucket, LevinMessage},
+    LevinCommand, Message, ProtocolMessage,
+};
 
 use crate::{
     constants::{REQUEST_TIMEOUT, SENDING_TIMEOUT},
@@ -126,7 +129,19 @@ where
     async fn send_message_to_peer(&mut self, mes: Message) -> Result<(), PeerError> {
         tracing::debug!("Sending message: [{}] to peer", mes.command());
 
-        timeout(SENDING_TIMEOUT, self.peer_sink.send(mes.into()))
+        self.send_to_peer(mes.into()).await
+    }
+
+    /// Sends an already encoded bucket to the peer, see [`Self::send_message_to_peer`].
+    async fn send_bucket_to_peer(&mut self, bucket: Bucket<LevinCommand>) -> Result<(), PeerError> {
+        tracing::debug!("Sending message: [{}] to peer", bucket.header.command);
+
+        self.send_to_peer(LevinMessage::Bucket(bucket)).await
+    }
+
+    /// Sends a [`LevinMessage`] to the peer, with a timeout.
+    async fn send_to_peer(&mut self, mes: LevinMessage<Message>) -> Result<(), PeerError> {
+        timeout(SENDING_TIMEOUT, self.peer_sink.send(mes))
             .await
             .map_err(|_| PeerError::TimedOut)
             .and_then(|res| res.map_err(PeerError::BucketError))
@@ -135,10 +150,7 @@ where
     /// Handles a broadcast request from Cuprate.
     async fn handle_client_broadcast(&mut self, mes: BroadcastMessage) -> Result<(), PeerError> {
         match mes {
-            BroadcastMessage::NewFluffyBlock(block) => {
-                self.send_message_to_peer(Message::Protocol(ProtocolMessage::NewFluffyBlock(block)))
-                    .await
-            }
+            BroadcastMessage::NewFluffyBlock(bucket) => self.send_bucket_to_peer(bucket).await,
             BroadcastMessage::NewTransaction(txs) => {
                 self.send_message_to_peer(Message::Protocol(ProtocolMessage::NewTransactions(txs)))
                     .await
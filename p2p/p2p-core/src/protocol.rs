@@ -27,10 +27,12 @@ use cuprate_wire::{
         HandshakeRequest, HandshakeResponse, PingResponse, SupportFlagsResponse, TimedSyncRequest,
         TimedSyncResponse,
     },
+    levin::{Bucket, BucketBuilder, LevinBody, Protocol},
     protocol::{
         ChainRequest, ChainResponse, FluffyMissingTransactionsRequest, GetObjectsRequest,
         GetObjectsResponse, GetTxPoolCompliment, NewBlock, NewFluffyBlock, NewTransactions,
     },
+    BucketError, LevinCommand, Message, ProtocolMessage,
 };
 
 mod try_from;
@@ -55,10 +57,23 @@ pub enum MessageID {
 }
 
 pub enum BroadcastMessage {
-    NewFluffyBlock(NewFluffyBlock),
+    /// A [`NewFluffyBlock`], already encoded with [`BroadcastMessage::encode_fluffy_block`].
+    ///
+    /// The same block is sent to every peer, so it is encoded once and
+    /// each connection gets a clone of the bucket, sharing its body.
+    NewFluffyBlock(Bucket<LevinCommand>),
     NewTransaction(NewTransactions),
 }
 
+impl BroadcastMessage {
+    /// Encode a [`NewFluffyBlock`] into a [`Bucket`], for [`BroadcastMessage::NewFluffyBlock`].
+    pub fn encode_fluffy_block(block: NewFluffyBlock) -> Result<Bucket<LevinCommand>, BucketError> {
+        let mut builder = BucketBuilder::new(&Protocol::default());
+        Message::Protocol(ProtocolMessage::NewFluffyBlock(block)).encode(&mut builder)?;
+        Ok(builder.finish())
+    }
+}
+
 #[derive(Debug, Clone)]
 pub enum PeerRequest {
     Handshake(HandshakeRequest),
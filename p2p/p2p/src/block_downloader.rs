@@ -13,7 +13,6 @@ use std::{
 };
 
 use futures::TryFutureExt;
-use monero_serai::{block::Block, transaction::Transaction};
 use tokio::{
     task::JoinSet,
     time::{interval, timeout, MissedTickBehavior},
@@ -23,37 +22,45 @@ use tracing::{instrument, Instrument, Span};
 
 use cuprate_async_buffer::{BufferAppender, BufferStream};
 use cuprate_p2p_core::{
+    client::InternalPeerID,
     handles::ConnectionHandle,
     services::{PeerSyncRequest, PeerSyncResponse},
     NetworkZone, PeerSyncSvc,
 };
 use cuprate_pruning::{PruningSeed, CRYPTONOTE_MAX_BLOCK_HEIGHT};
+use cuprate_types::UnverifiedBlockInformation;
 
 use crate::{
     client_pool::{ClientPool, ClientPoolDropGuard},
     constants::{
-        BLOCK_DOWNLOADER_REQUEST_TIMEOUT, EMPTY_CHAIN_ENTRIES_BEFORE_TOP_ASSUMED, LONG_BAN,
-        MAX_BLOCK_BATCH_LEN, MAX_DOWNLOAD_FAILURES,
+        BLOCK_DOWNLOADER_REQUEST_TIMEOUT, EMPTY_CHAIN_ENTRIES_BEFORE_TOP_ASSUMED,
+        HEDGE_REQUEST_AFTER, HEDGE_THROUGHPUT_PERCENTILE, LONG_BAN, MAX_BLOCK_BATCH_LEN,
+        MAX_DOWNLOAD_FAILURES,
     },
 };
 
 mod block_queue;
 mod chain_tracker;
 mod download_batch;
+mod peer_throughput;
 mod request_chain;
 #[cfg(test)]
 mod tests;
 
 use block_queue::{BlockQueue, ReadyQueueBatch};
-use chain_tracker::{BlocksToRetrieve, ChainEntry, ChainTracker};
+use chain_tracker::{BlocksToRetrieve, ChainEntry, ChainTracker, ChainTrackerError};
 use download_batch::download_batch_task;
+use peer_throughput::PeerThroughput;
 use request_chain::{initial_chain_search, request_chain_entry_from_peer};
 
 /// A downloaded batch of blocks.
 #[derive(Debug, Clone)]
 pub struct BlockBatch {
     /// The blocks.
-    pub blocks: Vec<(Block, Vec<Transaction>)>,
+    ///
+    /// These hold the blobs and hashes calculated when checking the peer's response,
+    /// so they do not need to be calculated again.
+    pub blocks: Vec<UnverifiedBlockInformation>,
     /// The size in bytes of this batch.
     pub size: usize,
     /// The peer that gave us this batch.
@@ -193,8 +200,13 @@ where
 /// Ready peers will either:
 /// - download the next batch of blocks
 /// - request the next chain entry
+/// - send a hedged request for the oldest inflight batch, if the peer it was requested from is taking longer than
+/// expected
 /// - download an already requested batch of blocks (this might happen due to an error in the previous request
 /// or because the queue of ready blocks is too large, so we need the oldest block to clear it).
+///
+/// We keep an estimate of each peer's throughput, see [`PeerThroughput`]. Ready peers are given work fastest
+/// first, slow peers are given smaller batches and are not used for batches we are waiting on.
 struct BlockDownloader<N: NetworkZone, S, C> {
     /// The client pool.
     client_pool: Arc<ClientPool<N>>,
@@ -234,6 +246,11 @@ struct BlockDownloader<N: NetworkZone, S, C> {
 
     block_queue: BlockQueue,
 
+    /// The throughput estimates of the peers we have downloaded batches from.
+    peer_throughput: PeerThroughput<N::Addr>,
+    /// The average size, in bytes, of the blocks in the last batch we received.
+    average_block_size: Option<usize>,
+
     /// The [`BlockDownloaderConfig`].
     config: BlockDownloaderConfig,
 }
@@ -268,6 +285,8 @@ where
             inflight_requests: BTreeMap::new(),
             block_queue: BlockQueue::new(buffer_appender),
             failed_batches: BinaryHeap::new(),
+            peer_throughput: PeerThroughput::new(),
+            average_block_size: None,
             config,
         }
     }
@@ -281,15 +300,24 @@ where
         tracing::debug!("Checking if we can give any work to pending peers.");
 
         for (_, peers) in pending_peers.iter_mut() {
+            // Give work to the fastest peers first, `pop` takes from the end.
+            peers.sort_unstable_by(|a, b| {
+                self.peer_throughput
+                    .relative_rate(&a.info.id)
+                    .total_cmp(&self.peer_throughput.relative_rate(&b.info.id))
+            });
+
             while let Some(peer) = peers.pop() {
                 if peer.info.handle.is_closed() {
                     // Peer has disconnected, drop it.
+                    self.peer_throughput.remove(&peer.info.id);
                     continue;
                 }
 
                 if let Some(peer) = self.try_handle_free_client(chain_tracker, peer).await {
                     // This peer is ok however it does not have the data we currently need, this will only happen
-                    // because of its pruning seed so just skip over all peers with this pruning seed.
+                    // because of its pruning seed, or because it is too slow to help with the batches we are
+                    // waiting on, so just skip over all peers with this pruning seed, the rest are slower.
                     peers.push(peer);
                     break;
                 }
@@ -332,6 +360,8 @@ where
                 return Some(client);
             }
 
+            in_flight_batch.request_sent(client.info.id);
+
             self.block_download_tasks.spawn(download_batch_task(
                 client,
                 in_flight_batch.ids.clone(),
@@ -348,20 +378,103 @@ where
         Some(client)
     }
 
+    /// Attempts to send a hedged request for the oldest inflight batch.
+    ///
+    /// All later batches wait on the oldest inflight batch before they can be added to the buffer. If
+    /// the peer it was requested from has taken longer than we expected at its estimated throughput, or
+    /// longer than [`HEDGE_REQUEST_AFTER`], another request for it is sent to `client`, as long as
+    /// `client` is faster. Whichever peer answers first is used.
+    ///
+    /// Returns the [`ClientPoolDropGuard`] back if the oldest batch does not need a hedged request, or if
+    /// `client` should not be used for it.
+    fn hedge_oldest_batch(
+        &mut self,
+        client: ClientPoolDropGuard<N>,
+    ) -> Option<ClientPoolDropGuard<N>> {
+        let Some(oldest_batch) = self.inflight_requests.values_mut().next() else {
+            return Some(client);
+        };
+
+        // Only hedge once, the same limit as for other duplicate requests.
+        if oldest_batch.requests_sent >= 2 {
+            return Some(client);
+        }
+
+        let Some((requested_from, requested_at)) =
+            oldest_batch.requested_from.zip(oldest_batch.requested_at)
+        else {
+            return Some(client);
+        };
+
+        if requested_from == client.info.id {
+            return Some(client);
+        }
+
+        // Slow peers are given smaller batches, so they may well send this batch in time, only
+        // hedge once the peer is taking longer than its throughput says it should.
+        let expected_time = self
+            .average_block_size
+            .and_then(|block_size| {
+                self.peer_throughput
+                    .expected_time(&requested_from, block_size * oldest_batch.ids.len())
+            })
+            .map_or(HEDGE_REQUEST_AFTER, |time| time.min(HEDGE_REQUEST_AFTER));
+
+        if requested_at.elapsed() <= expected_time
+            || self
+                .peer_throughput
+                .is_below_percentile(&client.info.id, HEDGE_THROUGHPUT_PERCENTILE)
+            || self.peer_throughput.relative_rate(&client.info.id)
+                < self.peer_throughput.relative_rate(&requested_from)
+        {
+            return Some(client);
+        }
+
+        if !client_has_block_in_range(
+            &client.info.pruning_seed,
+            oldest_batch.start_height,
+            oldest_batch.ids.len(),
+        ) {
+            return Some(client);
+        }
+
+        tracing::debug!(
+            "Sending a hedged request for the oldest inflight batch, start height: {}",
+            oldest_batch.start_height
+        );
+
+        oldest_batch.request_sent(client.info.id);
+
+        self.block_download_tasks.spawn(download_batch_task(
+            client,
+            oldest_batch.ids.clone(),
+            oldest_batch.prev_id,
+            oldest_batch.start_height,
+            oldest_batch.requests_sent,
+        ));
+
+        None
+    }
+
     /// Spawns a task to request blocks from the given peer.
     ///
-    /// The batch requested will depend on our current state, failed batches will be prioritised.
+    /// The batch requested will depend on our current state, failed batches will be prioritised. Slow peers
+    /// are only given new batches, shortened according to their throughput.
     ///
     /// Returns the [`ClientPoolDropGuard`] back if it doesn't have the data we currently need according
-    /// to its pruning seed.
+    /// to its pruning seed, or if it is too slow to help with the batches we are waiting on.
     async fn request_block_batch(
         &mut self,
         chain_tracker: &mut ChainTracker<N>,
         client: ClientPoolDropGuard<N>,
     ) -> Option<ClientPoolDropGuard<N>> {
         tracing::trace!("Using peer to request a batch of blocks.");
+
+        // Slow peers are not given batches other batches are waiting on, they would only hold them up longer.
+        let slow_peer = self.peer_throughput.is_slow(&client.info.id);
+
         // First look to see if we have any failed requests.
-        while let Some(failed_request) = self.failed_batches.peek() {
+        while let Some(failed_request) = self.failed_batches.peek().filter(|_| !slow_peer) {
             // Check if we still have the request that failed - another peer could have completed it after
             // failure.
             let Some(request) = self.inflight_requests.get_mut(&failed_request.0) else {
@@ -378,7 +491,7 @@ where
                 tracing::debug!("Using peer to request a failed batch");
                 // They should have the blocks so send the re-request to this peer.
 
-                request.requests_sent += 1;
+                request.request_sent(client.info.id);
 
                 self.block_download_tasks.spawn(download_batch_task(
                     client,
@@ -397,22 +510,38 @@ where
             break;
         }
 
+        // Next, make sure the oldest batch is not held up by a slow peer.
+        let client = if slow_peer {
+            client
+        } else {
+            self.hedge_oldest_batch(client)?
+        };
+
         // If our ready queue is too large send duplicate requests for the blocks we are waiting on.
         if self.block_queue.size() >= self.config.in_progress_queue_size {
+            if slow_peer {
+                tracing::trace!("Peer is too slow to help clear the ready queue.");
+                return Some(client);
+            }
+
             return self.request_inflight_batch_again(client).await;
         }
 
         // No failed requests that we can handle, request some new blocks.
 
-        let Some(mut block_entry_to_get) = chain_tracker
-            .blocks_to_get(&client.info.pruning_seed, self.amount_of_blocks_to_request)
+        let batch_len = self
+            .peer_throughput
+            .batch_len_for_peer(&client.info.id, self.amount_of_blocks_to_request);
+
+        let Some(mut block_entry_to_get) =
+            chain_tracker.blocks_to_get(&client.info.pruning_seed, batch_len)
         else {
             return Some(client);
         };
 
         tracing::debug!("Requesting a new batch of blocks");
 
-        block_entry_to_get.requests_sent = 1;
+        block_entry_to_get.request_sent(client.info.id);
         self.inflight_requests
             .insert(block_entry_to_get.start_height, block_entry_to_get.clone());
 
@@ -565,6 +694,8 @@ where
                 Ok(())
             }
             Ok((client, block_batch)) => {
+                self.average_block_size = Some(block_batch.size / block_batch.blocks.len().max(1));
+
                 // Remove the batch from the inflight batches.
                 if self.inflight_requests.remove(&start_height).is_none() {
                     tracing::debug!("Already retrieved batch");
@@ -585,6 +716,7 @@ where
                     self.amount_of_blocks_to_request = calculate_next_block_batch_size(
                         block_batch.size,
                         block_batch.blocks.len(),
+                        self.amount_of_blocks_to_request,
                         self.config.target_batch_size,
                     );
 
@@ -652,9 +784,25 @@ where
                 Some(res) = self.block_download_tasks.join_next() => {
                     let BlockDownloadTaskResponse {
                         start_height,
+                        peer_id,
+                        peer_handle,
+                        elapsed,
                         result
                     } = res.expect("Download batch future panicked");
 
+                    match &result {
+                        Ok((_, block_batch)) => {
+                            self.peer_throughput.record_batch(peer_id, block_batch.size, elapsed);
+                        }
+                        // The peer is still connected, it was just too slow.
+                        Err(BlockDownloadError::TimedOut) if !peer_handle.is_closed() => {
+                            self.peer_throughput.record_timeout(peer_id);
+                        }
+                        // The client was dropped with the error, the peer has either disconnected or
+                        // misbehaved, so don't keep its estimate around.
+                        Err(_) => self.peer_throughput.remove(&peer_id),
+                    }
+
                     self.handle_download_batch_res(start_height, result, &mut chain_tracker, &mut pending_peers).await?;
 
                     // If we have no inflight requests, and we have had too many empty chain entries in a row assume the top has been found.
@@ -666,12 +814,20 @@ where
                 Some(Ok(res)) = self.chain_entry_task.join_next() => {
                     match res {
                         Ok((client, entry)) => {
-                            if chain_tracker.add_entry(entry).is_ok() {
-                                tracing::debug!("Successfully added chain entry to chain tracker.");
-                                self.amount_of_empty_chain_entries = 0;
-                            } else {
-                                tracing::debug!("Failed to add incoming chain entry to chain tracker.");
-                                self.amount_of_empty_chain_entries += 1;
+                            match chain_tracker.add_entry(entry) {
+                                Ok(()) => {
+                                    tracing::debug!("Successfully added chain entry to chain tracker.");
+                                    self.amount_of_empty_chain_entries = 0;
+                                }
+                                // Another peer already told us about these blocks, this does not mean
+                                // we are at the top.
+                                Err(ChainTrackerError::NewEntryAlreadyTracked) => {
+                                    tracing::debug!("Incoming chain entry was already tracked.");
+                                }
+                                Err(_) => {
+                                    tracing::debug!("Failed to add incoming chain entry to chain tracker.");
+                                    self.amount_of_empty_chain_entries += 1;
+                                }
                             }
 
                             pending_peers
@@ -693,6 +849,12 @@ where
 struct BlockDownloadTaskResponse<N: NetworkZone> {
     /// The start height of the batch.
     start_height: u64,
+    /// The peer the batch was requested from.
+    peer_id: InternalPeerID<N::Addr>,
+    /// The [`ConnectionHandle`] of the peer the batch was requested from.
+    peer_handle: ConnectionHandle,
+    /// The time the request took.
+    elapsed: Duration,
     /// A result containing the batch or an error.
     result: Result<(ClientPoolDropGuard<N>, BlockBatch), BlockDownloadError>,
 }
@@ -711,10 +873,13 @@ fn client_has_block_in_range(pruning_seed: &PruningSeed, start_height: u64, leng
 /// Parameters:
 /// - `previous_batch_size` is the size, in bytes, of the last batch
 /// - `previous_batch_len` is the amount of blocks in the last batch
+/// - `current_batch_len` is the amount of blocks we currently request in a batch, before
+///   adjusting for the peer's throughput
 /// - `target_batch_size` is the target size, in bytes, of a batch
 fn calculate_next_block_batch_size(
     previous_batch_size: usize,
     previous_batch_len: usize,
+    current_batch_len: usize,
     target_batch_size: usize,
 ) -> usize {
     // The average block size of the last batch of blocks, multiplied by 2 as a safety margin for
@@ -724,9 +889,12 @@ fn calculate_next_block_batch_size(
     // Set the amount of blocks to request equal to our target batch size divided by the adjusted_average_block_size.
     let next_batch_len = max(target_batch_size / adjusted_average_block_size, 1);
 
-    // Cap the amount of growth to 1.5x the previous batch len, to prevent a small block causing us to request
+    // Cap the amount of growth to 1.5x the current batch len, to prevent a small block causing us to request
     // a huge amount of blocks.
-    let next_batch_len = min(next_batch_len, (previous_batch_len * 3).div_ceil(2));
+    //
+    // The previous batch could be shorter than the current batch len, if it was from a slow peer, so it is
+    // not used here.
+    let next_batch_len = min(next_batch_len, (current_batch_len * 3).div_ceil(2));
 
     // Cap the length to the maximum allowed.
     min(next_batch_len, MAX_BLOCK_BATCH_LEN)
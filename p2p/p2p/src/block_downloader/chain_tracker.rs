@@ -1,4 +1,4 @@
-use std::{cmp::min, collections::VecDeque};
+use std::{cmp::min, collections::VecDeque, time::Instant};
 
 use cuprate_fixed_bytes::ByteArrayVec;
 
@@ -33,10 +33,23 @@ pub struct BlocksToRetrieve<N: NetworkZone> {
     pub peer_who_told_us_handle: ConnectionHandle,
     /// The number of requests sent for this batch.
     pub requests_sent: usize,
+    /// The peer the latest request for this batch was sent to.
+    pub requested_from: Option<InternalPeerID<N::Addr>>,
+    /// The time the latest request for this batch was sent.
+    pub requested_at: Option<Instant>,
     /// The number of times this batch has been requested from a peer and failed.
     pub failures: usize,
 }
 
+impl<N: NetworkZone> BlocksToRetrieve<N> {
+    /// Records that a request for this batch was sent to `peer`.
+    pub fn request_sent(&mut self, peer: InternalPeerID<N::Addr>) {
+        self.requests_sent += 1;
+        self.requested_from = Some(peer);
+        self.requested_at = Some(Instant::now());
+    }
+}
+
 /// An error returned from the [`ChainTracker`].
 #[derive(Debug, Clone)]
 pub enum ChainTrackerError {
@@ -44,6 +57,10 @@ pub enum ChainTrackerError {
     NewEntryIsInvalid,
     /// The new chain entry does not follow from the top of our chain tracker.
     NewEntryDoesNotFollowChain,
+    /// All the block IDs in the new chain entry are already being tracked.
+    ///
+    /// This happens when multiple peers are asked for the same chain entry.
+    NewEntryAlreadyTracked,
 }
 
 /// # Chain Tracker
@@ -117,7 +134,24 @@ impl<N: NetworkZone> ChainTracker<N> {
             .sum()
     }
 
+    /// Returns the amount of block IDs we track after `hash`, if `hash` is in our chain.
+    ///
+    /// This only searches the block IDs we still track, and the ID of the block before them.
+    fn tracked_ids_after(&self, hash: &[u8; 32]) -> Option<usize> {
+        if hash == &self.previous_hash {
+            return Some(self.entries.iter().map(|entry| entry.ids.len()).sum());
+        }
+
+        let mut ids = self.entries.iter().flat_map(|entry| entry.ids.iter()).rev();
+
+        ids.position(|id| id == hash)
+    }
+
     /// Attempts to add an incoming [`ChainEntry`] to the chain tracker.
+    ///
+    /// The entry does not have to start at the top of our chain, it can overlap block IDs we are already
+    /// tracking, i.e. if we asked multiple peers for the same entry. The overlapping IDs are checked against
+    /// ours and only the new IDs after our top block are added.
     pub fn add_entry(&mut self, mut chain_entry: ChainEntry<N>) -> Result<(), ChainTrackerError> {
         if chain_entry.ids.is_empty() {
             // The peer must send at lest one overlapping block.
@@ -129,17 +163,39 @@ impl<N: NetworkZone> ChainTracker<N> {
             return Err(ChainTrackerError::NewEntryDoesNotFollowChain);
         }
 
-        if self
+        let Some(tracked_after) = self.tracked_ids_after(&chain_entry.ids[0]) else {
+            return Err(ChainTrackerError::NewEntryDoesNotFollowChain);
+        };
+
+        // The amount of IDs in the entry we already know, including the first.
+        let overlap = tracked_after + 1;
+
+        // Make sure the overlapping IDs are the same as ours.
+        let total_tracked = self
+            .entries
+            .iter()
+            .map(|entry| entry.ids.len())
+            .sum::<usize>();
+        let tracked = self
             .entries
-            .back()
-            .is_some_and(|last_entry| last_entry.ids.last().unwrap() != &chain_entry.ids[0])
+            .iter()
+            .flat_map(|entry| entry.ids.iter())
+            .skip(total_tracked - tracked_after);
+
+        if !tracked
+            .zip(&chain_entry.ids[1..])
+            .all(|(tracked_id, id)| tracked_id == id)
         {
             return Err(ChainTrackerError::NewEntryDoesNotFollowChain);
         }
 
+        if overlap >= chain_entry.ids.len() {
+            return Err(ChainTrackerError::NewEntryAlreadyTracked);
+        }
+
         let new_entry = ChainEntry {
-            // ignore the first block - we already know it.
-            ids: chain_entry.ids.split_off(1),
+            // ignore the blocks we already know.
+            ids: chain_entry.ids.split_off(overlap),
             peer: chain_entry.peer,
             handle: chain_entry.handle,
         };
@@ -195,6 +251,8 @@ impl<N: NetworkZone> ChainTracker<N> {
             peer_who_told_us: entry.peer,
             peer_who_told_us_handle: entry.handle.clone(),
             requests_sent: 0,
+            requested_from: None,
+            requested_at: None,
             failures: 0,
         };
 
@@ -209,3 +267,159 @@ impl<N: NetworkZone> ChainTracker<N> {
         Some(blocks)
     }
 }
+
+#[cfg(test)]
+mod tests {
+    use std::sync::Arc;
+
+    use tokio::sync::Semaphore;
+
+    use cuprate_p2p_core::{handles::HandleBuilder, network_zones::ClearNet};
+
+    use super::*;
+
+    /// The hash of the block before the ones the tracker is created with.
+    const PREVIOUS: u8 = 0;
+    /// The hash of the genesis block.
+    const GENESIS: u8 = 255;
+
+    /// Returns the block ID `n`.
+    fn id(n: u8) -> [u8; 32] {
+        [n; 32]
+    }
+
+    /// Returns a [`ChainEntry`] of the block IDs `ids`.
+    fn entry(ids: &[u8]) -> ChainEntry<ClearNet> {
+        let (_, handle) = HandleBuilder::new()
+            .with_permit(Arc::new(Semaphore::new(1)).try_acquire_owned().unwrap())
+            .build();
+
+        ChainEntry {
+            ids: ids.iter().copied().map(id).collect(),
+            peer: InternalPeerID::Unknown(0),
+            handle,
+        }
+    }
+
+    /// Returns a [`ChainTracker`] tracking blocks `1`, `2` and `3`, from height `1`.
+    fn tracker() -> ChainTracker<ClearNet> {
+        ChainTracker::new(entry(&[1, 2, 3]), 1, id(GENESIS), id(PREVIOUS))
+    }
+
+    /// Gets all the block IDs left in `tracker`.
+    fn blocks_to_get(tracker: &mut ChainTracker<ClearNet>) -> Vec<[u8; 32]> {
+        let mut ids = Vec::new();
+
+        while let Some(blocks) = tracker.blocks_to_get(&PruningSeed::NotPruned, 100) {
+            ids.extend(Vec::<[u8; 32]>::from(&blocks.ids));
+        }
+
+        ids
+    }
+
+    #[test]
+    fn fully_tracked_entry() {
+        let mut tracker = tracker();
+
+        assert!(matches!(
+            tracker.add_entry(entry(&[1, 2, 3])),
+            Err(ChainTrackerError::NewEntryAlreadyTracked)
+        ));
+        assert!(matches!(
+            tracker.add_entry(entry(&[2, 3])),
+            Err(ChainTrackerError::NewEntryAlreadyTracked)
+        ));
+        assert!(matches!(
+            tracker.add_entry(entry(&[PREVIOUS, 1, 2])),
+            Err(ChainTrackerError::NewEntryAlreadyTracked)
+        ));
+
+        assert_eq!(tracker.top_height(), 4);
+        assert_eq!(blocks_to_get(&mut tracker), [id(1), id(2), id(3)]);
+    }
+
+    #[test]
+    fn partially_overlapping_entry() {
+        let mut tracker = tracker();
+
+        tracker.add_entry(entry(&[2, 3, 4, 5])).unwrap();
+
+        assert_eq!(tracker.top_height(), 6);
+        assert_eq!(tracker.get_simple_history(), [id(5), id(GENESIS)]);
+        assert_eq!(
+            blocks_to_get(&mut tracker),
+            [id(1), id(2), id(3), id(4), id(5)]
+        );
+    }
+
+    #[test]
+    fn disagreeing_overlap() {
+        let mut tracker = tracker();
+
+        assert!(matches!(
+            tracker.add_entry(entry(&[1, 9, 3, 4])),
+            Err(ChainTrackerError::NewEntryDoesNotFollowChain)
+        ));
+        // The entry agrees with our first IDs, but has a different block 3.
+        assert!(matches!(
+            tracker.add_entry(entry(&[PREVIOUS, 1, 2, 9, 4])),
+            Err(ChainTrackerError::NewEntryDoesNotFollowChain)
+        ));
+        assert!(matches!(
+            tracker.add_entry(entry(&[9, 3, 4])),
+            Err(ChainTrackerError::NewEntryDoesNotFollowChain)
+        ));
+
+        assert_eq!(tracker.top_height(), 4);
+        assert_eq!(blocks_to_get(&mut tracker), [id(1), id(2), id(3)]);
+    }
+
+    #[test]
+    fn entry_starting_at_previous_hash() {
+        let mut tracker = tracker();
+
+        tracker.add_entry(entry(&[PREVIOUS, 1, 2, 3, 4])).unwrap();
+
+        assert_eq!(tracker.top_height(), 5);
+        assert_eq!(blocks_to_get(&mut tracker), [id(1), id(2), id(3), id(4)]);
+    }
+
+    #[test]
+    fn empty_tracker() {
+        let mut tracker = tracker();
+        assert_eq!(blocks_to_get(&mut tracker), [id(1), id(2), id(3)]);
+        assert_eq!(tracker.block_requests_queued(1), 0);
+
+        // Only the last block handed out is still known.
+        assert!(matches!(
+            tracker.add_entry(entry(&[2, 3, 4])),
+            Err(ChainTrackerError::NewEntryDoesNotFollowChain)
+        ));
+        assert!(matches!(
+            tracker.add_entry(entry(&[3])),
+            Err(ChainTrackerError::NewEntryDoesNotFollowChain)
+        ));
+
+        tracker.add_entry(entry(&[3, 4, 5])).unwrap();
+        assert_eq!(tracker.top_height(), 6);
+
+        let blocks = tracker.blocks_to_get(&PruningSeed::NotPruned, 100).unwrap();
+        assert_eq!(blocks.start_height, 4);
+        assert_eq!(blocks.prev_id, id(3));
+        assert_eq!(blocks.ids.len(), 2);
+    }
+
+    #[test]
+    fn invalid_entries() {
+        let mut tracker = tracker();
+
+        assert!(matches!(
+            tracker.add_entry(entry(&[])),
+            Err(ChainTrackerError::NewEntryIsInvalid)
+        ));
+        assert!(matches!(
+            tracker.add_entry(entry(&[3])),
+            Err(ChainTrackerError::NewEntryDoesNotFollowChain)
+        ));
+    }
+}
@@ -1,4 +1,4 @@
-use std::collections::HashSet;
+use std::{collections::HashSet, time::Instant};
 
 use monero_serai::{block::Block, transaction::Transaction};
 use rayon::prelude::*;
@@ -9,6 +9,7 @@ use tracing::instrument;
 use cuprate_fixed_bytes::ByteArrayVec;
 use cuprate_helper::asynch::rayon_spawn_async;
 use cuprate_p2p_core::{handles::ConnectionHandle, NetworkZone, PeerRequest, PeerResponse};
+use cuprate_types::{UnverifiedBlockInformation, UnverifiedTransactionInformation};
 use cuprate_wire::protocol::{GetObjectsRequest, GetObjectsResponse};
 
 use crate::{
@@ -34,9 +35,18 @@ pub async fn download_batch_task<N: NetworkZone>(
     expected_start_height: u64,
     _attempt: usize,
 ) -> BlockDownloadTaskResponse<N> {
+    let peer_id = client.info.id;
+    let peer_handle = client.info.handle.clone();
+    let start = Instant::now();
+
+    let result = request_batch_from_peer(client, ids, previous_id, expected_start_height).await;
+
     BlockDownloadTaskResponse {
         start_height: expected_start_height,
-        result: request_batch_from_peer(client, ids, previous_id, expected_start_height).await,
+        peer_id,
+        peer_handle,
+        elapsed: start.elapsed(),
+        result,
     }
 }
 
@@ -117,8 +127,8 @@ fn deserialize_batch(
 
             let mut size = block_entry.block.len();
 
-            let block = Block::read(&mut block_entry.block.as_ref())
-                .map_err(|_| BlockDownloadError::PeersResponseWasInvalid)?;
+            let block_blob = block_entry.block;
+            let block = read_canonical(&block_blob, Block::read, Block::serialize)?;
 
             let block_hash = block.hash();
 
@@ -169,8 +179,13 @@ fn deserialize_batch(
                         return Err(BlockDownloadError::PeersResponseWasInvalid);
                     }
 
-                    Transaction::read(&mut tx_blob.as_ref())
-                        .map_err(|_| BlockDownloadError::PeersResponseWasInvalid)
+                    let tx = read_canonical(&tx_blob, Transaction::read, Transaction::serialize)?;
+
+                    Ok(UnverifiedTransactionInformation {
+                        tx_hash: tx.hash(),
+                        tx_blob: tx_blob.to_vec(),
+                        tx,
+                    })
                 })
                 .collect::<Result<Vec<_>, _>>()?;
 
@@ -178,7 +193,7 @@ fn deserialize_batch(
             let mut expected_txs = block.txs.iter().collect::<HashSet<_>>();
 
             for tx in &txs {
-                if !expected_txs.remove(&tx.hash()) {
+                if !expected_txs.remove(&tx.tx_hash) {
                     return Err(BlockDownloadError::PeersResponseWasInvalid);
                 }
             }
@@ -187,7 +202,15 @@ fn deserialize_batch(
                 return Err(BlockDownloadError::PeersResponseWasInvalid);
             }
 
-            Ok(((block, txs), size))
+            Ok((
+                UnverifiedBlockInformation {
+                    block,
+                    block_blob: block_blob.to_vec(),
+                    block_hash,
+                    txs,
+                },
+                size,
+            ))
         })
         .collect::<Result<(Vec<_>, Vec<_>), _>>()?;
 
@@ -197,3 +220,24 @@ fn deserialize_batch(
         peer_handle,
     })
 }
+
+/// Deserializes `blob` with `read`, making sure `blob` is the value's serialised form.
+///
+/// `blob` is passed on instead of serialising the value again, so it must be exactly what
+/// `serialize` would return. A blob can parse and still not be, i.e. if it has trailing bytes
+/// or a non-canonical encoding, so the value is serialised again and compared.
+pub(super) fn read_canonical<T>(
+    blob: &[u8],
+    read: impl FnOnce(&mut &[u8]) -> std::io::Result<T>,
+    serialize: impl FnOnce(&T) -> Vec<u8>,
+) -> Result<T, BlockDownloadError> {
+    let mut reader = blob;
+
+    let value = read(&mut reader).map_err(|_| BlockDownloadError::PeersResponseWasInvalid)?;
+
+    if !reader.is_empty() || serialize(&value) != blob {
+        return Err(BlockDownloadError::PeersResponseWasInvalid);
+    }
+
+    Ok(value)
+}
@@ -0,0 +1,268 @@
+//! # Peer Throughput
+//!
+//! This module contains [`PeerThroughput`], which keeps an estimate of how fast each peer sends us
+//! blocks, so the block downloader can give more work to fast peers and keep slow peers off the
+//! batches everything else is waiting on.
+use std::{collections::HashMap, hash::Hash, time::Duration};
+
+use cuprate_p2p_core::client::InternalPeerID;
+
+use crate::constants::{
+    PEER_THROUGHPUT_EWMA_WEIGHT, SLOW_PEER_MIN_BATCH_FRACTION, SLOW_PEER_THROUGHPUT_FRACTION,
+};
+
+/// Estimates of each peer's download throughput, in bytes per second.
+///
+/// Each estimate is an exponentially weighted moving average of the throughput of the peer's
+/// previous batches.
+pub(crate) struct PeerThroughput<A> {
+    /// The throughput estimates of each peer we have downloaded a batch from.
+    rates: HashMap<InternalPeerID<A>, f64>,
+    /// The values of [`Self::rates`], sorted.
+    ///
+    /// This is updated whenever an estimate changes, so percentiles (and the median every
+    /// [`Self::relative_rate`] call needs) are not recalculated on every lookup, i.e. while
+    /// sorting peers by their rate.
+    sorted_rates: Vec<f64>,
+}
+
+impl<A: Hash + Eq> PeerThroughput<A> {
+    /// Creates a new [`PeerThroughput`], with no estimates.
+    pub(crate) fn new() -> Self {
+        Self {
+            rates: HashMap::new(),
+            sorted_rates: Vec::new(),
+        }
+    }
+
+    /// Records that `peer` sent a batch of `bytes` in `elapsed`.
+    pub(crate) fn record_batch(
+        &mut self,
+        peer: InternalPeerID<A>,
+        bytes: usize,
+        elapsed: Duration,
+    ) {
+        // Avoid dividing by zero, a batch cannot realistically be received faster than this anyway.
+        let secs = elapsed.as_secs_f64().max(0.001);
+
+        #[allow(clippy::cast_precision_loss)]
+        let sample = bytes as f64 / secs;
+
+        self.rates
+            .entry(peer)
+            .and_modify(|rate| {
+                *rate = PEER_THROUGHPUT_EWMA_WEIGHT * sample
+                    + (1.0 - PEER_THROUGHPUT_EWMA_WEIGHT) * *rate;
+            })
+            .or_insert(sample);
+
+        self.sort_rates();
+    }
+
+    /// Records that a request to `peer` timed out.
+    ///
+    /// This counts as a batch that was received with no throughput.
+    pub(crate) fn record_timeout(&mut self, peer: InternalPeerID<A>) {
+        self.record_batch(peer, 0, Duration::from_secs(1));
+    }
+
+    /// Removes the estimate for `peer`, i.e. because it disconnected.
+    pub(crate) fn remove(&mut self, peer: &InternalPeerID<A>) {
+        if self.rates.remove(peer).is_some() {
+            self.sort_rates();
+        }
+    }
+
+    /// Rebuilds [`Self::sorted_rates`] from [`Self::rates`].
+    fn sort_rates(&mut self) {
+        self.sorted_rates.clear();
+        self.sorted_rates.extend(self.rates.values().copied());
+        self.sorted_rates.sort_unstable_by(f64::total_cmp);
+    }
+
+    /// Returns the throughput estimate for `peer`, if we have downloaded a batch from it.
+    pub(crate) fn rate(&self, peer: &InternalPeerID<A>) -> Option<f64> {
+        self.rates.get(peer).copied()
+    }
+
+    /// Returns how long `peer` is expected to take to send `bytes`, at its estimated throughput.
+    ///
+    /// Returns [`None`] if we have no estimate for `peer`, or if its estimate is zero.
+    pub(crate) fn expected_time(&self, peer: &InternalPeerID<A>, bytes: usize) -> Option<Duration> {
+        let rate = self.rate(peer).filter(|rate| *rate > 0.0)?;
+
+        #[allow(clippy::cast_precision_loss)]
+        Duration::try_from_secs_f64(bytes as f64 / rate).ok()
+    }
+
+    /// Returns the throughput at `percentile` (between `0.0` and `1.0`) of all peers with an estimate.
+    fn percentile(&self, percentile: f64) -> Option<f64> {
+        let rates = &self.sorted_rates;
+        if rates.is_empty() {
+            return None;
+        }
+
+        #[allow(
+            clippy::cast_precision_loss,
+            clippy::cast_possible_truncation,
+            clippy::cast_sign_loss
+        )]
+        let idx = (rates.len() as f64 * percentile) as usize;
+
+        Some(rates[idx.min(rates.len() - 1)])
+    }
+
+    /// Returns the median throughput of all peers with an estimate.
+    fn median(&self) -> Option<f64> {
+        self.percentile(0.5)
+    }
+
+    /// Returns if `peer`'s throughput is below `percentile` (between `0.0` and `1.0`) of all peers.
+    ///
+    /// Peers we have no estimate for are never below a percentile.
+    pub(crate) fn is_below_percentile(&self, peer: &InternalPeerID<A>, percentile: f64) -> bool {
+        self.rate(peer)
+            .zip(self.percentile(percentile))
+            .is_some_and(|(rate, percentile_rate)| rate < percentile_rate)
+    }
+
+    /// Returns `peer`'s throughput relative to the median peer's.
+    ///
+    /// Peers we have no estimate for are assumed to be average, i.e. this will return `1.0`.
+    pub(crate) fn relative_rate(&self, peer: &InternalPeerID<A>) -> f64 {
+        match (self.rate(peer), self.median()) {
+            (Some(rate), Some(median)) if median > 0.0 => rate / median,
+            // All peers have had batches time out.
+            (Some(rate), Some(_)) if rate == 0.0 => 1.0,
+            (Some(_), Some(_)) => f64::INFINITY,
+            _ => 1.0,
+        }
+    }
+
+    /// Returns if `peer` is slow compared to the other peers.
+    pub(crate) fn is_slow(&self, peer: &InternalPeerID<A>) -> bool {
+        self.relative_rate(peer) < SLOW_PEER_THROUGHPUT_FRACTION
+    }
+
+    /// Returns the amount of blocks `peer` should be asked for in a batch, from the amount
+    /// we would ask an average peer for.
+    ///
+    /// Slow peers are given proportionally smaller batches, so they hold up the batches after
+    /// them for less time.
+    pub(crate) fn batch_len_for_peer(&self, peer: &InternalPeerID<A>, batch_len: usize) -> usize {
+        let fraction = self
+            .relative_rate(peer)
+            .clamp(SLOW_PEER_MIN_BATCH_FRACTION, 1.0);
+
+        #[allow(
+            clippy::cast_precision_loss,
+            clippy::cast_possible_truncation,
+            clippy::cast_sign_loss
+        )]
+        let len = (batch_len as f64 * fraction).ceil() as usize;
+
+        len.clamp(1, batch_len.max(1))
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn peer(id: u128) -> InternalPeerID<()> {
+        InternalPeerID::Unknown(id)
+    }
+
+    #[test]
+    fn unknown_peers_are_average() {
+        let mut throughput = PeerThroughput::new();
+
+        assert_eq!(throughput.relative_rate(&peer(0)), 1.0);
+        assert_eq!(throughput.batch_len_for_peer(&peer(0), 100), 100);
+
+        throughput.record_batch(peer(1), 1_000, Duration::from_secs(1));
+
+        assert_eq!(throughput.relative_rate(&peer(0)), 1.0);
+        assert!(!throughput.is_slow(&peer(0)));
+    }
+
+    #[test]
+    fn slow_peers_get_smaller_batches() {
+        let mut throughput = PeerThroughput::new();
+
+        throughput.record_batch(peer(0), 1_000_000, Duration::from_secs(1));
+        throughput.record_batch(peer(1), 1_000_000, Duration::from_secs(1));
+        throughput.record_batch(peer(2), 100_000, Duration::from_secs(1));
+
+        assert!(!throughput.is_slow(&peer(0)));
+        assert!(throughput.is_slow(&peer(2)));
+
+        assert_eq!(throughput.batch_len_for_peer(&peer(0), 100), 100);
+        assert_eq!(throughput.batch_len_for_peer(&peer(2), 100), 10);
+    }
+
+    #[test]
+    fn below_percentile() {
+        let mut throughput = PeerThroughput::new();
+
+        for i in 0..4 {
+            throughput.record_batch(peer(i), 1_000 * (i as usize + 1), Duration::from_secs(1));
+        }
+
+        assert!(throughput.is_below_percentile(&peer(0), 0.25));
+        assert!(!throughput.is_below_percentile(&peer(1), 0.25));
+        assert!(!throughput.is_below_percentile(&peer(4), 0.25));
+    }
+
+    #[test]
+    fn timeouts_lower_the_estimate() {
+        let mut throughput = PeerThroughput::new();
+
+        throughput.record_batch(peer(0), 1_000_000, Duration::from_secs(1));
+        throughput.record_batch(peer(1), 1_000_000, Duration::from_secs(1));
+
+        for _ in 0..10 {
+            throughput.record_timeout(peer(1));
+        }
+
+        assert!(throughput.is_slow(&peer(1)));
+
+        throughput.remove(&peer(1));
+        assert_eq!(throughput.rate(&peer(1)), None);
+        assert!(!throughput.is_slow(&peer(0)));
+    }
+
+    #[test]
+    fn expected_time() {
+        let mut throughput = PeerThroughput::new();
+
+        assert_eq!(throughput.expected_time(&peer(0), 1_000), None);
+
+        throughput.record_batch(peer(0), 1_000, Duration::from_secs(1));
+        assert_eq!(
+            throughput.expected_time(&peer(0), 5_000),
+            Some(Duration::from_secs(5))
+        );
+
+        throughput.record_batch(peer(1), 0, Duration::from_secs(1));
+        assert_eq!(throughput.expected_time(&peer(1), 1_000), None);
+    }
+
+    #[test]
+    fn median_follows_estimates() {
+        let mut throughput = PeerThroughput::new();
+
+        throughput.record_batch(peer(0), 1_000, Duration::from_secs(1));
+        throughput.record_batch(peer(1), 4_000, Duration::from_secs(1));
+        throughput.record_batch(peer(2), 4_000, Duration::from_secs(1));
+
+        assert_eq!(throughput.relative_rate(&peer(0)), 0.25);
+
+        throughput.remove(&peer(1));
+        throughput.remove(&peer(2));
+        assert_eq!(throughput.relative_rate(&peer(0)), 1.0);
+
+        throughput.record_batch(peer(1), 500, Duration::from_secs(1));
+        assert_eq!(throughput.relative_rate(&peer(1)), 0.5);
+    }
+}
@@ -2,7 +2,10 @@ use std::{mem, sync::Arc};
 
 use rand::prelude::SliceRandom;
 use rand::thread_rng;
-use tokio::{task::JoinSet, time::timeout};
+use tokio::{
+    task::JoinSet,
+    time::{timeout, timeout_at, Instant},
+};
 use tower::{Service, ServiceExt};
 use tracing::{instrument, Instrument, Span};
 
@@ -22,7 +25,7 @@ use crate::{
     client_pool::{ClientPool, ClientPoolDropGuard},
     constants::{
         BLOCK_DOWNLOADER_REQUEST_TIMEOUT, INITIAL_CHAIN_REQUESTS_TO_SEND,
-        MAX_BLOCKS_IDS_IN_CHAIN_ENTRY, MEDIUM_BAN,
+        INITIAL_CHAIN_SEARCH_MIN_WAIT, MAX_BLOCKS_IDS_IN_CHAIN_ENTRY, MEDIUM_BAN,
     },
 };
 
@@ -139,6 +142,8 @@ where
 
     tracing::debug!("Sending requests for chain entries.");
 
+    let start = Instant::now();
+
     // Send the requests.
     while futs.len() < INITIAL_CHAIN_REQUESTS_TO_SEND {
         let Some(mut next_peer) = peers.next() else {
@@ -167,12 +172,33 @@ where
 
     let mut res: Option<(ChainResponse, InternalPeerID<_>, ConnectionHandle)> = None;
 
+    // The time to stop waiting for more responses, set once we get the first response.
+    let mut deadline = None;
+
     // Wait for the peers responses.
-    while let Some(task_res) = futs.join_next().await {
+    loop {
+        let task_res = match deadline {
+            Some(deadline) => match timeout_at(deadline, futs.join_next()).await {
+                Ok(task_res) => task_res,
+                Err(_) => break,
+            },
+            None => futs.join_next().await,
+        };
+
+        let Some(task_res) = task_res else {
+            break;
+        };
+
         let Ok(Ok(task_res)) = task_res.unwrap() else {
             continue;
         };
 
+        // Give the other peers as long as the first took to respond, so one slow peer
+        // can't hold up the whole search.
+        if deadline.is_none() {
+            deadline = Some(Instant::now() + start.elapsed().max(INITIAL_CHAIN_SEARCH_MIN_WAIT));
+        }
+
         match &mut res {
             Some(res) => {
                 // res has already been set, replace it if this peer claims higher cumulative difficulty
@@ -187,6 +213,9 @@ where
         }
     }
 
+    // Let any requests still in flight finish in the background, so their peers are returned to the pool.
+    futs.detach_all();
+
     let Some((chain_res, peer_id, peer_handle)) = res else {
         return Err(BlockDownloadError::FailedToFindAChainToFollow);
     };
@@ -14,8 +14,11 @@ use monero_serai::{
     ringct::{RctBase, RctPrunable, RctSignatures},
     transaction::{Input, Timelock, Transaction, TransactionPrefix},
 };
-use proptest::{collection::vec, prelude::*};
-use tokio::{sync::Semaphore, time::timeout};
+use proptest::{collection::vec, prelude::*, strategy::ValueTree, test_runner::TestRunner};
+use tokio::{
+    sync::Semaphore,
+    time::{sleep, timeout},
+};
 use tower::{service_fn, Service};
 
 use cuprate_fixed_bytes::ByteArrayVec;
@@ -32,8 +35,15 @@ use cuprate_wire::{
 };
 
 use crate::{
-    block_downloader::{download_blocks, BlockDownloaderConfig, ChainSvcRequest, ChainSvcResponse},
+    block_downloader::{
+        download_batch::read_canonical, download_blocks, request_chain::initial_chain_search,
+        BlockDownloaderConfig, ChainSvcRequest, ChainSvcResponse,
+    },
     client_pool::ClientPool,
+    constants::{
+        BLOCK_DOWNLOADER_REQUEST_TIMEOUT, HEDGE_REQUEST_AFTER, INITIAL_CHAIN_REQUESTS_TO_SEND,
+        INITIAL_CHAIN_SEARCH_MIN_WAIT,
+    },
 };
 
 proptest! {
@@ -45,7 +55,7 @@ proptest! {
     })]
 
     #[test]
-    fn test_block_downloader(blockchain in dummy_blockchain_stragtegy(), peers in 1_usize..128) {
+    fn test_block_downloader(blockchain in dummy_blockchain_stragtegy(1..50_000), peers in 1_usize..128) {
         let blockchain = Arc::new(blockchain);
 
         let tokio_pool = tokio::runtime::Builder::new_multi_thread().enable_all().build().unwrap();
@@ -57,7 +67,7 @@ proptest! {
                 let mut peer_ids = Vec::with_capacity(peers);
 
                 for _ in 0..peers {
-                    let client = mock_block_downloader_client(blockchain.clone());
+                    let client = mock_block_downloader_client(blockchain.clone(), Duration::ZERO, Duration::ZERO);
 
                     peer_ids.push(client.info.id);
 
@@ -83,13 +93,181 @@ proptest! {
                 assert_eq!(blocks.len() + 1, blockchain.blocks.len());
 
                 for (i, block) in blocks.into_iter().enumerate() {
-                    assert_eq!(&block, blockchain.blocks.get_index(i + 1).unwrap().1);
+                    let (expected_block, expected_txs) =
+                        blockchain.blocks.get_index(i + 1).unwrap().1;
+
+                    assert_eq!(&block.block, expected_block);
+                    assert_eq!(block.block_blob, expected_block.serialize());
+                    assert_eq!(block.block_hash, expected_block.hash());
+
+                    assert_eq!(block.txs.len(), expected_txs.len());
+                    for (tx, expected_tx) in block.txs.iter().zip(expected_txs) {
+                        assert_eq!(&tx.tx, expected_tx);
+                        assert_eq!(tx.tx_blob, expected_tx.serialize());
+                        assert_eq!(tx.tx_hash, expected_tx.hash());
+                    }
                 }
             }).await
         }).unwrap();
     }
 }
 
+/// A peer that takes a long time to send its batch should not hold up the batches after it, the
+/// batch should be requested from a faster peer instead.
+#[test]
+fn slow_peer_does_not_hold_up_download() {
+    /// How long the slow peer takes to send a batch, less than the request timeout so only a
+    /// hedged request can stop it holding up the download.
+    ///
+    /// [`HEDGE_REQUEST_AFTER`] is shortened in tests, so this does not take long in real time.
+    const SLOW_PEER_DELAY: Duration = HEDGE_REQUEST_AFTER.saturating_mul(3);
+    const _: () = assert!(SLOW_PEER_DELAY.as_nanos() < BLOCK_DOWNLOADER_REQUEST_TIMEOUT.as_nanos());
+
+    let blockchain = dummy_blockchain_stragtegy(1_000..1_001)
+        .new_tree(&mut TestRunner::deterministic())
+        .unwrap()
+        .current();
+    let blockchain = Arc::new(blockchain);
+
+    let tokio_pool = tokio::runtime::Builder::new_multi_thread()
+        .enable_all()
+        .build()
+        .unwrap();
+
+    tokio_pool.block_on(async move {
+        let client_pool = ClientPool::new();
+
+        let mut peer_ids = Vec::new();
+
+        for delay in [
+            SLOW_PEER_DELAY,
+            Duration::ZERO,
+            Duration::ZERO,
+            Duration::ZERO,
+            Duration::ZERO,
+        ] {
+            let client = mock_block_downloader_client(blockchain.clone(), Duration::ZERO, delay);
+
+            peer_ids.push(client.info.id);
+
+            client_pool.add_new_client(client);
+        }
+
+        let stream = download_blocks(
+            client_pool,
+            SyncStateSvc(peer_ids),
+            OurChainSvc {
+                genesis: *blockchain.blocks.first().unwrap().0,
+            },
+            BlockDownloaderConfig {
+                buffer_size: 1_000,
+                // Large enough that batches are never requested again to clear the queue.
+                in_progress_queue_size: usize::MAX,
+                check_client_pool_interval: Duration::from_millis(100),
+                target_batch_size: 5_000,
+                initial_batch_size: 1,
+            },
+        );
+
+        let blocks = timeout(
+            HEDGE_REQUEST_AFTER + (SLOW_PEER_DELAY - HEDGE_REQUEST_AFTER) / 2,
+            stream.map(|blocks| blocks.blocks).concat(),
+        )
+        .await
+        .expect("The slow peer held up the download");
+
+        assert_eq!(blocks.len() + 1, blockchain.blocks.len());
+
+        for (i, block) in blocks.into_iter().enumerate() {
+            let (expected_block, _) = blockchain.blocks.get_index(i + 1).unwrap().1;
+
+            assert_eq!(&block.block, expected_block);
+        }
+    });
+}
+
+/// Peers that do not answer the initial chain search should not hold it up once another peer has
+/// answered.
+#[test]
+fn initial_chain_search_deadline() {
+    let blockchain = dummy_blockchain_stragtegy(100..101)
+        .new_tree(&mut TestRunner::deterministic())
+        .unwrap()
+        .current();
+    let blockchain = Arc::new(blockchain);
+
+    let tokio_pool = tokio::runtime::Builder::new_multi_thread()
+        .enable_all()
+        .build()
+        .unwrap();
+
+    tokio_pool.block_on(async move {
+        let client_pool = ClientPool::new();
+
+        let mut peer_ids = Vec::new();
+
+        // Only one of the peers we send the initial requests to answers before the request timeout.
+        for i in 0..INITIAL_CHAIN_REQUESTS_TO_SEND {
+            let delay = if i == 0 {
+                Duration::ZERO
+            } else {
+                BLOCK_DOWNLOADER_REQUEST_TIMEOUT * 2
+            };
+
+            let client = mock_block_downloader_client(blockchain.clone(), delay, Duration::ZERO);
+
+            peer_ids.push(client.info.id);
+
+            client_pool.add_new_client(client);
+        }
+
+        let chain_tracker = timeout(
+            INITIAL_CHAIN_SEARCH_MIN_WAIT * 5,
+            initial_chain_search(
+                &client_pool,
+                SyncStateSvc(peer_ids),
+                OurChainSvc {
+                    genesis: *blockchain.blocks.first().unwrap().0,
+                },
+            ),
+        )
+        .await
+        .expect("The initial chain search waited for the slow peers")
+        .unwrap();
+
+        assert_eq!(
+            chain_tracker.top_height(),
+            u64::try_from(blockchain.blocks.len()).unwrap()
+        );
+    });
+}
+
+/// Blobs that parse but are not what serialising the value gives back should be rejected, as
+/// the blobs are passed on instead of serialising again.
+#[test]
+fn non_canonical_blobs_are_rejected() {
+    let tx = dummy_transaction_stragtegy(0)
+        .new_tree(&mut TestRunner::deterministic())
+        .unwrap()
+        .current();
+    let blob = tx.serialize();
+
+    assert_eq!(
+        read_canonical(&blob, Transaction::read, Transaction::serialize).unwrap(),
+        tx
+    );
+
+    let mut trailing = blob.clone();
+    trailing.push(0);
+    assert!(read_canonical(&trailing, Transaction::read, Transaction::serialize).is_err());
+
+    // The version is the first field, encode it as a 2 byte varint.
+    assert_eq!(blob[0], 1);
+    let mut padded = vec![0x81, 0];
+    padded.extend_from_slice(&blob[1..]);
+    assert!(read_canonical(&padded, Transaction::read, Transaction::serialize).is_err());
+}
+
 prop_compose! {
     /// Returns a strategy to generate a [`Transaction`] that is valid for the block downloader.
     fn dummy_transaction_stragtegy(height: u64)
@@ -160,9 +338,9 @@ impl Debug for MockBlockchain {
 }
 
 prop_compose! {
-    /// Returns a strategy to generate a [`MockBlockchain`].
-    fn dummy_blockchain_stragtegy()(
-        blocks in vec(dummy_block_stragtegy(0, [0; 32]), 1..50_000),
+    /// Returns a strategy to generate a [`MockBlockchain`] with an amount of blocks in `len`.
+    fn dummy_blockchain_stragtegy(len: std::ops::Range<usize>)(
+        blocks in vec(dummy_block_stragtegy(0, [0; 32]), len),
     ) -> MockBlockchain {
         let mut blockchain = IndexMap::new();
 
@@ -181,7 +359,13 @@ prop_compose! {
     }
 }
 
-fn mock_block_downloader_client(blockchain: Arc<MockBlockchain>) -> Client<ClearNet> {
+/// Returns a mock peer with `blockchain`, that takes `get_chain_delay` to respond to chain requests
+/// and `get_objects_delay` to respond to block requests.
+fn mock_block_downloader_client(
+    blockchain: Arc<MockBlockchain>,
+    get_chain_delay: Duration,
+    get_objects_delay: Duration,
+) -> Client<ClearNet> {
     let semaphore = Arc::new(Semaphore::new(1));
 
     let (connection_guard, connection_handle) = cuprate_p2p_core::handles::HandleBuilder::new()
@@ -194,6 +378,8 @@ fn mock_block_downloader_client(blockchain: Arc<MockBlockchain>) -> Client<Clear
         async move {
             match req {
                 PeerRequest::GetChain(chain_req) => {
+                    sleep(get_chain_delay).await;
+
                     let mut i = 0;
                     while !bc.blocks.contains_key(&chain_req.block_ids[i]) {
                         i += 1;
@@ -227,6 +413,8 @@ fn mock_block_downloader_client(blockchain: Arc<MockBlockchain>) -> Client<Clear
                 }
 
                 PeerRequest::GetObjects(obj) => {
+                    sleep(get_objects_delay).await;
+
                     let mut res = Vec::with_capacity(obj.blocks.len());
 
                     for i in 0..obj.blocks.len() {
@@ -27,7 +27,9 @@ use cuprate_p2p_core::{
 };
 use cuprate_wire::{
     common::{BlockCompleteEntry, TransactionBlobs},
+    levin::Bucket,
     protocol::{NewFluffyBlock, NewTransactions},
+    LevinCommand,
 };
 
 use crate::constants::{
@@ -77,10 +79,8 @@ pub fn init_broadcast_channels<N: NetworkZone>(
 
     // Set a default value for init - the broadcast streams given to the peer tasks will only broadcast from this channel when the value
     // changes so no peer will get sent this.
-    let (block_watch_sender, block_watch_receiver) = watch::channel(NewBlockInfo {
-        block_bytes: Default::default(),
-        current_blockchain_height: 0,
-    });
+    let (block_watch_sender, block_watch_receiver) =
+        watch::channel(NewBlockInfo::new(Bytes::new(), 0));
 
     // create the inbound/outbound broadcast channels.
     let (tx_broadcast_channel_outbound_sender, tx_broadcast_channel_outbound_receiver) =
@@ -179,10 +179,8 @@ impl<N: NetworkZone> Service<BroadcastRequest<N>> for BroadcastSvc<N> {
                     "queuing block at chain height {current_blockchain_height} for broadcast"
                 );
 
-                self.new_block_watch.send_replace(NewBlockInfo {
-                    block_bytes,
-                    current_blockchain_height,
-                });
+                self.new_block_watch
+                    .send_replace(NewBlockInfo::new(block_bytes, current_blockchain_height));
             }
             BroadcastRequest::Transaction {
                 tx_bytes,
@@ -229,10 +227,33 @@ impl<T: Clone> Clone for CloneableBroadcastReceiver<T> {
 /// A new block to broadcast.
 #[derive(Clone)]
 struct NewBlockInfo {
-    /// The block.
-    block_bytes: Bytes,
-    /// The current chain height - will be 1 more than the blocks' height.
-    current_blockchain_height: u64,
+    /// The block, encoded as a [`NewFluffyBlock`].
+    ///
+    /// This is encoded once here, cloning the bucket for each peer only clones the [`Bytes`] body.
+    bucket: Bucket<LevinCommand>,
+}
+
+impl NewBlockInfo {
+    /// Encode a new block to broadcast.
+    ///
+    /// `current_blockchain_height` will be 1 more than the blocks' height.
+    fn new(block_bytes: Bytes, current_blockchain_height: u64) -> Self {
+        let block_mes = NewFluffyBlock {
+            b: BlockCompleteEntry {
+                pruned: false,
+                block: block_bytes,
+                // This is a full fluffy block these values do not need to be set.
+                block_weight: 0,
+                txs: TransactionBlobs::None,
+            },
+            current_blockchain_height,
+        };
+
+        Self {
+            bucket: BroadcastMessage::encode_fluffy_block(block_mes)
+                .expect("A fluffy block with no transactions can always be encoded"),
+        }
+    }
 }
 
 /// A new transaction to broadcast.
@@ -300,18 +321,7 @@ impl<N: NetworkZone> Stream for BroadcastMessageStream<N> {
                 return Poll::Ready(None);
             };
 
-            let block_mes = NewFluffyBlock {
-                b: BlockCompleteEntry {
-                    pruned: false,
-                    block: block.block_bytes,
-                    // This is a full fluffy block these values do not need to be set.
-                    block_weight: 0,
-                    txs: TransactionBlobs::None,
-                },
-                current_blockchain_height: block.current_blockchain_height,
-            };
-
-            return Poll::Ready(Some(BroadcastMessage::NewFluffyBlock(block_mes)));
+            return Poll::Ready(Some(BroadcastMessage::NewFluffyBlock(block.bucket)));
         }
 
         ready!(this.next_flush.as_mut().poll(cx));
@@ -490,11 +500,17 @@ mod tests {
             .await
             .unwrap();
 
-        let next = outbound_stream.next().await.unwrap();
-        assert!(matches!(next, BroadcastMessage::NewFluffyBlock(_)));
+        let BroadcastMessage::NewFluffyBlock(outbound) = outbound_stream.next().await.unwrap()
+        else {
+            panic!("Expected a block broadcast");
+        };
 
-        let next = inbound_stream.next().await.unwrap();
-        assert!(matches!(next, BroadcastMessage::NewFluffyBlock(_)));
+        let BroadcastMessage::NewFluffyBlock(inbound) = inbound_stream.next().await.unwrap() else {
+            panic!("Expected a block broadcast");
+        };
+
+        // The block is only encoded once.
+        assert_eq!(outbound.body.as_ptr(), inbound.body.as_ptr());
     }
 
     #[tokio::test]
@@ -43,6 +43,12 @@ pub(crate) const INBOUND_CONNECTION_COOL_DOWN: Duration = Duration::from_millis(
 /// The initial amount of chain requests to send to find the best chain to sync from.
 pub(crate) const INITIAL_CHAIN_REQUESTS_TO_SEND: usize = 3;
 
+/// The minimum amount of time to wait for more chain responses, after the first, when finding the best chain
+/// to sync from.
+///
+/// After the first response we wait for as long as it took, or this, whichever is longer.
+pub(crate) const INITIAL_CHAIN_SEARCH_MIN_WAIT: Duration = Duration::from_secs(1);
+
 /// The enforced maximum amount of blocks to request in a batch.
 ///
 /// Requesting more than this will cause the peer to disconnect and potentially lead to bans.
@@ -69,6 +75,34 @@ pub(crate) const MAX_DOWNLOAD_FAILURES: usize = 5;
 /// The amount of empty chain entries to receive before we assume we have found the top of the chain.
 pub(crate) const EMPTY_CHAIN_ENTRIES_BEFORE_TOP_ASSUMED: usize = 5;
 
+/// The weight given to the newest batch when updating a peer's throughput estimate in the block downloader.
+pub(crate) const PEER_THROUGHPUT_EWMA_WEIGHT: f64 = 0.25;
+
+/// A peer with a throughput below this fraction of the median peer's throughput is considered slow by the
+/// block downloader.
+///
+/// Slow peers are not given batches that other batches are waiting on.
+pub(crate) const SLOW_PEER_THROUGHPUT_FRACTION: f64 = 0.5;
+
+/// The smallest fraction of the normal batch length the block downloader will give a slow peer.
+pub(crate) const SLOW_PEER_MIN_BATCH_FRACTION: f64 = 0.1;
+
+/// The block downloader will not send hedged requests to peers with a throughput below this percentile of all
+/// peers.
+pub(crate) const HEDGE_THROUGHPUT_PERCENTILE: f64 = 0.25;
+
+/// The block downloader will send a hedged request for the oldest inflight batch if it has been inflight for this
+/// long, even if the peer it was requested from is expected to take longer.
+///
+/// This is also used when we have no throughput estimate for the peer.
+#[cfg(not(test))]
+pub(crate) const HEDGE_REQUEST_AFTER: Duration = Duration::from_secs(10);
+
+/// [`HEDGE_REQUEST_AFTER`] for tests, shortened so the tests relying on hedged requests do not
+/// have to wait for the real value.
+#[cfg(test)]
+pub(crate) const HEDGE_REQUEST_AFTER: Duration = Duration::from_secs(1);
+
 #[cfg(test)]
 mod tests {
     use super::*;
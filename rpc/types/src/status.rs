@@ -149,6 +149,10 @@ impl EpeeValue for Status {
         Some(Self::Unknown)
     }
 
+    fn epee_size(&self) -> usize {
+        cuprate_epee_encoding::bytes_size(self.as_ref())
+    }
+
     fn write<B: BufMut>(self, w: &mut B) -> cuprate_epee_encoding::Result<()> {
         cuprate_epee_encoding::write_bytes(self.as_ref(), w)
     }
@@ -0,0 +1,455 @@
+//! `cuprate-blockchain` storage benchmarks.
+//!
+//! This runs the same workloads through the `cuprate_database`
+//! traits on whichever backend `cuprate-blockchain` is compiled with,
+//! so comparing backends is done by running this twice:
+//!
+//! ```bash
+//! # `heed` (LMDB).
+//! cargo bench -p cuprate-blockchain --bench storage
+//!
+//! # `redb`.
+//! cargo bench -p cuprate-blockchain --bench storage --no-default-features --features redb
+//! ```
+//!
+//! Each workload is ran once per [`SyncMode`] on a fresh database
+//! filled with synthetic blocks, and reports its throughput
+//! (operations/second) and 99th percentile latency.
+//!
+//! Setting `CUPRATE_BENCH_DB_DIR` to the directory of an existing
+//! database will also replay the read-only workloads against it,
+//! e.g. a database synced by `cuprated`.
+//!
+//! The read workloads also compare the serial and parallel paths
+//! of the service's reader thread-pool at different request sizes,
+//! which is what `PARALLEL_THRESHOLD` in `src/service/read.rs` is set from.
+
+//---------------------------------------------------------------------------------------------------- Import
+use std::{
+    borrow::Cow,
+    hint::black_box,
+    path::PathBuf,
+    time::{Duration, Instant},
+};
+
+use monero_serai::transaction::Input;
+use rand::{rngs::StdRng, Rng, SeedableRng};
+use rayon::iter::{IntoParallelRefIterator, ParallelIterator};
+use thread_local::ThreadLocal;
+
+use cuprate_blockchain::{
+    config::ConfigBuilder,
+    cuprate_database::{
+        config::SyncMode, ConcreteEnv, DatabaseIter, DatabaseRo, DatabaseRw, Env, EnvInner,
+        RuntimeError, Table, TxRw, DATABASE_BACKEND,
+    },
+    ops::block::{add_block, pop_block},
+    tables::{KeyImages, Outputs, Tables, TablesIter, TablesMut},
+    types::{KeyImage, Output, OutputFlags, PreRctOutputId},
+    OpenTables,
+};
+use cuprate_test_utils::data::block_v16_tx0;
+use cuprate_types::VerifiedBlockInformation;
+
+//---------------------------------------------------------------------------------------------------- Constants
+/// Amount of blocks added (and then popped) per [`SyncMode`].
+const BLOCKS: u64 = 1_024;
+
+/// Amount of blocks written per transaction in the grouped `add_block` workload.
+///
+/// This matches the writer thread's group commit limit.
+const BLOCKS_PER_GROUP: u64 = 64;
+
+/// Amount of outputs in each synthetic block's miner transaction.
+const OUTPUTS_PER_BLOCK: usize = 16;
+
+/// Amount of pre-RCT outputs and key images written directly into their tables.
+const ENTRIES: u64 = 100_000;
+
+/// Amount of distinct pre-RCT amounts the [`ENTRIES`] are spread over.
+const AMOUNTS: u64 = 16;
+
+/// Amount of operations done per read workload.
+const READS: usize = 100_000;
+
+/// Amount of keys sampled from an existing database for the read workloads.
+const SAMPLES: usize = 100_000;
+
+/// Amount of values read per range iteration.
+const RANGE_LEN: u64 = 256;
+
+/// The request sizes (amount of keys) the serial
+/// and parallel read paths are compared at.
+const REQUEST_SIZES: [usize; 9] = [1, 8, 16, 32, 48, 64, 128, 256, 1_024];
+
+/// The [`SyncMode`]s benchmarked.
+///
+/// [`SyncMode::FastThenSafe`] and [`SyncMode::Threshold`] are not implemented yet.
+const SYNC_MODES: [SyncMode; 3] = [SyncMode::Safe, SyncMode::Async, SyncMode::Fast];
+
+//---------------------------------------------------------------------------------------------------- Main
+fn main() {
+    println!("backend: {DATABASE_BACKEND}");
+
+    for sync_mode in SYNC_MODES {
+        println!("\nsync_mode: {sync_mode:?}");
+
+        let tmp_dir = tempfile::tempdir().unwrap();
+        let env = open(tmp_dir.path().into(), sync_mode);
+
+        populate(&env);
+        bench_add_block(&env);
+        bench_reads(&env);
+        bench_parallel_reads(&env);
+        bench_pop_block(&env);
+    }
+
+    if let Some(db_dir) = std::env::var_os("CUPRATE_BENCH_DB_DIR") {
+        let db_dir = PathBuf::from(db_dir);
+        println!("\nreplay: {}", db_dir.display());
+
+        let env = open(db_dir, SyncMode::default());
+        bench_reads(&env);
+        bench_parallel_reads(&env);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------- Write
+/// Evaluate `$body` with `$tables` bound to `&mut impl TablesMut`
+/// within a single write transaction and commit it.
+///
+/// If the backend needs a resize, the transaction
+/// is aborted, the map resized, and `$body` retried.
+///
+/// This is a macro as `open_tables_mut()` returns
+/// an unnameable type that a closure cannot accept.
+macro_rules! write_tx {
+    ($env:expr, |$tables:ident| $body:expr) => {{
+        let env: &ConcreteEnv = $env;
+        loop {
+            let result = {
+                let env_inner = env.env_inner();
+                let tx_rw = env_inner.tx_rw().unwrap();
+                let mut tables = env_inner.open_tables_mut(&tx_rw).unwrap();
+                let result: Result<(), RuntimeError> = (|| {
+                    let $tables = &mut tables;
+                    $body
+                })();
+                drop(tables);
+                match result {
+                    Ok(()) => TxRw::commit(tx_rw),
+                    Err(e) => {
+                        TxRw::abort(tx_rw).unwrap();
+                        Err(e)
+                    }
+                }
+            };
+
+            match result {
+                Ok(()) => break,
+                Err(RuntimeError::ResizeNeeded) => {
+                    env.resize_map(None);
+                }
+                Err(e) => panic!("{e:?}"),
+            }
+        }
+    }};
+}
+
+//---------------------------------------------------------------------------------------------------- Workloads
+/// Write [`ENTRIES`] pre-RCT outputs and key images directly into their tables.
+fn populate(env: &ConcreteEnv) {
+    write_tx!(env, |tables| {
+        let output = Output {
+            key: [1; 32],
+            height: 0,
+            output_flags: OutputFlags::empty(),
+            tx_idx: 0,
+        };
+
+        for i in 0..ENTRIES {
+            let pre_rct_output_id = PreRctOutputId {
+                amount: i % AMOUNTS + 1,
+                amount_index: i / AMOUNTS,
+            };
+            tables.outputs_mut().put(&pre_rct_output_id, &output)?;
+            tables.key_images_mut().put(&key_image(i), &())?;
+        }
+
+        Ok(())
+    });
+}
+
+/// Add [`BLOCKS`] blocks one transaction per block,
+/// then [`BLOCKS`] more [`BLOCKS_PER_GROUP`] blocks per transaction.
+fn bench_add_block(env: &ConcreteEnv) {
+    let blocks = (0..BLOCKS * 2).map(synthetic_block).collect::<Vec<_>>();
+    let (single, grouped) = blocks.split_at(BLOCKS as usize);
+
+    measure("add_block", single.len(), 1, |i| {
+        write_tx!(env, |tables| add_block(&single[i], tables));
+    });
+
+    let groups = grouped
+        .chunks(BLOCKS_PER_GROUP as usize)
+        .collect::<Vec<_>>();
+    measure(
+        "add_block (grouped)",
+        groups.len(),
+        BLOCKS_PER_GROUP as usize,
+        |i| {
+            write_tx!(env, |tables| {
+                groups[i]
+                    .iter()
+                    .try_for_each(|block| add_block(block, tables))
+            });
+        },
+    );
+}
+
+/// Pop all blocks one transaction per block.
+fn bench_pop_block(env: &ConcreteEnv) {
+    let env_inner = env.env_inner();
+    let tx_ro = env_inner.tx_ro().unwrap();
+    let tables = env_inner.open_tables(&tx_ro).unwrap();
+    let blocks = tables.block_infos().len().unwrap();
+    drop(tables);
+    drop(tx_ro);
+    drop(env_inner);
+
+    measure("pop_block", blocks as usize, 1, |_| {
+        write_tx!(env, |tables| pop_block(tables).map(drop));
+    });
+}
+
+/// Random reads, range iteration and key image probes.
+///
+/// The keys read are sampled from the database itself
+/// so this also works on an existing database.
+fn bench_reads(env: &ConcreteEnv) {
+    let env_inner = env.env_inner();
+    let tx_ro = env_inner.tx_ro().unwrap();
+    let tables = env_inner.open_tables(&tx_ro).unwrap();
+    let mut rng = StdRng::seed_from_u64(0x5EED);
+
+    let pre_rct_output_ids = sample_keys(tables.outputs_iter());
+    if !pre_rct_output_ids.is_empty() {
+        measure("get Outputs", READS, 1, |_| {
+            let id = &pre_rct_output_ids[rng.gen_range(0..pre_rct_output_ids.len())];
+            black_box(tables.outputs().get(id).unwrap());
+        });
+    }
+
+    let rct_outputs = tables.rct_outputs().len().unwrap();
+    if rct_outputs != 0 {
+        measure("get RctOutputs", READS, 1, |_| {
+            let amount_index = rng.gen_range(0..rct_outputs);
+            black_box(tables.rct_outputs().get(&amount_index).unwrap());
+        });
+    }
+
+    if rct_outputs >= RANGE_LEN {
+        let iterations = READS / RANGE_LEN as usize;
+        measure("range RctOutputs", iterations, RANGE_LEN as usize, |_| {
+            let start = rng.gen_range(0..=rct_outputs - RANGE_LEN);
+            for rct_output in tables
+                .rct_outputs_iter()
+                .get_range(start..start + RANGE_LEN)
+                .unwrap()
+            {
+                black_box(rct_output.unwrap());
+            }
+        });
+    }
+
+    // Half of the probes are for key images that exist,
+    // the other half are for (likely) non-existent ones.
+    let key_images = sample_keys(tables.key_images_iter());
+    if !key_images.is_empty() {
+        measure("contains KeyImages", READS, 1, |i| {
+            let key_image = if i % 2 == 0 {
+                key_images[rng.gen_range(0..key_images.len())]
+            } else {
+                key_image(rng.gen::<u64>() | (1 << 63))
+            };
+            black_box(tables.key_images().contains(&key_image).unwrap());
+        });
+    }
+}
+
+/// Key image and output lookups of [`REQUEST_SIZES`] keys per request,
+/// handled serially with 1 read transaction, or in parallel with 1 read
+/// transaction per `rayon` thread, the same way the service's reader
+/// thread-pool handles `KeyImagesSpent` and `Outputs` requests.
+///
+/// The service uses the parallel path from `PARALLEL_THRESHOLD` keys onwards,
+/// this should be the smallest size the parallel path wins at on all backends.
+fn bench_parallel_reads(env: &ConcreteEnv) {
+    let env_inner = env.env_inner();
+
+    // Requests are handled from within the pool, like the service's reader threads.
+    let pool = rayon::ThreadPoolBuilder::new().build().unwrap();
+
+    // Key images that are (likely) not in the database, such that each one is checked.
+    let max_size = REQUEST_SIZES[REQUEST_SIZES.len() - 1] as u64;
+    let key_images = (0..max_size)
+        .map(|i| key_image(i | (1 << 63)))
+        .collect::<Vec<KeyImage>>();
+
+    let pre_rct_output_ids = {
+        let tx_ro = env_inner.tx_ro().unwrap();
+        let tables = env_inner.open_tables(&tx_ro).unwrap();
+        sample_keys(tables.outputs_iter())
+    };
+
+    for size in REQUEST_SIZES {
+        let iterations = (READS / size).max(100);
+        let key_images = &key_images[..size];
+        let pre_rct_output_ids = pre_rct_output_ids
+            .iter()
+            .cycle()
+            .take(size)
+            .collect::<Vec<&PreRctOutputId>>();
+
+        pool.install(|| {
+            measure(
+                &format!("KeyImages serial {size}"),
+                iterations,
+                size,
+                |_| {
+                    let tx_ro = env_inner.tx_ro().unwrap();
+                    let table = env_inner.open_db_ro::<KeyImages>(&tx_ro).unwrap();
+                    for key_image in key_images {
+                        black_box(table.contains(key_image).unwrap());
+                    }
+                },
+            );
+
+            measure(
+                &format!("KeyImages parallel {size}"),
+                iterations,
+                size,
+                |_| {
+                    let tx_ro = ThreadLocal::new();
+                    let tables = ThreadLocal::new();
+                    key_images.par_iter().for_each(|key_image| {
+                        let tx_ro = tx_ro.get_or(|| env_inner.tx_ro().unwrap());
+                        let ThreadTables(tables) =
+                            tables.get_or(|| ThreadTables(env_inner.open_tables(tx_ro).unwrap()));
+                        black_box(tables.key_images().contains(key_image).unwrap());
+                    });
+                },
+            );
+
+            if pre_rct_output_ids.is_empty() {
+                return;
+            }
+
+            measure(&format!("Outputs serial {size}"), iterations, size, |_| {
+                let tx_ro = env_inner.tx_ro().unwrap();
+                let table = env_inner.open_db_ro::<Outputs>(&tx_ro).unwrap();
+                for id in &pre_rct_output_ids {
+                    black_box(table.get(id).unwrap());
+                }
+            });
+
+            measure(
+                &format!("Outputs parallel {size}"),
+                iterations,
+                size,
+                |_| {
+                    let tx_ro = ThreadLocal::new();
+                    let tables = ThreadLocal::new();
+                    pre_rct_output_ids.par_iter().for_each(|id| {
+                        let tx_ro = tx_ro.get_or(|| env_inner.tx_ro().unwrap());
+                        let ThreadTables(tables) =
+                            tables.get_or(|| ThreadTables(env_inner.open_tables(tx_ro).unwrap()));
+                        black_box(tables.outputs().get(id).unwrap());
+                    });
+                },
+            );
+        });
+    }
+}
+
+//---------------------------------------------------------------------------------------------------- ThreadTables
+/// Tables that are only ever used by the `rayon` thread that opened them.
+///
+/// This is the bench's version of the service's `UnsafeSendable`,
+/// `heed`'s tables are not [`Send`], but are only accessed through
+/// a [`ThreadLocal`], so no other thread ever touches them.
+struct ThreadTables<T>(T);
+
+// SAFETY: see above, each value is only accessed by 1 thread.
+unsafe impl<T> Send for ThreadTables<T> {}
+
+//---------------------------------------------------------------------------------------------------- Free functions
+/// Open a database environment at `db_dir` with `sync_mode`.
+fn open(db_dir: PathBuf, sync_mode: SyncMode) -> ConcreteEnv {
+    let config = ConfigBuilder::new()
+        .db_directory(Cow::Owned(db_dir))
+        .sync_mode(sync_mode)
+        .build();
+
+    cuprate_blockchain::open(config).unwrap()
+}
+
+/// Collect up to [`SAMPLES`] keys of a table.
+fn sample_keys<T: Table>(table: &impl DatabaseIter<T>) -> Vec<T::Key> {
+    table
+        .keys()
+        .unwrap()
+        .take(SAMPLES)
+        .map(Result::unwrap)
+        .collect()
+}
+
+/// Call `f` with `0..iterations` and print the throughput and p99 latency.
+///
+/// Each call to `f` counts as `ops_per_iteration` operations.
+fn measure(name: &str, iterations: usize, ops_per_iteration: usize, mut f: impl FnMut(usize)) {
+    let mut latencies = Vec::with_capacity(iterations);
+
+    let start = Instant::now();
+    for i in 0..iterations {
+        let now = Instant::now();
+        f(i);
+        latencies.push(now.elapsed());
+    }
+    let total = start.elapsed();
+
+    latencies.sort_unstable();
+    let p99 = latencies
+        .get((iterations * 99).div_ceil(100).saturating_sub(1))
+        .copied()
+        .unwrap_or(Duration::ZERO);
+
+    #[allow(clippy::cast_precision_loss)]
+    let ops_per_second = (iterations * ops_per_iteration) as f64 / total.as_secs_f64();
+
+    println!("{name:<24} {ops_per_second:>14.0} ops/s    p99: {p99:>12.3?}");
+}
+
+/// Create a unique synthetic block at `height`.
+///
+/// This is [`block_v16_tx0`] with the miner transaction's input
+/// set to `height` (making the block and transaction hash unique)
+/// and its output repeated [`OUTPUTS_PER_BLOCK`] times.
+fn synthetic_block(height: u64) -> VerifiedBlockInformation {
+    let mut block = block_v16_tx0().clone();
+
+    let miner_tx = &mut block.block.miner_tx;
+    miner_tx.prefix.inputs = vec![Input::Gen(height)];
+    miner_tx.prefix.outputs = vec![miner_tx.prefix.outputs[0].clone(); OUTPUTS_PER_BLOCK];
+
+    block.block_blob = block.block.serialize();
+    block.block_hash = block.block.hash();
+    block.height = height;
+
+    block
+}
+
+/// Deterministically map `i` to a pseudo-random [`KeyImage`].
+fn key_image(i: u64) -> KeyImage {
+    StdRng::seed_from_u64(i).gen()
+}
@@ -15,12 +15,55 @@ use crate::{
         blockchain::{chain_height, cumulative_generated_coins},
         macros::doc_error,
         output::get_rct_num_outputs,
-        tx::{add_tx, remove_tx},
+        tx::{add_prepared_tx, remove_tx, PreparedTx},
     },
     tables::{BlockHeights, BlockInfos, Tables, TablesMut},
-    types::{BlockHash, BlockHeight, BlockInfo},
+    types::{BlockHash, BlockHeight, BlockInfo, TxHash},
 };
 
+//---------------------------------------------------------------------------------------------------- `PreparedBlock`
+/// The CPU-bound work of [`add_block`], done ahead of time.
+///
+/// This holds a [`PreparedTx`] for the miner transaction
+/// and each transaction in the block, so that [`add_prepared_block`]
+/// only has to read/write tables.
+///
+/// The [`PreparedTx`]'s do not depend on each other or the
+/// database, so they can be created in parallel, see [`PreparedBlock::with_txs`].
+#[derive(Clone, Debug, PartialEq, Eq)]
+pub struct PreparedBlock {
+    /// The serialized miner transaction.
+    pub miner_tx_blob: Vec<u8>,
+    /// The miner transaction's hash.
+    pub miner_tx_hash: TxHash,
+    /// The prepared miner transaction.
+    pub miner_tx: PreparedTx,
+    /// The prepared transactions, in the same order as [`VerifiedBlockInformation::txs`].
+    pub txs: Vec<PreparedTx>,
+}
+
+impl PreparedBlock {
+    /// Prepare all transactions in `block` serially.
+    pub fn new(block: &VerifiedBlockInformation) -> Self {
+        let txs = block.txs.iter().map(|tx| PreparedTx::new(&tx.tx)).collect();
+        Self::with_txs(block, txs)
+    }
+
+    /// Create a [`PreparedBlock`] using already prepared `txs`.
+    ///
+    /// `txs` must be created from [`VerifiedBlockInformation::txs`], in order.
+    pub fn with_txs(block: &VerifiedBlockInformation, txs: Vec<PreparedTx>) -> Self {
+        let miner_tx = &block.block.miner_tx;
+
+        Self {
+            miner_tx_blob: miner_tx.serialize(),
+            miner_tx_hash: miner_tx.hash(),
+            miner_tx: PreparedTx::new(miner_tx),
+            txs,
+        }
+    }
+}
+
 //---------------------------------------------------------------------------------------------------- `add_block_*`
 /// Add a [`VerifiedBlockInformation`] to the database.
 ///
@@ -42,6 +85,28 @@ use crate::{
 pub fn add_block(
     block: &VerifiedBlockInformation,
     tables: &mut impl TablesMut,
+) -> Result<(), RuntimeError> {
+    add_prepared_block(block, &PreparedBlock::new(block), tables)
+}
+
+/// Add a [`VerifiedBlockInformation`] to the database, using its [`PreparedBlock`].
+///
+/// This is the same as [`add_block`], except the CPU-bound work
+/// was already done in [`PreparedBlock`], so this function only
+/// reads/writes tables.
+///
+#[doc = doc_error!()]
+///
+/// # Panics
+/// This function will panic if:
+/// - `block.height > u32::MAX` (not normally possible)
+/// - `block.height` is not != [`chain_height`]
+/// - `prepared` does not contain the same amount of transactions as `block`
+// no inline, too big.
+pub fn add_prepared_block(
+    block: &VerifiedBlockInformation,
+    prepared: &PreparedBlock,
+    tables: &mut impl TablesMut,
 ) -> Result<(), RuntimeError> {
     //------------------------------------------------------ Check preconditions first
 
@@ -61,6 +126,12 @@ pub fn add_block(
         block.height, chain_height,
     );
 
+    assert_eq!(
+        prepared.txs.len(),
+        block.txs.len(),
+        "prepared.txs.len() != block.txs.len()",
+    );
+
     // Expensive checks - debug only.
     #[cfg(debug_assertions)]
     {
@@ -74,13 +145,16 @@ pub fn add_block(
 
     //------------------------------------------------------ Transaction / Outputs / Key Images
     // Add the miner transaction first.
-    {
-        let tx = &block.block.miner_tx;
-        add_tx(tx, &tx.serialize(), &tx.hash(), &chain_height, tables)?;
-    }
+    add_prepared_tx(
+        &prepared.miner_tx,
+        &prepared.miner_tx_blob,
+        &prepared.miner_tx_hash,
+        &chain_height,
+        tables,
+    )?;
 
-    for tx in &block.txs {
-        add_tx(&tx.tx, &tx.tx_blob, &tx.tx_hash, &chain_height, tables)?;
+    for (tx, prepared_tx) in block.txs.iter().zip(&prepared.txs) {
+        add_prepared_tx(prepared_tx, &tx.tx_blob, &tx.tx_hash, &chain_height, tables)?;
     }
 
     //------------------------------------------------------ Block Info
@@ -2,10 +2,10 @@
 
 //---------------------------------------------------------------------------------------------------- Import
 use bytemuck::TransparentWrapper;
-use curve25519_dalek::{constants::ED25519_BASEPOINT_POINT, Scalar};
 use monero_serai::transaction::{Input, Timelock, Transaction};
 
 use cuprate_database::{DatabaseRo, DatabaseRw, RuntimeError, StorableVec};
+use cuprate_helper::crypto::compute_zero_commitment_compressed;
 
 use crate::{
     ops::{
@@ -16,9 +16,112 @@ use crate::{
         },
     },
     tables::{TablesMut, TxBlobs, TxIds},
-    types::{BlockHeight, Output, OutputFlags, PreRctOutputId, RctOutput, TxHash, TxId},
+    types::{
+        Amount, BlockHeight, KeyImage, Output, OutputFlags, PreRctOutputId, RctOutput, TxHash, TxId,
+    },
 };
 
+//---------------------------------------------------------------------------------------------------- PreparedTx
+/// The CPU-bound work of [`add_tx`], done ahead of time.
+///
+/// This is the data derived from a [`Transaction`] that does not depend
+/// on the database (compressed key images, output commitments, etc), so
+/// it can be created in parallel, before a write transaction is opened.
+///
+/// See [`add_prepared_tx`].
+#[derive(Clone, Debug, PartialEq, Eq)]
+pub struct PreparedTx {
+    /// The unlock time of the transaction, [`None`] if it has no timelock.
+    pub unlock_time: Option<u64>,
+    /// The compressed key images of the transaction's inputs.
+    pub key_images: Vec<KeyImage>,
+    /// The transaction's outputs, in order.
+    pub outputs: Vec<PreparedOutput>,
+}
+
+/// An output of a [`PreparedTx`].
+#[derive(Copy, Clone, Debug, PartialEq, Eq)]
+pub enum PreparedOutput {
+    /// A pre-RCT output, added with [`add_output`].
+    PreRct {
+        /// The output's compressed public key.
+        key: [u8; 32],
+        /// The output's amount.
+        amount: Amount,
+    },
+
+    /// An RCT output, added with [`add_rct_output`].
+    Rct {
+        /// The output's compressed public key.
+        key: [u8; 32],
+        /// The output's compressed commitment.
+        commitment: [u8; 32],
+    },
+}
+
+impl PreparedTx {
+    /// Do the CPU-bound work of [`add_tx`] for `tx`.
+    pub fn new(tx: &Transaction) -> Self {
+        let unlock_time = match tx.prefix.timelock {
+            Timelock::None => None,
+            Timelock::Block(height) => Some(height as u64),
+            Timelock::Time(time) => Some(time),
+        };
+
+        // Is this a miner transaction?
+        // Which table we add the output data to depends on this.
+        // <https://github.com/monero-project/monero/blob/eac1b86bb2818ac552457380c9dd421fb8935e5b/src/blockchain_db/blockchain_db.cpp#L212-L216>
+        let mut miner_tx = false;
+
+        let key_images = tx
+            .prefix
+            .inputs
+            .iter()
+            .filter_map(|input| match input {
+                Input::ToKey { key_image, .. } => Some(key_image.compress().to_bytes()),
+                Input::Gen(_) => {
+                    miner_tx = true;
+                    None
+                }
+            })
+            .collect();
+
+        let outputs = tx
+            .prefix
+            .outputs
+            .iter()
+            .enumerate()
+            .map(|(i, output)| {
+                let key = *output.key.as_bytes();
+
+                match output.amount {
+                    // RingCT (v2 transaction) miner outputs.
+                    Some(amount) if miner_tx && tx.prefix.version == 2 => {
+                        // Create commitment.
+                        // <https://github.com/Cuprate/cuprate/pull/102#discussion_r1559489302>
+                        let commitment = compute_zero_commitment_compressed(amount);
+
+                        PreparedOutput::Rct { key, commitment }
+                    }
+                    // Pre-RingCT outputs.
+                    Some(amount) => PreparedOutput::PreRct { key, amount },
+                    // RingCT outputs.
+                    None => PreparedOutput::Rct {
+                        key,
+                        commitment: tx.rct_signatures.base.commitments[i].compress().to_bytes(),
+                    },
+                }
+            })
+            .collect();
+
+        Self {
+            unlock_time,
+            key_images,
+            outputs,
+        }
+    }
+}
+
 //---------------------------------------------------------------------------------------------------- Private
 /// Add a [`Transaction`] (and related data) to the database.
 ///
@@ -52,6 +155,31 @@ pub fn add_tx(
     tx_hash: &TxHash,
     block_height: &BlockHeight,
     tables: &mut impl TablesMut,
+) -> Result<TxId, RuntimeError> {
+    add_prepared_tx(&PreparedTx::new(tx), tx_blob, tx_hash, block_height, tables)
+}
+
+/// Add a [`Transaction`] (and related data) to the database, using its [`PreparedTx`].
+///
+/// This is the same as [`add_tx`], except the CPU-bound
+/// work was already done in [`PreparedTx::new`], so this
+/// function only reads/writes tables.
+///
+/// `prepared` must be created from the transaction in `tx_blob`.
+///
+#[doc = doc_add_block_inner_invariant!()]
+///
+/// # Panics
+/// This function will panic if:
+/// - `block.height > u32::MAX` (not normally possible)
+#[doc = doc_error!()]
+#[inline]
+pub fn add_prepared_tx(
+    prepared: &PreparedTx,
+    tx_blob: &Vec<u8>,
+    tx_hash: &TxHash,
+    block_height: &BlockHeight,
+    tables: &mut impl TablesMut,
 ) -> Result<TxId, RuntimeError> {
     let tx_id = get_num_tx(tables.tx_ids_mut())?;
 
@@ -68,10 +196,8 @@ pub fn add_tx(
     // so the `u64/usize` is stored without any tag.
     //
     // <https://github.com/Cuprate/cuprate/pull/102#discussion_r1558504285>
-    match tx.prefix.timelock {
-        Timelock::None => (),
-        Timelock::Block(height) => tables.tx_unlock_time_mut().put(&tx_id, &(height as u64))?,
-        Timelock::Time(time) => tables.tx_unlock_time_mut().put(&tx_id, &time)?,
+    if let Some(unlock_time) = prepared.unlock_time {
+        tables.tx_unlock_time_mut().put(&tx_id, &unlock_time)?;
     }
 
     //------------------------------------------------------ Pruning
@@ -86,61 +212,24 @@ pub fn add_tx(
     };
 
     //------------------------------------------------------ Key Images
-    // Is this a miner transaction?
-    // Which table we add the output data to depends on this.
-    // <https://github.com/monero-project/monero/blob/eac1b86bb2818ac552457380c9dd421fb8935e5b/src/blockchain_db/blockchain_db.cpp#L212-L216>
-    let mut miner_tx = false;
-
-    // Key images.
-    for inputs in &tx.prefix.inputs {
-        match inputs {
-            // Key images.
-            Input::ToKey { key_image, .. } => {
-                add_key_image(key_image.compress().as_bytes(), tables.key_images_mut())?;
-            }
-            // This is a miner transaction, set it for later use.
-            Input::Gen(_) => miner_tx = true,
-        }
+    for key_image in &prepared.key_images {
+        add_key_image(key_image, tables.key_images_mut())?;
     }
 
     //------------------------------------------------------ Outputs
     // Output bit flags.
     // Set to a non-zero bit value if the unlock time is non-zero.
-    let output_flags = match tx.prefix.timelock {
-        Timelock::None => OutputFlags::empty(),
-        Timelock::Block(_) | Timelock::Time(_) => OutputFlags::NON_ZERO_UNLOCK_TIME,
+    let output_flags = if prepared.unlock_time.is_some() {
+        OutputFlags::NON_ZERO_UNLOCK_TIME
+    } else {
+        OutputFlags::empty()
     };
 
-    let mut amount_indices = Vec::with_capacity(tx.prefix.outputs.len());
-
-    for (i, output) in tx.prefix.outputs.iter().enumerate() {
-        let key = *output.key.as_bytes();
+    let mut amount_indices = Vec::with_capacity(prepared.outputs.len());
 
-        // Outputs with clear amounts.
-        let amount_index = if let Some(amount) = output.amount {
-            // RingCT (v2 transaction) miner outputs.
-            if miner_tx && tx.prefix.version == 2 {
-                // Create commitment.
-                // <https://github.com/Cuprate/cuprate/pull/102#discussion_r1559489302>
-                // FIXME: implement lookup table for common values:
-                // <https://github.com/monero-project/monero/blob/c8214782fb2a769c57382a999eaf099691c836e7/src/ringct/rctOps.cpp#L322>
-                let commitment = (ED25519_BASEPOINT_POINT
-                    + monero_serai::H() * Scalar::from(amount))
-                .compress()
-                .to_bytes();
-
-                add_rct_output(
-                    &RctOutput {
-                        key,
-                        height,
-                        output_flags,
-                        tx_idx: tx_id,
-                        commitment,
-                    },
-                    tables.rct_outputs_mut(),
-                )?
-            // Pre-RingCT outputs.
-            } else {
+    for output in &prepared.outputs {
+        let amount_index = match *output {
+            PreparedOutput::PreRct { key, amount } => {
                 add_output(
                     amount,
                     &Output {
@@ -153,10 +242,7 @@ pub fn add_tx(
                 )?
                 .amount_index
             }
-        // RingCT outputs.
-        } else {
-            let commitment = tx.rct_signatures.base.commitments[i].compress().to_bytes();
-            add_rct_output(
+            PreparedOutput::Rct { key, commitment } => add_rct_output(
                 &RctOutput {
                     key,
                     height,
@@ -165,7 +251,7 @@ pub fn add_tx(
                     commitment,
                 },
                 tables.rct_outputs_mut(),
-            )?
+            )?,
         };
 
         amount_indices.push(amount_index);
@@ -433,4 +519,37 @@ mod test {
 
         assert_all_tables_are_empty(&env);
     }
+
+    /// Tests [`PreparedTx::new`] extracts the same data [`add_tx`] used to.
+    #[test]
+    fn prepared_tx() {
+        for tx in [tx_v1_sig0(), tx_v1_sig2(), tx_v2_rct3()] {
+            let prepared = PreparedTx::new(&tx.tx);
+            let prefix = &tx.tx.prefix;
+
+            assert_eq!(
+                prepared.unlock_time.is_some(),
+                !matches!(prefix.timelock, Timelock::None)
+            );
+            assert_eq!(prepared.key_images.len(), prefix.inputs.len());
+            assert_eq!(prepared.outputs.len(), prefix.outputs.len());
+
+            for (i, (prepared, output)) in prepared.outputs.iter().zip(&prefix.outputs).enumerate()
+            {
+                let expected = match output.amount {
+                    Some(amount) => PreparedOutput::PreRct {
+                        key: *output.key.as_bytes(),
+                        amount,
+                    },
+                    None => PreparedOutput::Rct {
+                        key: *output.key.as_bytes(),
+                        commitment: tx.tx.rct_signatures.base.commitments[i]
+                            .compress()
+                            .to_bytes(),
+                    },
+                };
+                assert_eq!(*prepared, expected);
+            }
+        }
+    }
 }
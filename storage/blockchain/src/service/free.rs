@@ -7,7 +7,7 @@ use cuprate_database::InitError;
 
 use crate::{
     config::Config,
-    service::{DatabaseReadHandle, DatabaseWriteHandle},
+    service::{staging::StagingArea, DatabaseReadHandle, DatabaseWriteHandle},
 };
 
 //---------------------------------------------------------------------------------------------------- Init
@@ -26,9 +26,12 @@ pub fn init(config: Config) -> Result<(DatabaseReadHandle, DatabaseWriteHandle),
     // Initialize the database itself.
     let db = Arc::new(crate::open(config)?);
 
+    // Blocks sent to the writer are visible to readers before they are written.
+    let staging = Arc::new(StagingArea::default());
+
     // Spawn the Reader thread pool and Writer.
-    let readers = DatabaseReadHandle::init(&db, reader_threads);
-    let writer = DatabaseWriteHandle::init(db);
+    let readers = DatabaseReadHandle::init(&db, Arc::clone(&staging), reader_threads);
+    let writer = DatabaseWriteHandle::init(db, staging);
 
     Ok((readers, writer))
 }
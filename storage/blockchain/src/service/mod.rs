@@ -50,6 +50,17 @@
 //! This channel can be `.await`ed upon to (eventually) receive
 //! the corresponding `Response` to your `Request`.
 //!
+//! ## Staging
+//! Blocks sent to the [`DatabaseWriteHandle`] are visible to read requests
+//! immediately, i.e. before the writer has actually written them, so the
+//! response channel of a write does not need to be `.await`ed before reading.
+//!
+//! The amount of blocks sent but not yet written is bounded, the
+//! [`DatabaseWriteHandle`] will not be ready until the writer catches up.
+//!
+//! If a block fails to be written, the writes of all blocks sent after it
+//! also fail, as they were verified against the failed block.
+//!
 //! [req_r]: cuprate_types::blockchain::BCReadRequest
 //!
 //! [req_w]: cuprate_types::blockchain::BCWriteRequest
@@ -127,6 +138,8 @@ pub use write::DatabaseWriteHandle;
 mod free;
 pub use free::init;
 
+mod staging;
+
 // Internal type aliases for `service`.
 mod types;
 
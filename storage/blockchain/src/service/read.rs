@@ -30,8 +30,11 @@ use crate::{
         key_image::key_image_exists,
         output::id_to_output_on_chain,
     },
-    service::types::{ResponseReceiver, ResponseResult, ResponseSender},
-    tables::{BlockHeights, BlockInfos, Tables},
+    service::{
+        staging::{StagingArea, StagingView},
+        types::{ResponseReceiver, ResponseResult, ResponseSender},
+    },
+    tables::{BlockHeights, BlockInfos, KeyImages, NumOutputs, RctOutputs, Tables},
     types::BlockHash,
     types::{Amount, AmountIndex, BlockHeight, KeyImage, PreRctOutputId},
 };
@@ -67,6 +70,11 @@ pub struct DatabaseReadHandle {
 
     /// Access to the database.
     env: Arc<ConcreteEnv>,
+
+    /// Blocks that were sent to the writer, but not yet written.
+    ///
+    /// Requests are handled as if these blocks were already written.
+    staging: Arc<StagingArea>,
 }
 
 // `OwnedSemaphorePermit` does not implement `Clone`,
@@ -79,6 +87,7 @@ impl Clone for DatabaseReadHandle {
             semaphore: self.semaphore.clone(),
             permit: None,
             env: Arc::clone(&self.env),
+            staging: Arc::clone(&self.staging),
         }
     }
 }
@@ -89,10 +98,16 @@ impl DatabaseReadHandle {
     /// This spawns `N` amount of `DatabaseReader`'s
     /// attached to `env` and returns a handle to the pool.
     ///
+    /// Blocks in `staging` are treated as already written.
+    ///
     /// Should be called _once_ per actual database.
     #[cold]
     #[inline(never)] // Only called once.
-    pub(super) fn init(env: &Arc<ConcreteEnv>, reader_threads: ReaderThreads) -> Self {
+    pub(super) fn init(
+        env: &Arc<ConcreteEnv>,
+        staging: Arc<StagingArea>,
+        reader_threads: ReaderThreads,
+    ) -> Self {
         // How many reader threads to spawn?
         let reader_count = reader_threads.as_threads().get();
 
@@ -113,6 +128,7 @@ impl DatabaseReadHandle {
             semaphore,
             permit: None,
             env: Arc::clone(env),
+            staging,
         }
     }
 
@@ -172,10 +188,11 @@ impl tower::Service<BCReadRequest> for DatabaseReadHandle {
         // INVARIANT:
         // The below `DatabaseReader` function impl block relies on this behavior.
         let env = Arc::clone(&self.env);
+        let staging = Arc::clone(&self.staging);
         self.pool.spawn(move || {
             let _permit: OwnedSemaphorePermit = permit;
-            map_request(&env, request, response_sender);
-        }); // drop(permit/env);
+            map_request(&env, &staging, request, response_sender);
+        }); // drop(permit/env/staging);
 
         InfallibleOneshotReceiver::from(receiver)
     }
@@ -194,6 +211,7 @@ impl tower::Service<BCReadRequest> for DatabaseReadHandle {
 /// 3. [`BCResponse`] is sent
 fn map_request(
     env: &ConcreteEnv,               // Access to the database
+    staging: &StagingArea,           // Blocks not yet written
     request: BCReadRequest,          // The request we must fulfill
     response_sender: ResponseSender, // The channel we must send the response back to
 ) {
@@ -202,15 +220,16 @@ fn map_request(
     /* SOMEDAY: pre-request handling, run some code for each request? */
 
     let response = match request {
-        R::BlockExtendedHeader(block) => block_extended_header(env, block),
-        R::BlockHash(block) => block_hash(env, block),
-        R::FilterUnknownHashes(hashes) => filter_unknown_hahses(env, hashes),
-        R::BlockExtendedHeaderInRange(range) => block_extended_header_in_range(env, range),
-        R::ChainHeight => chain_height(env),
-        R::GeneratedCoins => generated_coins(env),
-        R::Outputs(map) => outputs(env, map),
-        R::NumberOutputsWithAmount(vec) => number_outputs_with_amount(env, vec),
-        R::KeyImagesSpent(set) => key_images_spent(env, set),
+        R::BlockExtendedHeader(block) => block_extended_header(env, staging, block),
+        R::BlockHash(block) => block_hash(env, staging, block),
+        R::FilterUnknownHashes(hashes) => filter_unknown_hahses(env, staging, hashes),
+        R::BlockExtendedHeaderInRange(range) => block_extended_header_in_range(env, staging, range),
+        R::ChainHeight => chain_height(env, staging),
+        R::GeneratedCoins => generated_coins(env, staging),
+        R::Outputs(map) => outputs(env, staging, map),
+        R::NumberOutputsWithAmount(vec) => number_outputs_with_amount(env, staging, vec),
+        R::KeyImagesSpent(set) => key_images_spent(env, staging, set),
+        R::Batch(requests) => batch(env, staging, requests),
     };
 
     if let Err(e) = response_sender.send(response) {
@@ -221,6 +240,31 @@ fn map_request(
     /* SOMEDAY: post-request handling, run some code for each request? */
 }
 
+//---------------------------------------------------------------------------------------------------- Parallelism
+/// The minimum amount of items (heights, keys, amounts, etc) a request
+/// must contain before its handler fans out onto the `rayon` thread-pool.
+///
+/// Below this, the overhead of allocating [`ThreadLocal`] transactions/tables,
+/// opening a transaction on every participating thread and `rayon` job scheduling
+/// outweighs the actual database lookups, so the request is handled serially
+/// on the current reader thread with a single read transaction.
+///
+/// Most requests coming from consensus (e.g. checking the key images
+/// of a single transaction) contain only a handful of items.
+///
+/// The `storage` benchmark compares both paths at different request sizes
+/// (`bench_parallel_reads()`), this should be the smallest size where the
+/// parallel path is faster on every backend, re-run it when changing this.
+const PARALLEL_THRESHOLD: usize = 64;
+
+/// Should a request containing `len` items be handled in parallel?
+///
+/// See [`PARALLEL_THRESHOLD`].
+#[inline]
+const fn use_parallel(len: usize) -> bool {
+    len >= PARALLEL_THRESHOLD
+}
+
 //---------------------------------------------------------------------------------------------------- Thread Local
 /// Q: Why does this exist?
 ///
@@ -286,15 +330,33 @@ macro_rules! get_tables {
 // All functions below assume that this is the case, such that
 // `par_*()` functions will not block the _global_ rayon thread-pool.
 
-// FIXME: implement multi-transaction read atomicity.
+// Multi-transaction read atomicity is provided by [`BCReadRequest::Batch`],
+// every other request opens its own transaction(s).
 // <https://github.com/Cuprate/cuprate/pull/113#discussion_r1576874589>.
 
-// TODO: The overhead of parallelism may be too much for every request, perfomace test to find optimal
-// amount of parallelism.
+// Handlers that operate on multiple items only use `rayon` if the request
+// is large enough for the parallelism to pay off, see [`use_parallel()`].
+
+// Each handler first takes the [`StagingView`] (if any blocks are staged),
+// staged data is identical to what will be written, so it can be mixed with
+// data read from any database snapshot taken after the view was created.
+//
+// INVARIANT: the view must be taken _before_ any transaction is opened.
 
 /// [`BCReadRequest::BlockExtendedHeader`].
 #[inline]
-fn block_extended_header(env: &ConcreteEnv, block_height: BlockHeight) -> ResponseResult {
+fn block_extended_header(
+    env: &ConcreteEnv,
+    staging: &StagingArea,
+    block_height: BlockHeight,
+) -> ResponseResult {
+    if let Some(header) = staging
+        .view()
+        .and_then(|view| view.block_extended_header(block_height))
+    {
+        return Ok(BCResponse::BlockExtendedHeader(header));
+    }
+
     // Single-threaded, no `ThreadLocal` required.
     let env_inner = env.env_inner();
     let tx_ro = env_inner.tx_ro()?;
@@ -307,7 +369,18 @@ fn block_extended_header(env: &ConcreteEnv, block_height: BlockHeight) -> Respon
 
 /// [`BCReadRequest::BlockHash`].
 #[inline]
-fn block_hash(env: &ConcreteEnv, block_height: BlockHeight) -> ResponseResult {
+fn block_hash(
+    env: &ConcreteEnv,
+    staging: &StagingArea,
+    block_height: BlockHeight,
+) -> ResponseResult {
+    if let Some(block_hash) = staging
+        .view()
+        .and_then(|view| view.block_hash(block_height))
+    {
+        return Ok(BCResponse::BlockHash(block_hash));
+    }
+
     // Single-threaded, no `ThreadLocal` required.
     let env_inner = env.env_inner();
     let tx_ro = env_inner.tx_ro()?;
@@ -320,45 +393,53 @@ fn block_hash(env: &ConcreteEnv, block_height: BlockHeight) -> ResponseResult {
 
 /// [`BCReadRequest::FilterUnknownHashes`].
 #[inline]
-fn filter_unknown_hahses(env: &ConcreteEnv, mut hashes: HashSet<BlockHash>) -> ResponseResult {
+fn filter_unknown_hahses(
+    env: &ConcreteEnv,
+    staging: &StagingArea,
+    hashes: HashSet<BlockHash>,
+) -> ResponseResult {
+    let view = staging.view();
+
     // Single-threaded, no `ThreadLocal` required.
     let env_inner = env.env_inner();
     let tx_ro = env_inner.tx_ro()?;
-
     let table_block_heights = env_inner.open_db_ro::<BlockHeights>(&tx_ro)?;
 
-    let mut err = None;
-
-    hashes.retain(
-        |block_hash| match block_exists(block_hash, &table_block_heights) {
-            Ok(exists) => exists,
-            Err(e) => {
-                err.get_or_insert(e);
-                false
-            }
-        },
-    );
-
-    if let Some(e) = err {
-        Err(e)
-    } else {
-        Ok(BCResponse::FilterUnknownHashes(hashes))
-    }
+    filter_unknown_hashes_serial(hashes, &table_block_heights, view.as_deref())
 }
 
 /// [`BCReadRequest::BlockExtendedHeaderInRange`].
 #[inline]
 fn block_extended_header_in_range(
     env: &ConcreteEnv,
+    staging: &StagingArea,
     range: std::ops::Range<BlockHeight>,
 ) -> ResponseResult {
-    // Prepare tx/tables in `ThreadLocal`.
+    // Split off the staged headers, they are appended after the database's.
+    let (range, staged) = match staging.view() {
+        Some(view) => view.block_extended_header_in_range(range)?,
+        None => (range, Vec::new()),
+    };
+
     let env_inner = env.env_inner();
+
+    // INVARIANT: #[cfg] @ lib.rs asserts `usize == u64`
+    #[allow(clippy::cast_possible_truncation)]
+    let len = range.end.saturating_sub(range.start) as usize;
+
+    // Small request, use a single transaction on this thread.
+    if !use_parallel(len) {
+        let tx_ro = env_inner.tx_ro()?;
+        let tables = env_inner.open_tables(&tx_ro)?;
+        return block_extended_header_in_range_serial(range, &tables, staged);
+    }
+
+    // Prepare tx/tables in `ThreadLocal`.
     let tx_ro = thread_local(env);
     let tables = thread_local(env);
 
     // Collect results using `rayon`.
-    let vec = range
+    let mut vec = range
         .into_par_iter()
         .map(|block_height| {
             let tx_ro = tx_ro.get_or_try(|| env_inner.tx_ro())?;
@@ -367,47 +448,67 @@ fn block_extended_header_in_range(
         })
         .collect::<Result<Vec<ExtendedBlockHeader>, RuntimeError>>()?;
 
+    vec.extend(staged);
+
     Ok(BCResponse::BlockExtendedHeaderInRange(vec))
 }
 
 /// [`BCReadRequest::ChainHeight`].
 #[inline]
-fn chain_height(env: &ConcreteEnv) -> ResponseResult {
+fn chain_height(env: &ConcreteEnv, staging: &StagingArea) -> ResponseResult {
+    if let Some(view) = staging.view() {
+        let (chain_height, block_hash) = view.chain_height();
+        return Ok(BCResponse::ChainHeight(chain_height, block_hash));
+    }
+
     // Single-threaded, no `ThreadLocal` required.
     let env_inner = env.env_inner();
     let tx_ro = env_inner.tx_ro()?;
     let table_block_heights = env_inner.open_db_ro::<BlockHeights>(&tx_ro)?;
     let table_block_infos = env_inner.open_db_ro::<BlockInfos>(&tx_ro)?;
 
-    let chain_height = crate::ops::blockchain::chain_height(&table_block_heights)?;
-    let block_hash =
-        get_block_info(&chain_height.saturating_sub(1), &table_block_infos)?.block_hash;
-
-    Ok(BCResponse::ChainHeight(chain_height, block_hash))
+    chain_height_serial(&table_block_heights, &table_block_infos)
 }
 
 /// [`BCReadRequest::GeneratedCoins`].
 #[inline]
-fn generated_coins(env: &ConcreteEnv) -> ResponseResult {
+fn generated_coins(env: &ConcreteEnv, staging: &StagingArea) -> ResponseResult {
+    if let Some(view) = staging.view() {
+        return Ok(BCResponse::GeneratedCoins(view.generated_coins()));
+    }
+
     // Single-threaded, no `ThreadLocal` required.
     let env_inner = env.env_inner();
     let tx_ro = env_inner.tx_ro()?;
     let table_block_heights = env_inner.open_db_ro::<BlockHeights>(&tx_ro)?;
     let table_block_infos = env_inner.open_db_ro::<BlockInfos>(&tx_ro)?;
 
-    let top_height = top_block_height(&table_block_heights)?;
-
-    Ok(BCResponse::GeneratedCoins(cumulative_generated_coins(
-        &top_height,
-        &table_block_infos,
-    )?))
+    generated_coins_serial(&table_block_heights, &table_block_infos)
 }
 
 /// [`BCReadRequest::Outputs`].
 #[inline]
-fn outputs(env: &ConcreteEnv, outputs: HashMap<Amount, HashSet<AmountIndex>>) -> ResponseResult {
-    // Prepare tx/tables in `ThreadLocal`.
+fn outputs(
+    env: &ConcreteEnv,
+    staging: &StagingArea,
+    mut outputs: HashMap<Amount, HashSet<AmountIndex>>,
+) -> ResponseResult {
+    // Take the staged outputs out of the request, the rest are read from the database.
+    let staged = match staging.view() {
+        Some(view) => view.take_outputs(&mut outputs),
+        None => HashMap::new(),
+    };
+
     let env_inner = env.env_inner();
+
+    // Small request, use a single transaction on this thread.
+    if !use_parallel(outputs.values().map(HashSet::len).sum()) {
+        let tx_ro = env_inner.tx_ro()?;
+        let tables = env_inner.open_tables(&tx_ro)?;
+        return outputs_serial(outputs, &tables, staged);
+    }
+
+    // Prepare tx/tables in `ThreadLocal`.
     let tx_ro = thread_local(env);
     let tables = thread_local(env);
 
@@ -441,14 +542,34 @@ fn outputs(env: &ConcreteEnv, outputs: HashMap<Amount, HashSet<AmountIndex>>) ->
         })
         .collect::<Result<HashMap<Amount, HashMap<AmountIndex, OutputOnChain>>, RuntimeError>>()?;
 
-    Ok(BCResponse::Outputs(map))
+    Ok(BCResponse::Outputs(merge_outputs(map, staged)))
 }
 
 /// [`BCReadRequest::NumberOutputsWithAmount`].
 #[inline]
-fn number_outputs_with_amount(env: &ConcreteEnv, amounts: Vec<Amount>) -> ResponseResult {
-    // Prepare tx/tables in `ThreadLocal`.
+fn number_outputs_with_amount(
+    env: &ConcreteEnv,
+    staging: &StagingArea,
+    amounts: Vec<Amount>,
+) -> ResponseResult {
+    let view = staging.view();
+
     let env_inner = env.env_inner();
+
+    // Small request, use a single transaction on this thread.
+    if !use_parallel(amounts.len()) {
+        let tx_ro = env_inner.tx_ro()?;
+        let table_num_outputs = env_inner.open_db_ro::<NumOutputs>(&tx_ro)?;
+        let table_rct_outputs = env_inner.open_db_ro::<RctOutputs>(&tx_ro)?;
+        return number_outputs_with_amount_serial(
+            amounts,
+            &table_num_outputs,
+            &table_rct_outputs,
+            view.as_deref(),
+        );
+    }
+
+    // Prepare tx/tables in `ThreadLocal`.
     let tx_ro = thread_local(env);
     let tables = thread_local(env);
 
@@ -465,6 +586,17 @@ fn number_outputs_with_amount(env: &ConcreteEnv, amounts: Vec<Amount>) -> Respon
     let map = amounts
         .into_par_iter()
         .map(|amount| {
+            // INVARIANT: #[cfg] @ lib.rs asserts `usize == u64`
+            #[allow(clippy::cast_possible_truncation)]
+            let staged_count = view
+                .as_ref()
+                .and_then(|view| view.number_outputs_with_amount(amount))
+                .map(|count| count as usize);
+
+            if let Some(count) = staged_count {
+                return Ok((amount, count));
+            }
+
             let tx_ro = tx_ro.get_or_try(|| env_inner.tx_ro())?;
             let tables = get_tables!(env_inner, tx_ro, tables)?.as_ref();
 
@@ -491,9 +623,30 @@ fn number_outputs_with_amount(env: &ConcreteEnv, amounts: Vec<Amount>) -> Respon
 
 /// [`BCReadRequest::KeyImagesSpent`].
 #[inline]
-fn key_images_spent(env: &ConcreteEnv, key_images: HashSet<KeyImage>) -> ResponseResult {
-    // Prepare tx/tables in `ThreadLocal`.
+fn key_images_spent(
+    env: &ConcreteEnv,
+    staging: &StagingArea,
+    key_images: HashSet<KeyImage>,
+) -> ResponseResult {
+    if let Some(view) = staging.view() {
+        if key_images
+            .iter()
+            .any(|key_image| view.key_image_spent(key_image))
+        {
+            return Ok(BCResponse::KeyImagesSpent(true));
+        }
+    }
+
     let env_inner = env.env_inner();
+
+    // Small request, use a single transaction on this thread.
+    if !use_parallel(key_images.len()) {
+        let tx_ro = env_inner.tx_ro()?;
+        let table_key_images = env_inner.open_db_ro::<KeyImages>(&tx_ro)?;
+        return key_images_spent_serial(&key_images, &table_key_images);
+    }
+
+    // Prepare tx/tables in `ThreadLocal`.
     let tx_ro = thread_local(env);
     let tables = thread_local(env);
 
@@ -525,3 +678,289 @@ fn key_images_spent(env: &ConcreteEnv, key_images: HashSet<KeyImage>) -> Respons
         Some(Err(e)) => Err(e), // A database error occurred.
     }
 }
+
+/// [`BCReadRequest::Batch`].
+#[inline]
+fn batch(env: &ConcreteEnv, staging: &StagingArea, requests: Vec<BCReadRequest>) -> ResponseResult {
+    // The staging area is locked until the transaction is opened,
+    // such that no block can be staged and committed in-between,
+    // which would make the transaction newer than the view.
+    let staging = staging.read();
+    let view = staging.view();
+
+    // Single-threaded, all requests share 1 transaction.
+    //
+    // INVARIANT: `heed`'s transactions cannot be used on multiple
+    // threads at the same time, and opening 1 transaction per `rayon`
+    // thread would mean multiple snapshots, so no parallelism is used here.
+    let env_inner = env.env_inner();
+    let tx_ro = env_inner.tx_ro()?;
+    let tables = env_inner.open_tables(&tx_ro)?;
+    drop(staging);
+
+    batch_serial(requests, &tables, view.as_deref())
+}
+
+//---------------------------------------------------------------------------------------------------- Serial handler functions
+// These are the single-threaded versions of the above handler functions,
+// operating on already opened tables (and thus, a single transaction).
+//
+// They are used by the handler functions when the request is too
+// small to benefit from parallelism, and by [`BCReadRequest::Batch`],
+// where all requests must be handled within the same transaction.
+
+/// Map a [`BCReadRequest`] to its serial handler function using `tables`.
+///
+/// `view` must have been taken before the transaction of `tables` was opened.
+fn map_request_serial(
+    tables: &impl Tables,
+    request: BCReadRequest,
+    view: Option<&StagingView>,
+) -> ResponseResult {
+    use BCReadRequest as R;
+
+    match request {
+        R::BlockExtendedHeader(block_height) => Ok(BCResponse::BlockExtendedHeader(
+            match view.and_then(|view| view.block_extended_header(block_height)) {
+                Some(header) => header,
+                None => get_block_extended_header_from_height(&block_height, tables)?,
+            },
+        )),
+        R::BlockHash(block_height) => Ok(BCResponse::BlockHash(
+            match view.and_then(|view| view.block_hash(block_height)) {
+                Some(block_hash) => block_hash,
+                None => get_block_info(&block_height, tables.block_infos())?.block_hash,
+            },
+        )),
+        R::FilterUnknownHashes(hashes) => {
+            filter_unknown_hashes_serial(hashes, tables.block_heights(), view)
+        }
+        R::BlockExtendedHeaderInRange(range) => {
+            let (range, staged) = match view {
+                Some(view) => view.block_extended_header_in_range(range)?,
+                None => (range, Vec::new()),
+            };
+            block_extended_header_in_range_serial(range, tables, staged)
+        }
+        R::ChainHeight => match view {
+            Some(view) => {
+                let (chain_height, block_hash) = view.chain_height();
+                Ok(BCResponse::ChainHeight(chain_height, block_hash))
+            }
+            None => chain_height_serial(tables.block_heights(), tables.block_infos()),
+        },
+        R::GeneratedCoins => match view {
+            Some(view) => Ok(BCResponse::GeneratedCoins(view.generated_coins())),
+            None => generated_coins_serial(tables.block_heights(), tables.block_infos()),
+        },
+        R::Outputs(mut map) => {
+            let staged = match view {
+                Some(view) => view.take_outputs(&mut map),
+                None => HashMap::new(),
+            };
+            outputs_serial(map, tables, staged)
+        }
+        R::NumberOutputsWithAmount(vec) => {
+            number_outputs_with_amount_serial(vec, tables.num_outputs(), tables.rct_outputs(), view)
+        }
+        R::KeyImagesSpent(set) => {
+            if view.is_some_and(|view| set.iter().any(|key_image| view.key_image_spent(key_image)))
+            {
+                return Ok(BCResponse::KeyImagesSpent(true));
+            }
+            key_images_spent_serial(&set, tables.key_images())
+        }
+        R::Batch(requests) => batch_serial(requests, tables, view),
+    }
+}
+
+/// Serial [`BCReadRequest::FilterUnknownHashes`].
+///
+/// Hashes of blocks in `view` are also kept.
+fn filter_unknown_hashes_serial(
+    mut hashes: HashSet<BlockHash>,
+    table_block_heights: &impl DatabaseRo<BlockHeights>,
+    view: Option<&StagingView>,
+) -> ResponseResult {
+    let mut err = None;
+
+    hashes.retain(|block_hash| {
+        if view.is_some_and(|view| view.contains_block(block_hash)) {
+            return true;
+        }
+
+        match block_exists(block_hash, table_block_heights) {
+            Ok(exists) => exists,
+            Err(e) => {
+                err.get_or_insert(e);
+                false
+            }
+        }
+    });
+
+    if let Some(e) = err {
+        Err(e)
+    } else {
+        Ok(BCResponse::FilterUnknownHashes(hashes))
+    }
+}
+
+/// Serial [`BCReadRequest::BlockExtendedHeaderInRange`].
+///
+/// The `staged` headers are appended after the ones in `range`.
+fn block_extended_header_in_range_serial(
+    range: std::ops::Range<BlockHeight>,
+    tables: &impl Tables,
+    staged: Vec<ExtendedBlockHeader>,
+) -> ResponseResult {
+    let mut vec = range
+        .map(|block_height| get_block_extended_header_from_height(&block_height, tables))
+        .collect::<Result<Vec<ExtendedBlockHeader>, RuntimeError>>()?;
+
+    vec.extend(staged);
+
+    Ok(BCResponse::BlockExtendedHeaderInRange(vec))
+}
+
+/// Serial [`BCReadRequest::ChainHeight`].
+fn chain_height_serial(
+    table_block_heights: &impl DatabaseRo<BlockHeights>,
+    table_block_infos: &impl DatabaseRo<BlockInfos>,
+) -> ResponseResult {
+    let chain_height = crate::ops::blockchain::chain_height(table_block_heights)?;
+    let block_hash = get_block_info(&chain_height.saturating_sub(1), table_block_infos)?.block_hash;
+
+    Ok(BCResponse::ChainHeight(chain_height, block_hash))
+}
+
+/// Serial [`BCReadRequest::GeneratedCoins`].
+fn generated_coins_serial(
+    table_block_heights: &impl DatabaseRo<BlockHeights>,
+    table_block_infos: &impl DatabaseRo<BlockInfos>,
+) -> ResponseResult {
+    let top_height = top_block_height(table_block_heights)?;
+
+    Ok(BCResponse::GeneratedCoins(cumulative_generated_coins(
+        &top_height,
+        table_block_infos,
+    )?))
+}
+
+/// Serial [`BCReadRequest::Outputs`].
+///
+/// The `staged` outputs are merged into the response.
+fn outputs_serial(
+    outputs: HashMap<Amount, HashSet<AmountIndex>>,
+    tables: &impl Tables,
+    staged: HashMap<Amount, HashMap<AmountIndex, OutputOnChain>>,
+) -> ResponseResult {
+    let map = outputs
+        .into_iter()
+        .map(|(amount, amount_index_set)| {
+            Ok((
+                amount,
+                amount_index_set
+                    .into_iter()
+                    .map(|amount_index| {
+                        let id = PreRctOutputId {
+                            amount,
+                            amount_index,
+                        };
+                        Ok((amount_index, id_to_output_on_chain(&id, tables)?))
+                    })
+                    .collect::<Result<HashMap<AmountIndex, OutputOnChain>, RuntimeError>>()?,
+            ))
+        })
+        .collect::<Result<HashMap<Amount, HashMap<AmountIndex, OutputOnChain>>, RuntimeError>>()?;
+
+    Ok(BCResponse::Outputs(merge_outputs(map, staged)))
+}
+
+/// Merge the `staged` outputs taken with [`StagingView::take_outputs`] into `map`.
+#[inline]
+fn merge_outputs(
+    mut map: HashMap<Amount, HashMap<AmountIndex, OutputOnChain>>,
+    staged: HashMap<Amount, HashMap<AmountIndex, OutputOnChain>>,
+) -> HashMap<Amount, HashMap<AmountIndex, OutputOnChain>> {
+    for (amount, outputs) in staged {
+        map.entry(amount).or_default().extend(outputs);
+    }
+
+    map
+}
+
+/// Serial [`BCReadRequest::NumberOutputsWithAmount`].
+///
+/// Outputs in `view` are also counted.
+fn number_outputs_with_amount_serial(
+    amounts: Vec<Amount>,
+    table_num_outputs: &impl DatabaseRo<NumOutputs>,
+    table_rct_outputs: &impl DatabaseRo<RctOutputs>,
+    view: Option<&StagingView>,
+) -> ResponseResult {
+    // INVARIANT: #[cfg] @ lib.rs asserts `usize == u64`
+    #[allow(clippy::cast_possible_truncation)]
+    let num_rct_outputs = table_rct_outputs.len()? as usize;
+
+    let map = amounts
+        .into_iter()
+        .map(|amount| {
+            // INVARIANT: #[cfg] @ lib.rs asserts `usize == u64`
+            #[allow(clippy::cast_possible_truncation)]
+            let staged_count = view
+                .and_then(|view| view.number_outputs_with_amount(amount))
+                .map(|count| count as usize);
+
+            if let Some(count) = staged_count {
+                Ok((amount, count))
+            } else if amount == 0 {
+                // v2 transactions.
+                Ok((amount, num_rct_outputs))
+            } else {
+                // v1 transactions.
+                match table_num_outputs.get(&amount) {
+                    // INVARIANT: #[cfg] @ lib.rs asserts `usize == u64`
+                    #[allow(clippy::cast_possible_truncation)]
+                    Ok(count) => Ok((amount, count as usize)),
+                    // If we get a request for an `amount` that doesn't exist,
+                    // we return `0` instead of an error.
+                    Err(RuntimeError::KeyNotFound) => Ok((amount, 0)),
+                    Err(e) => Err(e),
+                }
+            }
+        })
+        .collect::<Result<HashMap<Amount, usize>, RuntimeError>>()?;
+
+    Ok(BCResponse::NumberOutputsWithAmount(map))
+}
+
+/// Serial [`BCReadRequest::KeyImagesSpent`].
+fn key_images_spent_serial(
+    key_images: &HashSet<KeyImage>,
+    table_key_images: &impl DatabaseRo<KeyImages>,
+) -> ResponseResult {
+    for key_image in key_images {
+        // Return early on the first spent key image.
+        if key_image_exists(key_image, table_key_images)? {
+            return Ok(BCResponse::KeyImagesSpent(true));
+        }
+    }
+
+    Ok(BCResponse::KeyImagesSpent(false))
+}
+
+/// Serial [`BCReadRequest::Batch`].
+///
+/// All `requests` are handled using the same `tables` (and `view`), in order.
+fn batch_serial(
+    requests: Vec<BCReadRequest>,
+    tables: &impl Tables,
+    view: Option<&StagingView>,
+) -> ResponseResult {
+    let responses = requests
+        .into_iter()
+        .map(|request| map_request_serial(tables, request, view))
+        .collect::<Result<Vec<BCResponse>, RuntimeError>>()?;
+
+    Ok(BCResponse::Batch(responses))
+}
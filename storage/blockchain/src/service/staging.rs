@@ -0,0 +1,552 @@
+//! Write-ahead staging area for blocks that are not yet committed.
+//!
+//! Blocks sent to the [`DatabaseWriteHandle`](super::DatabaseWriteHandle)
+//! are staged here by the stager thread _before_ they are sent to the writer
+//! thread, and are unstaged by the writer thread once their write transaction
+//! has finished.
+//!
+//! Readers consult a [`StagingView`] of these blocks on top of
+//! the database, such that a verified block's outputs, key images,
+//! etc are visible to readers the moment it is sent to the writer,
+//! instead of after it is committed to disk.
+//!
+//! Each block reserves a staging ID when it is sent, readers wait
+//! for every reserved block to be staged before reading, so a read
+//! sent after a write request always sees that request's block.
+//!
+//! This allows verification of the next batch of blocks to
+//! race ahead of the disk commits of the previous batches.
+//!
+//! # Snapshots
+//! The database totals the staged blocks sit on top of (chain height, output
+//! counts, etc) are read once when the first block is staged, and are then
+//! advanced as each block is written, so creating a [`StagingView`] is just
+//! an [`Arc`] clone, it does not touch the database.
+//!
+//! # Failures
+//! If a block fails to be written, it and every block staged above it are
+//! dropped, the blocks above it are then failed by the writer without being
+//! written, as they were verified against the failed block.
+
+//---------------------------------------------------------------------------------------------------- Import
+use std::{
+    collections::{HashMap, HashSet, VecDeque},
+    ops::Range,
+    sync::{
+        atomic::{AtomicU64, Ordering},
+        Arc, Condvar, Mutex, RwLock, RwLockReadGuard,
+    },
+};
+
+use curve25519_dalek::edwards::CompressedEdwardsY;
+use monero_serai::transaction::Timelock;
+
+use cuprate_database::{ConcreteEnv, DatabaseRo, Env, EnvInner, RuntimeError};
+use cuprate_helper::{crypto::compute_zero_commitment, map::u64_to_timelock};
+use cuprate_types::{ExtendedBlockHeader, OutputOnChain, VerifiedBlockInformation};
+
+use crate::{
+    open_tables::OpenTables,
+    ops::{
+        block::PreparedBlock,
+        blockchain::{chain_height, cumulative_generated_coins},
+        tx::PreparedOutput,
+    },
+    tables::Tables,
+    types::{Amount, AmountIndex, BlockHash, BlockHeight, KeyImage, PreRctOutputId},
+};
+
+//---------------------------------------------------------------------------------------------------- StagingArea
+/// The blocks sent to the writer thread that have not been committed yet.
+///
+/// This is shared between the [`DatabaseReadHandle`](super::DatabaseReadHandle)s
+/// and the [`DatabaseWriteHandle`](super::DatabaseWriteHandle).
+///
+/// The current [`StagingView`] is replaced (copy-on-write) on every
+/// stage/unstage, views held by readers are never modified.
+#[derive(Debug, Default)]
+pub(super) struct StagingArea {
+    /// The staged blocks on top of the database totals.
+    view: RwLock<Arc<StagingView>>,
+    /// The ID of the next reserved block.
+    next_id: AtomicU64,
+    /// The ID of the next block to be staged,
+    /// all blocks below it were staged (or failed to be).
+    staged_id: Mutex<u64>,
+    /// Notified each time `staged_id` is advanced.
+    staged: Condvar,
+}
+
+impl StagingArea {
+    /// Reserve the staging ID of a block about to be staged.
+    ///
+    /// Readers wait for all reserved blocks to be staged, so every
+    /// reserved ID must be passed to [`StagingArea::stage`], in order.
+    pub(super) fn reserve(&self) -> u64 {
+        self.next_id.fetch_add(1, Ordering::Relaxed)
+    }
+
+    /// Stage `block` with the staging ID `id` from [`StagingArea::reserve`],
+    /// this must be done before sending it to the writer thread.
+    ///
+    /// `prepared` must be the [`PreparedBlock`] of `block`.
+    ///
+    /// The ID is passed to [`StagingArea::unstage`] & co.
+    ///
+    /// This only reads from `env` if nothing is staged, or
+    /// if `block` contains a pre-RCT amount no staged block has.
+    ///
+    /// # Errors
+    /// This returns an error if `block` does not directly
+    /// follow the top staged block (or the database's top
+    /// block if nothing is staged), or if `env` could not be read.
+    ///
+    /// The ID is used up either way, readers waiting on it continue.
+    pub(super) fn stage(
+        &self,
+        env: &ConcreteEnv,
+        id: u64,
+        block: &VerifiedBlockInformation,
+        prepared: &PreparedBlock,
+    ) -> Result<(), RuntimeError> {
+        let result = self.stage_inner(env, id, block, prepared);
+
+        let mut staged_id = self.staged_id.lock().unwrap();
+        assert_eq!(*staged_id, id, "blocks must be staged in order");
+        *staged_id += 1;
+        self.staged.notify_all();
+
+        result
+    }
+
+    /// [`StagingArea::stage`], without advancing `staged_id`.
+    fn stage_inner(
+        &self,
+        env: &ConcreteEnv,
+        id: u64,
+        block: &VerifiedBlockInformation,
+        prepared: &PreparedBlock,
+    ) -> Result<(), RuntimeError> {
+        let block = StagedBlock::new(id, block, prepared);
+
+        let mut guard = self.view.write().unwrap();
+        let view = Arc::make_mut(&mut guard);
+
+        // If nothing is staged, the database is up-to-date, the totals are
+        // re-read as the previous ones may be from before a failed block.
+        //
+        // Otherwise, a pre-RCT amount not in `num_outputs` is not in any staged
+        // block, so the database's count for it cannot have changed since
+        // the totals were read, even if a staged block was just committed.
+        let new_amounts = block
+            .pre_rct_outputs
+            .keys()
+            .filter(|amount| view.blocks.is_empty() || !view.num_outputs.contains_key(amount))
+            .copied()
+            .collect::<Vec<Amount>>();
+
+        if view.blocks.is_empty() || !new_amounts.is_empty() {
+            let env_inner = env.env_inner();
+            let tx_ro = env_inner.tx_ro()?;
+            let tables = env_inner.open_tables(&tx_ro)?;
+
+            if view.blocks.is_empty() {
+                let chain_height = chain_height(tables.block_heights())?;
+                *view = StagingView {
+                    chain_height,
+                    generated_coins: cumulative_generated_coins(
+                        &chain_height.saturating_sub(1),
+                        tables.block_infos(),
+                    )?,
+                    rct_outputs_len: tables.rct_outputs().len()?,
+                    num_outputs: HashMap::new(),
+                    blocks: VecDeque::new(),
+                };
+            }
+
+            for amount in new_amounts {
+                let count = match tables.num_outputs().get(&amount) {
+                    Ok(count) => count,
+                    Err(RuntimeError::KeyNotFound) => 0,
+                    Err(e) => return Err(e),
+                };
+
+                view.num_outputs.insert(amount, count);
+            }
+        }
+
+        if block.height != view.chain_height + view.blocks.len() as u64 {
+            return Err(RuntimeError::Io(std::io::Error::other(
+                "block does not follow the top staged block",
+            )));
+        }
+
+        view.blocks.push_back(Arc::new(block));
+
+        Ok(())
+    }
+
+    /// Is the block with the staging ID `id` still staged?
+    ///
+    /// This is [`false`] after the block is unstaged,
+    /// or if a block below it failed to be written.
+    pub(super) fn is_staged(&self, id: u64) -> bool {
+        self.view
+            .read()
+            .unwrap()
+            .blocks
+            .iter()
+            .any(|block| block.id == id)
+    }
+
+    /// Unstage the block with the staging ID `id`, after it was committed.
+    ///
+    /// The block's data is moved into the database totals.
+    ///
+    /// # Panics
+    /// This panics if the block is not the bottom staged block,
+    /// blocks must be written in the order they were staged.
+    pub(super) fn unstage(&self, id: u64) {
+        let mut guard = self.view.write().unwrap();
+        let view = Arc::make_mut(&mut guard);
+
+        let block = view.blocks.pop_front().unwrap();
+        assert_eq!(block.id, id, "blocks must be unstaged in order");
+
+        view.chain_height += 1;
+        view.generated_coins += block.generated_coins;
+        view.rct_outputs_len += block.rct_outputs.len() as u64;
+        for (amount, outputs) in &block.pre_rct_outputs {
+            // INVARIANT: `num_outputs` contains every staged pre-RCT amount.
+            *view.num_outputs.get_mut(amount).unwrap() += outputs.len() as u64;
+        }
+    }
+
+    /// Unstage the block with the staging ID `id` after it failed
+    /// to be written, along with every block staged above it.
+    pub(super) fn unstage_failed(&self, id: u64) {
+        let mut guard = self.view.write().unwrap();
+        let view = Arc::make_mut(&mut guard);
+
+        if let Some(i) = view.blocks.iter().position(|block| block.id == id) {
+            view.blocks.truncate(i);
+        }
+    }
+
+    /// Lock the staging area for reading.
+    ///
+    /// This first waits for the blocks reserved so far to be staged.
+    ///
+    /// Nothing can be staged or unstaged while the lock is held.
+    pub(super) fn read(&self) -> StagingReadGuard<'_> {
+        let reserved = self.next_id.load(Ordering::Relaxed);
+        let staged_id = self.staged_id.lock().unwrap();
+        drop(
+            self.staged
+                .wait_while(staged_id, |staged_id| *staged_id < reserved)
+                .unwrap(),
+        );
+
+        StagingReadGuard(self.view.read().unwrap())
+    }
+
+    /// The current [`StagingView`], [`None`] if nothing is staged.
+    ///
+    /// # Invariant
+    /// Any read transaction used alongside the view must be opened _after_
+    /// this is called, else a block could be committed and unstaged in-between,
+    /// which would leave a gap between the transaction's snapshot and the view.
+    pub(super) fn view(&self) -> Option<Arc<StagingView>> {
+        self.read().view()
+    }
+}
+
+/// A read lock on a [`StagingArea`], see [`StagingArea::read`].
+pub(super) struct StagingReadGuard<'a>(RwLockReadGuard<'a, Arc<StagingView>>);
+
+impl StagingReadGuard<'_> {
+    /// The current [`StagingView`], [`None`] if nothing is staged.
+    ///
+    /// See [`StagingArea::view`].
+    pub(super) fn view(&self) -> Option<Arc<StagingView>> {
+        if self.0.blocks.is_empty() {
+            None
+        } else {
+            Some(Arc::clone(&self.0))
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------- StagedBlock
+/// The data of a staged block that readers may request.
+#[derive(Debug)]
+struct StagedBlock {
+    /// The block's staging ID.
+    id: u64,
+    /// The block's height.
+    height: BlockHeight,
+    /// The block's hash.
+    hash: BlockHash,
+    /// The block's extended header.
+    header: ExtendedBlockHeader,
+    /// The coins generated by this block.
+    generated_coins: u64,
+    /// The key images spent in this block.
+    key_images: HashSet<KeyImage>,
+    /// The RCT outputs created in this block, in database order.
+    rct_outputs: Vec<StagedOutput>,
+    /// The pre-RCT outputs created in this block, in database order.
+    pre_rct_outputs: HashMap<Amount, Vec<StagedOutput>>,
+}
+
+/// An output of a [`StagedBlock`].
+#[derive(Debug)]
+struct StagedOutput {
+    /// The prepared output, as it will be written.
+    output: PreparedOutput,
+    /// The unlock time of the output's transaction.
+    unlock_time: Option<u64>,
+}
+
+impl StagedBlock {
+    /// Collect the data readers may request from `block` and its `prepared` data.
+    fn new(id: u64, block: &VerifiedBlockInformation, prepared: &PreparedBlock) -> Self {
+        let mut key_images = HashSet::new();
+        let mut rct_outputs = Vec::new();
+        let mut pre_rct_outputs = HashMap::<Amount, Vec<StagedOutput>>::new();
+
+        // The miner transaction is added first, the same as `add_prepared_block`.
+        for tx in std::iter::once(&prepared.miner_tx).chain(&prepared.txs) {
+            key_images.extend(tx.key_images.iter().copied());
+
+            for &output in &tx.outputs {
+                let staged = StagedOutput {
+                    output,
+                    unlock_time: tx.unlock_time,
+                };
+
+                match output {
+                    PreparedOutput::PreRct { amount, .. } => {
+                        pre_rct_outputs.entry(amount).or_default().push(staged);
+                    }
+                    PreparedOutput::Rct { .. } => rct_outputs.push(staged),
+                }
+            }
+        }
+
+        Self {
+            id,
+            height: block.height,
+            hash: block.block_hash,
+            header: ExtendedBlockHeader {
+                version: block.block.header.major_version,
+                vote: block.block.header.minor_version,
+                timestamp: block.block.header.timestamp,
+                cumulative_difficulty: block.cumulative_difficulty,
+                block_weight: block.weight,
+                long_term_weight: block.long_term_weight,
+            },
+            generated_coins: block.generated_coins,
+            key_images,
+            rct_outputs,
+            pre_rct_outputs,
+        }
+    }
+
+    /// The outputs of this block with `amount`.
+    fn outputs(&self, amount: Amount) -> &[StagedOutput] {
+        if amount == 0 {
+            &self.rct_outputs
+        } else {
+            self.pre_rct_outputs.get(&amount).map_or(&[], Vec::as_slice)
+        }
+    }
+}
+
+impl StagedOutput {
+    /// Map this output to an [`OutputOnChain`], the same
+    /// way [`id_to_output_on_chain`](crate::ops::output::id_to_output_on_chain) does.
+    fn output_on_chain(&self, height: BlockHeight) -> OutputOnChain {
+        let (key, commitment) = match self.output {
+            PreparedOutput::PreRct { key, amount } => (key, compute_zero_commitment(amount)),
+            // INVARIANT: prepared commitments are compressed valid points.
+            PreparedOutput::Rct { key, commitment } => {
+                (key, CompressedEdwardsY(commitment).decompress().unwrap())
+            }
+        };
+
+        OutputOnChain {
+            height,
+            time_lock: self.unlock_time.map_or(Timelock::None, u64_to_timelock),
+            key: CompressedEdwardsY(key).decompress(),
+            commitment,
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------- StagingView
+/// The staged blocks on top of the database totals they were staged against.
+///
+/// All staged data is identical to what it will be once it is committed,
+/// so data from a view can be mixed with data from any database snapshot
+/// taken after the view was created.
+#[derive(Clone, Debug, Default)]
+pub(super) struct StagingView {
+    /// The database's chain height.
+    chain_height: BlockHeight,
+    /// The database's cumulative generated coins.
+    generated_coins: u64,
+    /// The database's amount of RCT outputs.
+    rct_outputs_len: u64,
+    /// The database's amount of pre-RCT outputs,
+    /// for (at least) each amount the staged blocks contain.
+    num_outputs: HashMap<Amount, u64>,
+    /// The staged blocks directly on top of the database, in height order.
+    blocks: VecDeque<Arc<StagedBlock>>,
+}
+
+impl StagingView {
+    /// The staged block at `height`, if any.
+    fn block(&self, height: BlockHeight) -> Option<&StagedBlock> {
+        let i = height.checked_sub(self.chain_height)?;
+        // INVARIANT: #[cfg] @ lib.rs asserts `usize == u64`
+        #[allow(clippy::cast_possible_truncation)]
+        self.blocks.get(i as usize).map(AsRef::as_ref)
+    }
+
+    /// The chain height and top block hash, including staged blocks.
+    pub(super) fn chain_height(&self) -> (BlockHeight, BlockHash) {
+        // INVARIANT: views always contain at least 1 block.
+        let top = self.blocks.back().unwrap();
+        (top.height + 1, top.hash)
+    }
+
+    /// The cumulative generated coins, including staged blocks.
+    pub(super) fn generated_coins(&self) -> u64 {
+        self.generated_coins + self.blocks.iter().map(|b| b.generated_coins).sum::<u64>()
+    }
+
+    /// The hash of the staged block at `height`, if any.
+    pub(super) fn block_hash(&self, height: BlockHeight) -> Option<BlockHash> {
+        self.block(height).map(|b| b.hash)
+    }
+
+    /// The extended header of the staged block at `height`, if any.
+    pub(super) fn block_extended_header(&self, height: BlockHeight) -> Option<ExtendedBlockHeader> {
+        self.block(height).map(|b| b.header)
+    }
+
+    /// Split off the staged part of `range`.
+    ///
+    /// This returns the part of `range` that is in the database,
+    /// and the extended headers of the rest of `range`.
+    ///
+    /// # Errors
+    /// This returns [`RuntimeError::KeyNotFound`] if `range`
+    /// goes past the top staged block.
+    pub(super) fn block_extended_header_in_range(
+        &self,
+        range: Range<BlockHeight>,
+    ) -> Result<(Range<BlockHeight>, Vec<ExtendedBlockHeader>), RuntimeError> {
+        let split = range.end.min(self.chain_height).max(range.start);
+
+        let headers = (split..range.end)
+            .map(|height| {
+                self.block_extended_header(height)
+                    .ok_or(RuntimeError::KeyNotFound)
+            })
+            .collect::<Result<Vec<ExtendedBlockHeader>, RuntimeError>>()?;
+
+        Ok((range.start..split, headers))
+    }
+
+    /// Is `block_hash` a staged block?
+    pub(super) fn contains_block(&self, block_hash: &BlockHash) -> bool {
+        self.blocks.iter().any(|b| &b.hash == block_hash)
+    }
+
+    /// Is `key_image` spent in a staged block?
+    pub(super) fn key_image_spent(&self, key_image: &KeyImage) -> bool {
+        self.blocks.iter().any(|b| b.key_images.contains(key_image))
+    }
+
+    /// The database's amount of outputs with `amount`, as of this view.
+    ///
+    /// This returns [`None`] for pre-RCT amounts no staged block contains.
+    fn db_count(&self, amount: Amount) -> Option<u64> {
+        if amount == 0 {
+            Some(self.rct_outputs_len)
+        } else {
+            self.num_outputs.get(&amount).copied()
+        }
+    }
+
+    /// The amount of outputs with `amount`, including staged blocks.
+    ///
+    /// This returns [`None`] if no staged block contains outputs
+    /// with this amount, in which case the database's count is correct.
+    pub(super) fn number_outputs_with_amount(&self, amount: Amount) -> Option<u64> {
+        let db_count = self.db_count(amount)?;
+
+        let staged_count = self
+            .blocks
+            .iter()
+            .map(|b| b.outputs(amount).len() as u64)
+            .sum::<u64>();
+
+        Some(db_count + staged_count)
+    }
+
+    /// The staged output `id`, if any.
+    ///
+    /// This returns [`None`] if the output is (or should be) in the database.
+    pub(super) fn output(&self, id: &PreRctOutputId) -> Option<OutputOnChain> {
+        let mut i = id.amount_index.checked_sub(self.db_count(id.amount)?)?;
+
+        for block in &self.blocks {
+            let outputs = block.outputs(id.amount);
+
+            // INVARIANT: #[cfg] @ lib.rs asserts `usize == u64`
+            #[allow(clippy::cast_possible_truncation)]
+            if let Some(output) = outputs.get(i as usize) {
+                return Some(output.output_on_chain(block.height));
+            }
+
+            i -= outputs.len() as u64;
+        }
+
+        None
+    }
+
+    /// Remove the staged outputs from `outputs`, and return them.
+    ///
+    /// The outputs left in `outputs` must be read from the database.
+    pub(super) fn take_outputs(
+        &self,
+        outputs: &mut HashMap<Amount, HashSet<AmountIndex>>,
+    ) -> HashMap<Amount, HashMap<AmountIndex, OutputOnChain>> {
+        let mut staged = HashMap::new();
+
+        for (amount, amount_indices) in outputs.iter_mut() {
+            amount_indices.retain(|amount_index| {
+                let id = PreRctOutputId {
+                    amount: *amount,
+                    amount_index: *amount_index,
+                };
+
+                match self.output(&id) {
+                    Some(output_on_chain) => {
+                        staged
+                            .entry(*amount)
+                            .or_insert_with(HashMap::new)
+                            .insert(*amount_index, output_on_chain);
+                        false
+                    }
+                    None => true,
+                }
+            });
+        }
+
+        staged
+    }
+}
@@ -12,10 +12,13 @@ use std::{
     sync::Arc,
 };
 
+use monero_serai::transaction::Input;
 use pretty_assertions::assert_eq;
 use tower::{Service, ServiceExt};
 
-use cuprate_database::{ConcreteEnv, DatabaseIter, DatabaseRo, Env, EnvInner, RuntimeError};
+use cuprate_database::{
+    ConcreteEnv, DatabaseIter, DatabaseRo, DatabaseRw, Env, EnvInner, RuntimeError, TxRw,
+};
 use cuprate_test_utils::data::{block_v16_tx0, block_v1_tx2, block_v9_tx3};
 use cuprate_types::{
     blockchain::{BCReadRequest, BCResponse, BCWriteRequest},
@@ -26,14 +29,15 @@ use crate::{
     config::ConfigBuilder,
     open_tables::OpenTables,
     ops::{
-        block::{get_block_extended_header_from_height, get_block_info},
+        block::{get_block_extended_header_from_height, get_block_info, PreparedBlock},
         blockchain::chain_height,
         output::id_to_output_on_chain,
+        tx::PreparedOutput,
     },
-    service::{init, DatabaseReadHandle, DatabaseWriteHandle},
-    tables::{Tables, TablesIter},
+    service::{init, staging::StagingArea, DatabaseReadHandle, DatabaseWriteHandle},
+    tables::{Tables, TablesIter, TablesMut},
     tests::AssertTableLen,
-    types::{Amount, AmountIndex, PreRctOutputId},
+    types::{Amount, AmountIndex, KeyImage, PreRctOutputId},
 };
 
 //---------------------------------------------------------------------------------------------------- Helper functions
@@ -84,7 +88,7 @@ async fn test_template(
 
         // Request a block to be written, assert it was written.
         let request = BCWriteRequest::WriteBlock(block);
-        let response_channel = writer.call(request);
+        let response_channel = writer.ready().await.unwrap().call(request);
         let response = response_channel.await.unwrap();
         assert_eq!(response, BCResponse::WriteBlockOk);
     }
@@ -200,6 +204,33 @@ async fn test_template(
         }
     }
 
+    //----------------------------------------------------------------------- Batch checks
+    // Assert a batch of requests leads to the same
+    // responses as sending the requests one by one.
+    let batch = vec![
+        BCReadRequest::BlockExtendedHeader(0),
+        BCReadRequest::BlockHash(0),
+        BCReadRequest::BlockExtendedHeaderInRange(0..1),
+        BCReadRequest::ChainHeight,
+        BCReadRequest::GeneratedCoins,
+        BCReadRequest::KeyImagesSpent(HashSet::from([[0; 32]])),
+        BCReadRequest::Batch(vec![BCReadRequest::ChainHeight]),
+    ];
+    let mut expected_responses = Vec::with_capacity(batch.len());
+    for request in batch.clone() {
+        expected_responses.push(reader.clone().oneshot(request).await.unwrap());
+    }
+    let response = reader.clone().oneshot(BCReadRequest::Batch(batch)).await;
+    assert_eq!(response.unwrap(), BCResponse::Batch(expected_responses));
+
+    // Assert a batch with a failing request fails as a whole.
+    let request = BCReadRequest::Batch(vec![
+        BCReadRequest::ChainHeight,
+        BCReadRequest::BlockHash(u64::MAX),
+    ]);
+    let response = reader.clone().oneshot(request).await;
+    assert!(matches!(response, Err(RuntimeError::KeyNotFound)));
+
     //----------------------------------------------------------------------- Key image checks
     // Assert each key image we inserted comes back as "spent".
     for key_image in tables.key_images_iter().keys().unwrap() {
@@ -210,6 +241,22 @@ async fn test_template(
         assert_eq!(response.unwrap(), BCResponse::KeyImagesSpent(true));
     }
 
+    // Assert all key images requested at once come back as "spent".
+    //
+    // Depending on the block(s), this request is large
+    // enough to be handled by the parallel code path.
+    let key_images = tables
+        .key_images_iter()
+        .keys()
+        .unwrap()
+        .map(Result::unwrap)
+        .collect::<HashSet<KeyImage>>();
+    if !key_images.is_empty() {
+        let request = BCReadRequest::KeyImagesSpent(key_images);
+        let response = reader.clone().oneshot(request).await;
+        assert_eq!(response.unwrap(), BCResponse::KeyImagesSpent(true));
+    }
+
     //----------------------------------------------------------------------- Output checks
     // Create the map of amounts and amount indices.
     //
@@ -383,3 +430,347 @@ async fn v16_tx0() {
     )
     .await;
 }
+
+/// Assert multiple write requests sent at once, which are (potentially)
+/// handled within the same write transaction, are all written.
+#[tokio::test]
+async fn write_group() {
+    let (reader, mut writer, _env, _tempdir) = init_service();
+
+    let block_fns: [fn() -> &'static VerifiedBlockInformation; 3] =
+        [block_v1_tx2, block_v9_tx3, block_v16_tx0];
+
+    // Send all requests before awaiting any response.
+    let mut response_channels = Vec::new();
+    for (i, block_fn) in block_fns.into_iter().enumerate() {
+        let mut block = block_fn().clone();
+        block.height = i as u64;
+        let request = BCWriteRequest::WriteBlock(block);
+        response_channels.push(writer.ready().await.unwrap().call(request));
+    }
+
+    for response_channel in response_channels {
+        assert_eq!(response_channel.await.unwrap(), BCResponse::WriteBlockOk);
+    }
+
+    let response = reader.oneshot(BCReadRequest::ChainHeight).await.unwrap();
+    assert!(matches!(response, BCResponse::ChainHeight(3, _)));
+}
+
+/// Assert a [`StagingArea`]'s view of each block matches
+/// the database once the block is actually written.
+///
+/// This covers both pre-RCT (`block_v1_tx2`) and RCT outputs.
+#[tokio::test]
+async fn staging() {
+    let (_reader, mut writer, env, _tempdir) = init_service();
+
+    let blocks = [block_v1_tx2, block_v16_tx0, block_v9_tx3]
+        .into_iter()
+        .enumerate()
+        .map(|(i, block_fn)| {
+            let mut block = block_fn().clone();
+            block.height = i as u64;
+            block
+        })
+        .collect::<Vec<VerifiedBlockInformation>>();
+
+    for block in blocks {
+        // Stage the block without writing it.
+        let prepared = PreparedBlock::new(&block);
+        let staging = StagingArea::default();
+        assert!(staging.view().is_none());
+        let staging_id = staging.reserve();
+        staging.stage(&env, staging_id, &block, &prepared).unwrap();
+        let view = staging.view().unwrap();
+        assert!(staging.is_staged(staging_id));
+
+        // A block that does not follow the staged block is rejected.
+        let next_id = staging.reserve();
+        assert!(staging.stage(&env, next_id, &block, &prepared).is_err());
+
+        // The amounts of the block's outputs, and their database counts before writing.
+        let db_counts = {
+            let env_inner = env.env_inner();
+            let tx_ro = env_inner.tx_ro().unwrap();
+            let tables = env_inner.open_tables(&tx_ro).unwrap();
+
+            std::iter::once(&prepared.miner_tx)
+                .chain(&prepared.txs)
+                .flat_map(|tx| &tx.outputs)
+                .map(|output| match output {
+                    PreparedOutput::PreRct { amount, .. } => *amount,
+                    PreparedOutput::Rct { .. } => 0,
+                })
+                .collect::<HashSet<Amount>>()
+                .into_iter()
+                .map(|amount| (amount, num_outputs(&tables, amount)))
+                .collect::<HashMap<Amount, u64>>()
+        };
+
+        // Write it, and compare against the tables.
+        let response = writer
+            .ready()
+            .await
+            .unwrap()
+            .call(BCWriteRequest::WriteBlock(block.clone()))
+            .await
+            .unwrap();
+        assert_eq!(response, BCResponse::WriteBlockOk);
+
+        let env_inner = env.env_inner();
+        let tx_ro = env_inner.tx_ro().unwrap();
+        let tables = env_inner.open_tables(&tx_ro).unwrap();
+
+        let height = block.height;
+        assert_eq!(
+            view.chain_height(),
+            (
+                chain_height(tables.block_heights()).unwrap(),
+                block.block_hash
+            )
+        );
+        assert_eq!(
+            view.block_extended_header(height).unwrap(),
+            get_block_extended_header_from_height(&height, &tables).unwrap()
+        );
+        assert!(view.contains_block(&block.block_hash));
+        if let Some(previous_height) = height.checked_sub(1) {
+            assert_eq!(view.block_extended_header(previous_height), None);
+        }
+
+        for (amount, db_count) in db_counts {
+            let count = num_outputs(&tables, amount);
+            assert_ne!(count, db_count);
+            assert_eq!(view.number_outputs_with_amount(amount), Some(count));
+
+            for amount_index in 0..count {
+                let id = PreRctOutputId {
+                    amount,
+                    amount_index,
+                };
+                let expected = id_to_output_on_chain(&id, &tables).unwrap();
+
+                match view.output(&id) {
+                    Some(output) => assert_eq!(output, expected),
+                    None => assert!(amount_index < db_count),
+                }
+            }
+        }
+
+        for key_image in tables.key_images_iter().keys().unwrap() {
+            let key_image: KeyImage = key_image.unwrap();
+            // Key images of previous blocks are not in the view.
+            let in_block = block.txs.iter().any(|tx| {
+                tx.tx.prefix.inputs.iter().any(|input| match input {
+                    Input::ToKey { key_image: k, .. } => k.compress().to_bytes() == key_image,
+                    Input::Gen(_) => false,
+                })
+            });
+            assert_eq!(view.key_image_spent(&key_image), in_block);
+        }
+
+        // Once a block fails to be written, it is no longer staged.
+        staging.unstage_failed(staging_id);
+        assert!(!staging.is_staged(staging_id));
+        assert!(staging.view().is_none());
+    }
+}
+
+/// Assert blocks sent to the writer, but not yet written, are served by
+/// the [`DatabaseReadHandle`] exactly as they are once they are written.
+#[tokio::test]
+async fn staged_reads() {
+    let (reader, mut writer, env, _tempdir) = init_service();
+
+    let blocks = [block_v1_tx2, block_v9_tx3, block_v16_tx0]
+        .into_iter()
+        .enumerate()
+        .map(|(i, block_fn)| {
+            let mut block = block_fn().clone();
+            block.height = i as u64;
+            block
+        })
+        .collect::<Vec<VerifiedBlockInformation>>();
+
+    // The outputs created by the blocks, the database is empty so they start at index 0.
+    let mut output_counts = HashMap::<Amount, u64>::new();
+    for block in &blocks {
+        let prepared = PreparedBlock::new(block);
+        for output in std::iter::once(&prepared.miner_tx)
+            .chain(&prepared.txs)
+            .flat_map(|tx| &tx.outputs)
+        {
+            let amount = match output {
+                PreparedOutput::PreRct { amount, .. } => *amount,
+                PreparedOutput::Rct { .. } => 0,
+            };
+            *output_counts.entry(amount).or_default() += 1;
+        }
+    }
+    let outputs = output_counts
+        .iter()
+        .map(|(amount, count)| (*amount, (0..*count).collect::<HashSet<AmountIndex>>()))
+        .collect::<HashMap<Amount, HashSet<AmountIndex>>>();
+
+    let key_images = blocks
+        .iter()
+        .flat_map(|block| &block.txs)
+        .flat_map(|tx| &tx.tx.prefix.inputs)
+        .filter_map(|input| match input {
+            Input::ToKey { key_image, .. } => Some(key_image.compress().to_bytes()),
+            Input::Gen(_) => None,
+        })
+        .collect::<HashSet<KeyImage>>();
+    assert!(!key_images.is_empty());
+
+    let requests = [
+        BCReadRequest::ChainHeight,
+        BCReadRequest::GeneratedCoins,
+        BCReadRequest::BlockHash(1),
+        BCReadRequest::BlockExtendedHeader(2),
+        BCReadRequest::BlockExtendedHeaderInRange(0..3),
+        BCReadRequest::FilterUnknownHashes(blocks.iter().map(|b| b.block_hash).collect()),
+        BCReadRequest::NumberOutputsWithAmount(output_counts.keys().copied().collect()),
+        BCReadRequest::Outputs(outputs.clone()),
+        BCReadRequest::KeyImagesSpent(key_images),
+    ];
+
+    // Hold a write transaction, such that the writer cannot write the blocks.
+    let env_inner = env.env_inner();
+    let tx_rw = env_inner.tx_rw().unwrap();
+
+    let mut response_channels = Vec::new();
+    for block in &blocks {
+        let request = BCWriteRequest::WriteBlock(block.clone());
+        response_channels.push(writer.ready().await.unwrap().call(request));
+    }
+
+    // Reads sent after the write requests see the staged blocks.
+    let mut staged_responses = Vec::with_capacity(requests.len());
+    for request in requests.clone() {
+        staged_responses.push(reader.clone().oneshot(request).await.unwrap());
+    }
+
+    let top = blocks.last().unwrap();
+    assert_eq!(
+        staged_responses[0],
+        BCResponse::ChainHeight(3, top.block_hash)
+    );
+    assert_eq!(
+        staged_responses[1],
+        BCResponse::GeneratedCoins(blocks.iter().map(|b| b.generated_coins).sum())
+    );
+    assert_eq!(
+        staged_responses[2],
+        BCResponse::BlockHash(blocks[1].block_hash)
+    );
+    // INVARIANT: #[cfg] @ lib.rs asserts `usize == u64`
+    #[allow(clippy::cast_possible_truncation)]
+    let counts = output_counts
+        .iter()
+        .map(|(amount, count)| (*amount, *count as usize))
+        .collect();
+    assert_eq!(
+        staged_responses[6],
+        BCResponse::NumberOutputsWithAmount(counts)
+    );
+    let BCResponse::Outputs(staged_outputs) = &staged_responses[7] else {
+        panic!("{:#?}", staged_responses[7]);
+    };
+    for (amount, amount_indices) in &outputs {
+        assert_eq!(staged_outputs[amount].len(), amount_indices.len());
+    }
+    assert_eq!(staged_responses[8], BCResponse::KeyImagesSpent(true));
+
+    // Let the writer write the blocks.
+    TxRw::abort(tx_rw).unwrap();
+    drop(env_inner);
+    for response_channel in response_channels {
+        assert_eq!(response_channel.await.unwrap(), BCResponse::WriteBlockOk);
+    }
+
+    // The same requests now read from the database.
+    for (request, staged_response) in requests.into_iter().zip(staged_responses) {
+        let response = reader.clone().oneshot(request).await.unwrap();
+        assert_eq!(response, staged_response);
+    }
+}
+
+/// Assert the blocks staged above a block that fails to be written
+/// are failed without being written, and are no longer served.
+#[tokio::test]
+async fn staged_write_failure() {
+    let (reader, mut writer, env, _tempdir) = init_service();
+
+    let blocks = [block_v1_tx2, block_v9_tx3, block_v16_tx0, block_v9_tx3]
+        .into_iter()
+        .enumerate()
+        .map(|(i, block_fn)| {
+            let mut block = block_fn().clone();
+            block.height = i as u64;
+            block
+        })
+        .collect::<Vec<VerifiedBlockInformation>>();
+
+    for block in &blocks[..2] {
+        let request = BCWriteRequest::WriteBlock(block.clone());
+        let response = writer.ready().await.unwrap().call(request).await;
+        assert_eq!(response.unwrap(), BCResponse::WriteBlockOk);
+    }
+
+    // Remove the info of the top block, writing the next block requires it.
+    // The write transaction is held until the next blocks are staged.
+    let env_inner = env.env_inner();
+    let tx_rw = env_inner.tx_rw().unwrap();
+    env_inner
+        .open_tables_mut(&tx_rw)
+        .unwrap()
+        .block_infos_mut()
+        .delete(&1)
+        .unwrap();
+
+    let mut response_channels = Vec::new();
+    for block in &blocks[2..] {
+        let request = BCWriteRequest::WriteBlock(block.clone());
+        response_channels.push(writer.ready().await.unwrap().call(request));
+    }
+
+    let response = reader.clone().oneshot(BCReadRequest::ChainHeight).await;
+    assert_eq!(
+        response.unwrap(),
+        BCResponse::ChainHeight(4, blocks[3].block_hash)
+    );
+
+    TxRw::commit(tx_rw).unwrap();
+    drop(env_inner);
+
+    // The first block fails, the block above it was verified against it.
+    let mut response_channels = response_channels.into_iter();
+    let response = response_channels.next().unwrap().await;
+    assert!(matches!(response, Err(RuntimeError::KeyNotFound)));
+    let response = response_channels.next().unwrap().await;
+    assert!(matches!(response, Err(RuntimeError::Io(_))));
+
+    // Neither block is staged or written.
+    for height in 2..4 {
+        let response = reader
+            .clone()
+            .oneshot(BCReadRequest::BlockHash(height))
+            .await;
+        assert!(matches!(response, Err(RuntimeError::KeyNotFound)));
+    }
+}
+
+/// The amount of outputs with `amount` in `tables`.
+fn num_outputs(tables: &impl Tables, amount: Amount) -> u64 {
+    if amount == 0 {
+        tables.rct_outputs().len().unwrap()
+    } else {
+        match tables.num_outputs().get(&amount) {
+            Ok(count) => count,
+            Err(RuntimeError::KeyNotFound) => 0,
+            Err(e) => panic!("{e:?}"),
+        }
+    }
+}
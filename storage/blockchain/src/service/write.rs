@@ -6,7 +6,10 @@ use std::{
     task::{Context, Poll},
 };
 
-use futures::channel::oneshot;
+use futures::{channel::oneshot, ready};
+use rayon::iter::{IntoParallelRefIterator, ParallelIterator};
+use tokio::sync::{OwnedSemaphorePermit, Semaphore};
+use tokio_util::sync::PollSemaphore;
 
 use cuprate_database::{ConcreteEnv, Env, EnvInner, RuntimeError, TxRw};
 use cuprate_helper::asynch::InfallibleOneshotReceiver;
@@ -17,13 +20,33 @@ use cuprate_types::{
 
 use crate::{
     open_tables::OpenTables,
-    service::types::{ResponseReceiver, ResponseResult, ResponseSender},
+    ops::{block::PreparedBlock, tx::PreparedTx},
+    service::{
+        staging::StagingArea,
+        types::{ResponseReceiver, ResponseResult, ResponseSender},
+    },
+    tables::TablesMut,
 };
 
 //---------------------------------------------------------------------------------------------------- Constants
 /// Name of the writer thread.
 const WRITER_THREAD_NAME: &str = concat!(module_path!(), "::DatabaseWriter");
 
+/// Name of the stager thread.
+const STAGER_THREAD_NAME: &str = concat!(module_path!(), "::DatabaseStager");
+
+/// The maximum amount of requests the writer will handle within 1 write transaction.
+///
+/// See [`DatabaseWriter::handle_group`].
+const WRITE_GROUP_LIMIT: usize = 64;
+
+/// The maximum amount of blocks that can be staged, i.e. sent
+/// to the writer but not yet written, before callers must wait.
+///
+/// This is 2 write groups, such that the next group can be
+/// staged and verified while the current one is being written.
+const STAGING_LIMIT: usize = 2 * WRITE_GROUP_LIMIT;
+
 //---------------------------------------------------------------------------------------------------- DatabaseWriteHandle
 /// Write handle to the database.
 ///
@@ -36,30 +59,73 @@ const WRITER_THREAD_NAME: &str = concat!(module_path!(), "::DatabaseWriter");
 /// to receive the corresponding [`BCResponse`].
 #[derive(Debug)]
 pub struct DatabaseWriteHandle {
-    /// Sender channel to the database write thread-pool.
+    /// Sender channel to the database stager thread,
+    /// which forwards the requests to the writer thread.
+    ///
+    /// We provide the response channel for the writer.
+    pub(super) sender: crossbeam::channel::Sender<StageRequest>,
+
+    /// Counting semaphore asynchronous permit for staging blocks.
+    /// Each [`tower::Service::poll_ready`] will acquire a permit
+    /// before actually staging a block and sending it to the writer.
     ///
-    /// We provide the response channel for the thread-pool.
-    pub(super) sender: crossbeam::channel::Sender<(BCWriteRequest, ResponseSender)>,
+    /// This bounds the amount of staged blocks to [`STAGING_LIMIT`].
+    semaphore: PollSemaphore,
+
+    /// An owned permit.
+    /// This will be set to [`Some`] in `poll_ready()` when we successfully acquire
+    /// the permit, and will be [`Option::take()`]n after `tower::Service::call()` is called.
+    ///
+    /// The actual permit will be dropped _after_ the writer
+    /// has unstaged the request's block, see [`QueuedRequest`].
+    permit: Option<OwnedSemaphorePermit>,
+
+    /// Blocks that were sent to the writer, but not yet written.
+    staging: Arc<StagingArea>,
 }
 
 impl DatabaseWriteHandle {
-    /// Initialize the single `DatabaseWriter` thread.
+    /// Initialize the single `DatabaseStager` and `DatabaseWriter` threads.
+    ///
+    /// Blocks are staged in `staging` until they are written.
     #[cold]
     #[inline(never)] // Only called once.
-    pub(super) fn init(env: Arc<ConcreteEnv>) -> Self {
+    pub(super) fn init(env: Arc<ConcreteEnv>, staging: Arc<StagingArea>) -> Self {
         // Initialize `Request/Response` channels.
-        let (sender, receiver) = crossbeam::channel::unbounded();
+        let (sender, stager_receiver) = crossbeam::channel::unbounded();
+        let (stager_sender, writer_receiver) = crossbeam::channel::unbounded();
+
+        // Spawn the stager.
+        let stager = DatabaseStager {
+            receiver: stager_receiver,
+            sender: stager_sender,
+            env: Arc::clone(&env),
+            staging: Arc::clone(&staging),
+        };
+        std::thread::Builder::new()
+            .name(STAGER_THREAD_NAME.into())
+            .spawn(move || DatabaseStager::main(stager))
+            .unwrap();
 
         // Spawn the writer.
+        let writer = DatabaseWriter {
+            receiver: writer_receiver,
+            env,
+            staging: Arc::clone(&staging),
+        };
         std::thread::Builder::new()
             .name(WRITER_THREAD_NAME.into())
-            .spawn(move || {
-                let this = DatabaseWriter { receiver, env };
-                DatabaseWriter::main(this);
-            })
+            .spawn(move || DatabaseWriter::main(writer))
             .unwrap();
 
-        Self { sender }
+        let semaphore = PollSemaphore::new(Arc::new(Semaphore::new(STAGING_LIMIT)));
+
+        Self {
+            sender,
+            semaphore,
+            permit: None,
+            staging,
+        }
     }
 }
 
@@ -69,22 +135,144 @@ impl tower::Service<BCWriteRequest> for DatabaseWriteHandle {
     type Future = ResponseReceiver;
 
     #[inline]
-    fn poll_ready(&mut self, _: &mut Context<'_>) -> Poll<Result<(), Self::Error>> {
+    fn poll_ready(&mut self, cx: &mut Context<'_>) -> Poll<Result<(), Self::Error>> {
+        // Check if we already have a permit.
+        if self.permit.is_some() {
+            return Poll::Ready(Ok(()));
+        }
+
+        // Acquire a permit before returning `Ready`, this
+        // waits if the writer is [`STAGING_LIMIT`] blocks behind.
+        let permit =
+            ready!(self.semaphore.poll_acquire(cx)).expect("this semaphore is never closed");
+
+        self.permit = Some(permit);
         Poll::Ready(Ok(()))
     }
 
     #[inline]
     fn call(&mut self, request: BCWriteRequest) -> Self::Future {
+        let permit = self
+            .permit
+            .take()
+            .expect("poll_ready() should have acquire a permit before calling call()");
+
         // Response channel we `.await` on.
         let (response_sender, receiver) = oneshot::channel();
 
+        // Preparing and staging the block is left to the stager thread,
+        // readers wait for the reserved block to be staged, so it is
+        // still visible to any read sent after this function returns.
+        let staging_id = self.staging.reserve();
+
         // Send the write request.
-        self.sender.send((request, response_sender)).unwrap();
+        self.sender
+            .send(StageRequest {
+                request,
+                staging_id,
+                _permit: permit,
+                response_sender,
+            })
+            .unwrap();
 
         InfallibleOneshotReceiver::from(receiver)
     }
 }
 
+/// A request sent to the stager thread.
+pub(super) struct StageRequest {
+    /// The request.
+    request: BCWriteRequest,
+    /// The reserved staging ID of the request's block.
+    staging_id: u64,
+    /// The staging permit of the request, see [`QueuedRequest`].
+    _permit: OwnedSemaphorePermit,
+    /// The channel to send the response to.
+    response_sender: ResponseSender,
+}
+
+/// A staged request sent to the writer thread.
+pub(super) struct QueuedRequest {
+    /// The request.
+    request: BCWriteRequest,
+    /// The [`prepare_request`] output of `request`.
+    prepared: PreparedRequest,
+    /// The staging ID of the request's block.
+    staging_id: u64,
+    /// The staging permit of the request, dropped
+    /// along with this after the block is unstaged.
+    _permit: OwnedSemaphorePermit,
+    /// The channel to send the response to.
+    response_sender: ResponseSender,
+}
+
+//---------------------------------------------------------------------------------------------------- DatabaseStager
+/// The single stager thread.
+///
+/// This does the CPU-bound work of each request and stages its block,
+/// in the order the requests were sent, before sending it to the writer.
+/// This keeps that work (and the database read staging may need)
+/// off of the `async` caller's thread.
+struct DatabaseStager {
+    /// Receiver side of the [`DatabaseWriteHandle`] request channel.
+    receiver: crossbeam::channel::Receiver<StageRequest>,
+
+    /// Sender channel to the writer thread.
+    sender: crossbeam::channel::Sender<QueuedRequest>,
+
+    /// Access to the database.
+    env: Arc<ConcreteEnv>,
+
+    /// Blocks that were sent to the writer, but not yet written.
+    staging: Arc<StagingArea>,
+}
+
+impl DatabaseStager {
+    /// The `DatabaseStager`'s main function.
+    ///
+    /// This returns once the [`DatabaseWriteHandle`] is dropped,
+    /// which drops the writer's channel, shutting the writer down too.
+    #[cold]
+    #[inline(never)] // Only called once.
+    fn main(self) {
+        for StageRequest {
+            request,
+            staging_id,
+            _permit,
+            response_sender,
+        } in self.receiver
+        {
+            let prepared = prepare_request(&request);
+
+            // Make the block visible to readers before it is written.
+            //
+            // INVARIANT: this must happen before sending, the
+            // writer unstages the block once it is handled.
+            let staged = match (&request, &prepared) {
+                (BCWriteRequest::WriteBlock(block), PreparedRequest::WriteBlock(prepared)) => {
+                    self.staging.stage(&self.env, staging_id, block, prepared)
+                }
+            };
+
+            if let Err(e) = staged {
+                // The block was not staged, so it is not sent to the writer.
+                send_response(response_sender, Err(e));
+                continue;
+            }
+
+            self.sender
+                .send(QueuedRequest {
+                    request,
+                    prepared,
+                    staging_id,
+                    _permit,
+                    response_sender,
+                })
+                .unwrap();
+        }
+    }
+}
+
 //---------------------------------------------------------------------------------------------------- DatabaseWriter
 /// The single database writer thread.
 pub(super) struct DatabaseWriter {
@@ -93,10 +281,13 @@ pub(super) struct DatabaseWriter {
     /// Any caller can send some requests to this channel.
     /// They send them alongside another `Response` channel,
     /// which we will eventually send to.
-    receiver: crossbeam::channel::Receiver<(BCWriteRequest, ResponseSender)>,
+    receiver: crossbeam::channel::Receiver<QueuedRequest>,
 
     /// Access to the database.
     env: Arc<ConcreteEnv>,
+
+    /// Blocks that were sent to the writer, but not yet written.
+    staging: Arc<StagingArea>,
 }
 
 impl Drop for DatabaseWriter {
@@ -114,11 +305,12 @@ impl DatabaseWriter {
     #[inline(never)] // Only called once.
     fn main(self) {
         // 1. Hang on request channel
-        // 2. Map request to some database function
-        // 3. Execute that function, get the result
-        // 4. Return the result via channel
-        'main: loop {
-            let Ok((request, response_sender)) = self.receiver.recv() else {
+        // 2. Drain any other pending requests into a group
+        // 3. Map the group of requests to database functions within 1 transaction
+        // 4. Execute those functions, commit, get the results
+        // 5. Return the results via channel
+        loop {
+            let Ok(request) = self.receiver.recv() else {
                 // If this receive errors, it means that the channel is empty
                 // and disconnected, meaning the other side (all senders) have
                 // been dropped. This means "shutdown", and we return here to
@@ -130,107 +322,147 @@ impl DatabaseWriter {
                 return;
             };
 
-            /// How many times should we retry handling the request on resize errors?
-            ///
-            /// This is 1 on automatically resizing databases, meaning there is only 1 iteration.
-            const REQUEST_RETRY_LIMIT: usize = if ConcreteEnv::MANUAL_RESIZE { 3 } else { 1 };
-
-            // Map [`Request`]'s to specific database functions.
+            // Group commit.
             //
-            // Both will:
-            // 1. Map the request to a function
-            // 2. Call the function
-            // 3. (manual resize only) If resize is needed, resize and retry
-            // 4. (manual resize only) Redo step {1, 2}
-            // 5. Send the function's `Result` back to the requester
+            // Any requests that were queued up while we were handling the
+            // previous group get handled within the same write transaction,
+            // such that they only pay for 1 commit (and sync) together.
             //
-            // FIXME: there's probably a more elegant way
-            // to represent this retry logic with recursive
-            // functions instead of a loop.
-            'retry: for retry in 0..REQUEST_RETRY_LIMIT {
-                // FIXME: will there be more than 1 write request?
-                // this won't have to be an enum.
-                let response = match &request {
-                    BCWriteRequest::WriteBlock(block) => write_block(&self.env, block),
-                };
-
-                // If the database needs to resize, do so.
-                if ConcreteEnv::MANUAL_RESIZE && matches!(response, Err(RuntimeError::ResizeNeeded))
-                {
-                    // If this is the last iteration of the outer `for` loop and we
-                    // encounter a resize error _again_, it means something is wrong.
-                    assert_ne!(
-                        retry, REQUEST_RETRY_LIMIT,
-                        "database resize failed maximum of {REQUEST_RETRY_LIMIT} times"
-                    );
-
-                    // Resize the map, and retry the request handling loop.
-                    //
-                    // FIXME:
-                    // We could pass in custom resizes to account for
-                    // batches, i.e., we're about to add ~5GB of data,
-                    // add that much instead of the default 1GB.
-                    // <https://github.com/monero-project/monero/blob/059028a30a8ae9752338a7897329fe8012a310d5/src/blockchain_db/lmdb/db_lmdb.cpp#L665-L695>
-                    let old = self.env.current_map_size();
-                    let new = self.env.resize_map(None);
-
-                    // TODO: use tracing.
-                    println!("resizing database memory map, old: {old}B, new: {new}B");
-
-                    // Try handling the request again.
-                    continue 'retry;
-                }
+            // Note that this never waits for more requests to arrive,
+            // it only takes those that are already in the channel.
+            let mut group = Vec::with_capacity(1 + self.receiver.len());
+            group.push(request);
+            group.extend(self.receiver.try_iter().take(WRITE_GROUP_LIMIT - 1));
 
-                // Automatically resizing databases should not be returning a resize error.
-                #[cfg(debug_assertions)]
-                if !ConcreteEnv::MANUAL_RESIZE {
-                    assert!(
-                        !matches!(response, Err(RuntimeError::ResizeNeeded)),
-                        "auto-resizing database returned a ResizeNeeded error"
-                    );
-                }
+            self.handle_group(group);
+        }
+    }
 
-                // Send the response back, whether if it's an `Ok` or `Err`.
-                if let Err(e) = response_sender.send(response) {
-                    // TODO: use tracing.
-                    println!("database writer failed to send response: {e:?}");
+    /// Handle a group of requests, and send back each response.
+    ///
+    /// The responses are only sent after the shared write transaction is committed.
+    ///
+    /// # Atomicity
+    /// Each request is still atomic on its own; if any request within the group fails,
+    /// the shared transaction is aborted and the requests are all re-handled one-by-one,
+    /// each within their own transaction, i.e. exactly as if no grouping occurred.
+    ///
+    /// Each request is unstaged before its response is sent.
+    ///
+    /// # Failures
+    /// If a request fails, every block staged above it is dropped from the
+    /// [`StagingArea`], as they were verified against the failed block.
+    /// Requests that are no longer staged are not written, they are failed
+    /// with [`previous_block_failed`] instead.
+    #[inline]
+    fn handle_group(&self, group: Vec<QueuedRequest>) {
+        let group = group
+            .into_iter()
+            .filter_map(|queued| self.take_staged(queued))
+            .collect::<Vec<QueuedRequest>>();
+
+        // Single requests do not need the fallback path.
+        if group.len() > 1 {
+            let requests = group
+                .iter()
+                .map(|queued| (&queued.request, &queued.prepared));
+
+            if let Ok(responses) = self
+                .env
+                .retry_on_resize(|env| write_group(env, requests.clone()))
+            {
+                for (queued, response) in group.into_iter().zip(responses) {
+                    self.staging.unstage(queued.staging_id);
+                    send_response(queued.response_sender, Ok(response));
                 }
 
-                continue 'main;
+                return;
+            }
+
+            // A request in the group failed and the transaction was
+            // aborted, handle all of the requests separately instead.
+        }
+
+        for queued in group {
+            // A previous request in this group may have failed.
+            let Some(queued) = self.take_staged(queued) else {
+                continue;
+            };
+
+            let response = self.env.retry_on_resize(|env| {
+                write_group(env, std::iter::once((&queued.request, &queued.prepared))).map(
+                    |mut responses| {
+                        // INVARIANT: 1 request == 1 response.
+                        responses.pop().unwrap()
+                    },
+                )
+            });
+
+            if response.is_ok() {
+                self.staging.unstage(queued.staging_id);
+            } else {
+                self.staging.unstage_failed(queued.staging_id);
             }
 
-            // Above retry loop should either:
-            // - continue to the next ['main] loop or...
-            // - ...retry until panic
-            unreachable!();
+            send_response(queued.response_sender, response);
+        }
+    }
+
+    /// Return `queued` if its block is still staged, else fail it.
+    ///
+    /// A block is no longer staged if a block below it failed to be written.
+    #[inline]
+    fn take_staged(&self, queued: QueuedRequest) -> Option<QueuedRequest> {
+        if self.staging.is_staged(queued.staging_id) {
+            Some(queued)
+        } else {
+            send_response(queued.response_sender, Err(previous_block_failed()));
+            None
         }
     }
 }
 
-//---------------------------------------------------------------------------------------------------- Handler functions
-// These are the actual functions that do stuff according to the incoming [`Request`].
-//
-// Each function name is a 1-1 mapping (from CamelCase -> snake_case) to
-// the enum variant name, e.g: `BlockExtendedHeader` -> `block_extended_header`.
-//
-// Each function will return the [`Response`] that we
-// should send back to the caller in [`map_request()`].
+/// The error returned for requests whose block was staged
+/// above a block that failed to be written.
+fn previous_block_failed() -> RuntimeError {
+    RuntimeError::Io(std::io::Error::other(
+        "a previous block failed to be written",
+    ))
+}
 
-/// [`BCWriteRequest::WriteBlock`].
+/// Send a response back to the requester, whether if it's an `Ok` or `Err`.
 #[inline]
-fn write_block(env: &ConcreteEnv, block: &VerifiedBlockInformation) -> ResponseResult {
+fn send_response(response_sender: ResponseSender, response: ResponseResult) {
+    if let Err(e) = response_sender.send(response) {
+        // TODO: use tracing.
+        println!("database writer failed to send response: {e:?}");
+    }
+}
+
+/// Handle all `requests` (and their [`PreparedRequest`]) within a single write transaction.
+///
+/// Upon [`Ok`], the transaction has been committed and a response for each
+/// request is returned, in the same order as the requests were given.
+///
+/// Upon [`Err`], the transaction has been aborted, i.e. none of the requests took effect.
+fn write_group<'a>(
+    env: &ConcreteEnv,
+    requests: impl Iterator<Item = (&'a BCWriteRequest, &'a PreparedRequest)>,
+) -> Result<Vec<BCResponse>, RuntimeError> {
     let env_inner = env.env_inner();
     let tx_rw = env_inner.tx_rw()?;
 
     let result = {
         let mut tables_mut = env_inner.open_tables_mut(&tx_rw)?;
-        crate::ops::block::add_block(block, &mut tables_mut)
+        requests
+            .map(|(request, prepared)| map_request(&mut tables_mut, request, prepared))
+            .collect::<Result<Vec<BCResponse>, RuntimeError>>()
     };
 
     match result {
-        Ok(()) => {
+        Ok(responses) => {
             TxRw::commit(tx_rw)?;
-            Ok(BCResponse::WriteBlockOk)
+            Ok(responses)
         }
         Err(e) => {
             // INVARIANT: ensure database atomicity by aborting
@@ -241,3 +473,80 @@ fn write_block(env: &ConcreteEnv, block: &VerifiedBlockInformation) -> ResponseR
         }
     }
 }
+
+//---------------------------------------------------------------------------------------------------- Request Preparation
+/// The CPU-bound work of a [`BCWriteRequest`], done before the write transaction opens.
+///
+/// This is done by the [`DatabaseStager`], as it is also used to stage the request.
+///
+/// Each variant maps 1-1 to a [`BCWriteRequest`] variant.
+enum PreparedRequest {
+    /// [`BCWriteRequest::WriteBlock`].
+    WriteBlock(PreparedBlock),
+}
+
+/// Do the CPU-bound work of `request`.
+///
+/// This does not touch the database, the work within the request itself
+/// is done in parallel on the global `rayon` thread-pool, the stager
+/// thread waits for it.
+#[inline]
+fn prepare_request(request: &BCWriteRequest) -> PreparedRequest {
+    match request {
+        BCWriteRequest::WriteBlock(block) => {
+            let txs = block
+                .txs
+                .par_iter()
+                .map(|tx| PreparedTx::new(&tx.tx))
+                .collect();
+
+            PreparedRequest::WriteBlock(PreparedBlock::with_txs(block, txs))
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------- Request Mapping
+/// Map [`Request`]'s to specific database handler functions.
+///
+/// The basic structure is:
+/// 1. `Request` is mapped to a handler function
+/// 2. Handler function is called on the (already opened) tables
+/// 3. [`BCResponse`] is returned
+///
+/// Committing/aborting the transaction is the caller's responsibility.
+///
+/// `prepared` must be the [`prepare_request`] output of `request`.
+#[inline]
+fn map_request(
+    tables_mut: &mut impl TablesMut,
+    request: &BCWriteRequest,
+    prepared: &PreparedRequest,
+) -> ResponseResult {
+    // FIXME: will there be more than 1 write request?
+    // this won't have to be an enum.
+    match (request, prepared) {
+        (BCWriteRequest::WriteBlock(block), PreparedRequest::WriteBlock(prepared)) => {
+            write_block(tables_mut, block, prepared)
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------- Handler functions
+// These are the actual functions that do stuff according to the incoming [`Request`].
+//
+// Each function name is a 1-1 mapping (from CamelCase -> snake_case) to
+// the enum variant name, e.g: `BlockExtendedHeader` -> `block_extended_header`.
+//
+// Each function will return the [`Response`] that we
+// should send back to the caller in [`map_request()`].
+
+/// [`BCWriteRequest::WriteBlock`].
+#[inline]
+fn write_block(
+    tables_mut: &mut impl TablesMut,
+    block: &VerifiedBlockInformation,
+    prepared: &PreparedBlock,
+) -> ResponseResult {
+    crate::ops::block::add_prepared_block(block, prepared, tables_mut)?;
+    Ok(BCResponse::WriteBlockOk)
+}
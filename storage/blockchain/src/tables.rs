@@ -18,7 +18,7 @@
 //! For example, this is the object returned by [`OpenTables::open_tables`](crate::OpenTables::open_tables).
 
 //---------------------------------------------------------------------------------------------------- Import
-use cuprate_database::{DatabaseIter, DatabaseRo, DatabaseRw, Table};
+use cuprate_database::{DatabaseIter, DatabaseRo, DatabaseRw, Table, TableStats};
 
 use crate::types::{
     Amount, AmountIndex, AmountIndices, BlockBlob, BlockHash, BlockHeight, BlockInfo, KeyImage,
@@ -97,6 +97,13 @@ macro_rules! define_trait_tables {
             /// # Errors
             /// This returns errors on regular database errors.
             fn all_tables_empty(&self) -> Result<bool, cuprate_database::RuntimeError>;
+
+            /// This returns the name and [`TableStats`] of all tables,
+            /// in the order they are defined.
+            ///
+            /// # Errors
+            /// This returns errors on regular database errors.
+            fn all_tables_stats(&self) -> Result<Vec<(&'static str, TableStats)>, cuprate_database::RuntimeError>;
         }
 
         /// Object containing all opened [`Table`]s in read + iter mode.
@@ -189,6 +196,14 @@ macro_rules! define_trait_tables {
                 )*
                 Ok(true)
             }
+
+            fn all_tables_stats(&self) -> Result<Vec<(&'static str, TableStats)>, cuprate_database::RuntimeError> {
+                Ok(vec![
+                    $(
+                        (<$table as Table>::NAME, DatabaseRo::stats(&self.$index)?),
+                    )*
+                ])
+            }
         }
 
         // This is the same as the above
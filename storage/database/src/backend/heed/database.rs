@@ -7,6 +7,7 @@ use crate::{
     backend::heed::types::HeedDb,
     database::{DatabaseIter, DatabaseRo, DatabaseRw},
     error::RuntimeError,
+    stats::TableStats,
     table::Table,
 };
 
@@ -94,6 +95,25 @@ fn is_empty<T: Table>(
     Ok(db.is_empty(tx_ro)?)
 }
 
+/// Shared [`DatabaseRo::stats()`].
+#[inline]
+fn stats<T: Table>(
+    db: &HeedDb<T::Key, T::Value>,
+    tx_ro: &heed::RoTxn<'_>,
+) -> Result<TableStats, RuntimeError> {
+    // This is `mdb_stat()`.
+    let stat = db.stat(tx_ro)?;
+
+    Ok(TableStats {
+        entries: stat.entries as u64,
+        depth: stat.depth,
+        branch_pages: stat.branch_pages as u64,
+        leaf_pages: stat.leaf_pages as u64,
+        overflow_pages: Some(stat.overflow_pages as u64),
+        stored_bytes: None,
+    })
+}
+
 //---------------------------------------------------------------------------------------------------- DatabaseIter Impl
 impl<T: Table> DatabaseIter<T> for HeedTableRo<'_, T> {
     #[inline]
@@ -157,6 +177,11 @@ unsafe impl<T: Table> DatabaseRo<T> for HeedTableRo<'_, T> {
     fn is_empty(&self) -> Result<bool, RuntimeError> {
         is_empty::<T>(&self.db, self.tx_ro)
     }
+
+    #[inline]
+    fn stats(&self) -> Result<TableStats, RuntimeError> {
+        stats::<T>(&self.db, self.tx_ro)
+    }
 }
 
 //---------------------------------------------------------------------------------------------------- DatabaseRw Impl
@@ -187,6 +212,11 @@ unsafe impl<T: Table> DatabaseRo<T> for HeedTableRw<'_, '_, T> {
     fn is_empty(&self) -> Result<bool, RuntimeError> {
         is_empty::<T>(&self.db, &self.tx_rw.borrow())
     }
+
+    #[inline]
+    fn stats(&self) -> Result<TableStats, RuntimeError> {
+        stats::<T>(&self.db, &self.tx_rw.borrow())
+    }
 }
 
 impl<T: Table> DatabaseRw<T> for HeedTableRw<'_, '_, T> {
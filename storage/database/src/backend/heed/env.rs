@@ -21,6 +21,7 @@ use crate::{
     error::{InitError, RuntimeError},
     key::{Key, KeyCompare},
     resize::ResizeAlgorithm,
+    stats::EnvStats,
     table::Table,
 };
 
@@ -241,6 +242,33 @@ impl Env for ConcreteEnv {
     fn env_inner(&self) -> Self::EnvInner<'_> {
         self.env.read().unwrap()
     }
+
+    fn stats(&self) -> Result<EnvStats, RuntimeError> {
+        let env = self.env.read().unwrap();
+        let info = env.info();
+
+        // `heed` does not expose `mdb_env_stat()`, although
+        // all databases share the same page size, so use the
+        // main (unnamed) database's `mdb_stat()` instead.
+        let page_size = {
+            let tx_ro = env.read_txn()?;
+            let main_db = env
+                .open_database::<heed::types::Bytes, heed::types::Bytes>(&tx_ro, None)?
+                .ok_or(RuntimeError::TableNotFound)?;
+            u64::from(main_db.stat(&tx_ro)?.page_size)
+        };
+
+        // LMDB's page numbers start at 0.
+        let allocated_pages = info.last_page_number as u64 + 1;
+        let used_pages = env.non_free_pages_size()? / page_size;
+
+        Ok(EnvStats {
+            page_size,
+            allocated_pages,
+            free_pages: allocated_pages.saturating_sub(used_pages),
+            map_size: Some(info.map_size as u64),
+        })
+    }
 }
 
 //---------------------------------------------------------------------------------------------------- EnvInner Impl
@@ -3,7 +3,7 @@
 //---------------------------------------------------------------------------------------------------- Import
 use std::ops::RangeBounds;
 
-use redb::ReadableTable;
+use redb::{ReadableTable, ReadableTableMetadata};
 
 use crate::{
     backend::redb::{
@@ -12,6 +12,7 @@ use crate::{
     },
     database::{DatabaseIter, DatabaseRo, DatabaseRw},
     error::RuntimeError,
+    stats::TableStats,
     table::Table,
 };
 
@@ -63,6 +64,23 @@ fn is_empty<T: Table>(
     Ok(db.is_empty()?)
 }
 
+/// Shared [`DatabaseRo::stats()`].
+#[inline]
+fn stats<T: Table>(
+    db: &impl redb::ReadableTable<StorableRedb<T::Key>, StorableRedb<T::Value>>,
+) -> Result<TableStats, RuntimeError> {
+    let stats = db.stats()?;
+
+    Ok(TableStats {
+        entries: db.len()?,
+        depth: stats.tree_height(),
+        branch_pages: stats.branch_pages(),
+        leaf_pages: stats.leaf_pages(),
+        overflow_pages: None,
+        stored_bytes: Some(stats.stored_bytes()),
+    })
+}
+
 //---------------------------------------------------------------------------------------------------- DatabaseIter
 impl<T: Table + 'static> DatabaseIter<T> for RedbTableRo<T::Key, T::Value> {
     #[inline]
@@ -138,6 +156,11 @@ unsafe impl<T: Table + 'static> DatabaseRo<T> for RedbTableRo<T::Key, T::Value>
     fn is_empty(&self) -> Result<bool, RuntimeError> {
         is_empty::<T>(self)
     }
+
+    #[inline]
+    fn stats(&self) -> Result<TableStats, RuntimeError> {
+        stats::<T>(self)
+    }
 }
 
 //---------------------------------------------------------------------------------------------------- DatabaseRw
@@ -167,6 +190,11 @@ unsafe impl<T: Table + 'static> DatabaseRo<T> for RedbTableRw<'_, T::Key, T::Val
     fn is_empty(&self) -> Result<bool, RuntimeError> {
         is_empty::<T>(self)
     }
+
+    #[inline]
+    fn stats(&self) -> Result<TableStats, RuntimeError> {
+        stats::<T>(self)
+    }
 }
 
 impl<T: Table + 'static> DatabaseRw<T> for RedbTableRw<'_, T::Key, T::Value> {
@@ -7,6 +7,7 @@ use crate::{
     database::{DatabaseIter, DatabaseRo, DatabaseRw},
     env::{Env, EnvInner},
     error::{InitError, RuntimeError},
+    stats::EnvStats,
     table::Table,
     TxRw,
 };
@@ -115,6 +116,28 @@ impl Env for ConcreteEnv {
     fn env_inner(&self) -> Self::EnvInner<'_> {
         (&self.env, self.durability)
     }
+
+    fn stats(&self) -> Result<EnvStats, RuntimeError> {
+        // `redb`'s database statistics are only available
+        // on write transactions, so create one and abort it.
+        //
+        // `ReadTransaction` has no equivalent, this takes the write
+        // lock, see the locking behavior documented on `Env::stats`.
+        let tx_rw = self.env.begin_write()?;
+        let stats = tx_rw.stats()?;
+        TxRw::abort(tx_rw)?;
+
+        let page_size = stats.page_size() as u64;
+
+        Ok(EnvStats {
+            page_size,
+            allocated_pages: stats.allocated_pages(),
+            // `redb` does not track free pages directly,
+            // this is the closest equivalent.
+            free_pages: stats.fragmented_bytes() / page_size,
+            map_size: None,
+        })
+    }
 }
 
 //---------------------------------------------------------------------------------------------------- EnvInner Impl
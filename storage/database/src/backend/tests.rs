@@ -21,7 +21,7 @@ use crate::{
     resize::ResizeAlgorithm,
     tests::{tmp_concrete_env, TestTable},
     transaction::{TxRo, TxRw},
-    ConcreteEnv,
+    ConcreteEnv, RESIZE_RETRY_LIMIT,
 };
 
 //---------------------------------------------------------------------------------------------------- Tests
@@ -135,6 +135,39 @@ fn resize() {
     assert_eq!(new_size, old_size + page_size.get());
 }
 
+/// Test [`Env::retry_on_resize`] gives up after [`RESIZE_RETRY_LIMIT`] calls.
+#[test]
+fn retry_on_resize() {
+    let (env, _tempdir) = tmp_concrete_env();
+
+    // Successful calls are not retried.
+    let mut calls = 0;
+    let result = env.retry_on_resize(|_| {
+        calls += 1;
+        Ok(())
+    });
+    assert!(result.is_ok());
+    assert_eq!(calls, 1);
+
+    // This test is only valid for `Env`'s that need to resize manually.
+    if !ConcreteEnv::MANUAL_RESIZE {
+        return;
+    }
+
+    let old_size = env.current_map_size();
+
+    let mut calls = 0;
+    let result: Result<(), RuntimeError> = env.retry_on_resize(|_| {
+        calls += 1;
+        Err(RuntimeError::ResizeNeeded)
+    });
+    assert!(matches!(result, Err(RuntimeError::ResizeNeeded)));
+    assert_eq!(calls, RESIZE_RETRY_LIMIT);
+
+    // It resized before each retry.
+    assert!(env.current_map_size() > old_size);
+}
+
 /// Test that `Env`'s that don't manually resize.
 #[test]
 #[should_panic = "unreachable"]
@@ -402,3 +435,48 @@ fn tables_are_sorted() {
         table.delete(&key).unwrap();
     }
 }
+
+/// Test [`DatabaseRo::stats`] and [`Env::stats`].
+#[test]
+fn stats() {
+    let (env, _tempdir) = tmp_concrete_env();
+
+    /// How many `(key, value)` pairs will be inserted.
+    const N: u32 = 1_000;
+
+    {
+        let env_inner = env.env_inner();
+        let tx_rw = env_inner.tx_rw().unwrap();
+        let mut table = env_inner.open_db_rw::<TestTable>(&tx_rw).unwrap();
+
+        let stats = table.stats().unwrap();
+        assert_eq!(stats.entries, 0);
+
+        for key in 0..N {
+            table.put(&key, &u64::from(key)).unwrap();
+        }
+
+        // The writer sees its own changes.
+        let stats = table.stats().unwrap();
+        assert_eq!(stats.entries, u64::from(N));
+        assert_eq!(stats.entries, table.len().unwrap());
+        assert!(stats.depth > 0);
+        assert!(stats.leaf_pages > 0);
+
+        drop(table);
+        TxRw::commit(tx_rw).unwrap();
+    }
+
+    {
+        let env_inner = env.env_inner();
+        let tx_ro = env_inner.tx_ro().unwrap();
+        let table = env_inner.open_db_ro::<TestTable>(&tx_ro).unwrap();
+        assert_eq!(table.stats().unwrap().entries, u64::from(N));
+    }
+
+    let stats = env.stats().unwrap();
+    assert!(stats.page_size > 0);
+    assert!(stats.allocated_pages > 0);
+    assert!(stats.free_pages <= stats.allocated_pages);
+    assert!(stats.used_pages() > 0);
+}
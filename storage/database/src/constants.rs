@@ -19,6 +19,10 @@ TODO: instructions on:
 4. etc";
 
 //---------------------------------------------------------------------------------------------------- Misc
+/// How many times [`Env::retry_on_resize`](crate::Env::retry_on_resize)
+/// calls its function on databases that manually resize.
+pub const RESIZE_RETRY_LIMIT: usize = 3;
+
 /// Static string of the `crate` being used as the database backend.
 ///
 /// | Backend | Value |
@@ -3,7 +3,7 @@
 //---------------------------------------------------------------------------------------------------- Import
 use std::ops::RangeBounds;
 
-use crate::{error::RuntimeError, table::Table};
+use crate::{error::RuntimeError, stats::TableStats, table::Table};
 
 //---------------------------------------------------------------------------------------------------- DatabaseIter
 /// Generic post-fix documentation for `DatabaseIter` methods.
@@ -147,6 +147,12 @@ pub unsafe trait DatabaseRo<T: Table> {
     /// # Errors
     /// This can only return [`RuntimeError::Io`] on errors.
     fn is_empty(&self) -> Result<bool, RuntimeError>;
+
+    /// Returns statistics on the layout of the database, see [`TableStats`].
+    ///
+    /// # Errors
+    /// This can only return [`RuntimeError::Io`] on errors.
+    fn stats(&self) -> Result<TableStats, RuntimeError>;
 }
 
 //---------------------------------------------------------------------------------------------------- DatabaseRw
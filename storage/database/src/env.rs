@@ -5,9 +5,11 @@ use std::num::NonZeroUsize;
 
 use crate::{
     config::Config,
+    constants::RESIZE_RETRY_LIMIT,
     database::{DatabaseIter, DatabaseRo, DatabaseRw},
     error::{InitError, RuntimeError},
     resize::ResizeAlgorithm,
+    stats::EnvStats,
     table::Table,
     transaction::{TxRo, TxRw},
 };
@@ -137,6 +139,58 @@ pub trait Env: Sized {
         unreachable!()
     }
 
+    /// Call `f`, resizing the memory map and calling it
+    /// again if it returns [`RuntimeError::ResizeNeeded`].
+    ///
+    /// If [`Env::MANUAL_RESIZE`] is `true`, `f` is called at most
+    /// [`RESIZE_RETRY_LIMIT`] times, if it still returns
+    /// [`RuntimeError::ResizeNeeded`] then that is returned.
+    ///
+    /// Otherwise, `f` is called exactly once.
+    ///
+    /// `f` must abort any write transaction it created before returning an error.
+    ///
+    /// # Errors
+    /// This returns the last error `f` returned.
+    fn retry_on_resize<T>(
+        &self,
+        mut f: impl FnMut(&Self) -> Result<T, RuntimeError>,
+    ) -> Result<T, RuntimeError> {
+        let mut calls = 1;
+
+        loop {
+            let result = f(self);
+
+            if !Self::MANUAL_RESIZE {
+                // Automatically resizing databases should not be returning a resize error.
+                debug_assert!(
+                    !matches!(result, Err(RuntimeError::ResizeNeeded)),
+                    "auto-resizing database returned a ResizeNeeded error"
+                );
+                return result;
+            }
+
+            if calls == RESIZE_RETRY_LIMIT || !matches!(result, Err(RuntimeError::ResizeNeeded)) {
+                return result;
+            }
+
+            // Resize the map, and call `f` again.
+            //
+            // FIXME:
+            // We could pass in custom resizes to account for
+            // batches, i.e., we're about to add ~5GB of data,
+            // add that much instead of the default 1GB.
+            // <https://github.com/monero-project/monero/blob/059028a30a8ae9752338a7897329fe8012a310d5/src/blockchain_db/lmdb/db_lmdb.cpp#L665-L695>
+            let old = self.current_map_size();
+            let new = self.resize_map(None);
+
+            // TODO: use tracing.
+            println!("resizing database memory map, old: {old}B, new: {new}B");
+
+            calls += 1;
+        }
+    }
+
     /// Return the [`Env::EnvInner`].
     ///
     /// # Locking behavior
@@ -148,6 +202,23 @@ pub trait Env: Sized {
     /// [`Env::resize_map`]) will take a _write_ lock.
     fn env_inner(&self) -> Self::EnvInner<'_>;
 
+    /// Return statistics on the whole database environment, see [`EnvStats`].
+    ///
+    /// Statistics on individual tables can be retrieved
+    /// with [`DatabaseRo::stats`] on an opened table.
+    ///
+    /// # Locking behavior
+    /// When using the `redb` backend, this opens (and aborts) a _write_
+    /// transaction, as `redb` only exposes database statistics on those.
+    ///
+    /// This waits for any ongoing write transaction to finish, and blocks
+    /// writers while it runs, so this should not be called while the
+    /// database is being written to, e.g. periodically alongside a writer.
+    ///
+    /// # Errors
+    /// This will only return [`RuntimeError::Io`] on errors.
+    fn stats(&self) -> Result<EnvStats, RuntimeError>;
+
     //------------------------------------------------ Provided
     /// Return the amount of actual of bytes the database is taking up on disk.
     ///
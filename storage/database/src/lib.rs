@@ -112,6 +112,7 @@ pub mod config;
 mod constants;
 pub use constants::{
     DATABASE_BACKEND, DATABASE_CORRUPT_MSG, DATABASE_DATA_FILENAME, DATABASE_LOCK_FILENAME,
+    RESIZE_RETRY_LIMIT,
 };
 
 mod database;
@@ -128,6 +129,9 @@ pub mod resize;
 mod key;
 pub use key::{Key, KeyCompare};
 
+mod stats;
+pub use stats::{EnvStats, TableStats};
+
 mod storable;
 pub use storable::{Storable, StorableBytes, StorableStr, StorableVec};
 
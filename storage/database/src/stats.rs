@@ -0,0 +1,108 @@
+//! Database statistics; `struct TableStats`, `struct EnvStats`.
+
+//---------------------------------------------------------------------------------------------------- Import
+#[cfg(feature = "serde")]
+use serde::{Deserialize, Serialize};
+
+//---------------------------------------------------------------------------------------------------- TableStats
+/// Statistics on the layout of a single database table.
+///
+/// Created with [`DatabaseRo::stats`](crate::DatabaseRo::stats).
+///
+/// Fields that only exist in some backends are [`Option`]s,
+/// they are [`None`] on backends that do not report them.
+#[derive(Copy, Clone, Debug, Default, PartialEq, Eq, PartialOrd, Ord, Hash)]
+#[cfg_attr(feature = "serde", derive(Serialize, Deserialize))]
+pub struct TableStats {
+    /// The amount of `(key, value)` pairs in the table.
+    pub entries: u64,
+
+    /// The depth (height) of the table's B-tree.
+    pub depth: u32,
+
+    /// The amount of internal (non-leaf) pages.
+    pub branch_pages: u64,
+
+    /// The amount of leaf pages.
+    pub leaf_pages: u64,
+
+    /// The amount of overflow pages, used for values too large for a single page.
+    ///
+    /// This is only reported by `heed`.
+    pub overflow_pages: Option<u64>,
+
+    /// The amount of bytes taken up by the actual keys and values.
+    ///
+    /// This is only reported by `redb`.
+    pub stored_bytes: Option<u64>,
+}
+
+impl TableStats {
+    /// The total amount of pages the table uses.
+    ///
+    /// ```rust
+    /// # use cuprate_database::TableStats;
+    /// let stats = TableStats {
+    ///     branch_pages: 1,
+    ///     leaf_pages: 2,
+    ///     overflow_pages: Some(3),
+    ///     ..Default::default()
+    /// };
+    /// assert_eq!(stats.pages(), 6);
+    /// ```
+    #[inline]
+    pub const fn pages(&self) -> u64 {
+        let overflow_pages = match self.overflow_pages {
+            Some(pages) => pages,
+            None => 0,
+        };
+
+        self.branch_pages + self.leaf_pages + overflow_pages
+    }
+}
+
+//---------------------------------------------------------------------------------------------------- EnvStats
+/// Statistics on the whole database environment.
+///
+/// Created with [`Env::stats`](crate::Env::stats).
+#[derive(Copy, Clone, Debug, Default, PartialEq, Eq, PartialOrd, Ord, Hash)]
+#[cfg_attr(feature = "serde", derive(Serialize, Deserialize))]
+pub struct EnvStats {
+    /// The size of a database page in bytes.
+    pub page_size: u64,
+
+    /// The amount of pages allocated in the database file.
+    pub allocated_pages: u64,
+
+    /// The amount of allocated pages that are free to be reused.
+    pub free_pages: u64,
+
+    /// The size of the memory map in bytes.
+    ///
+    /// This is only reported by backends that [`Env::MANUAL_RESIZE`](crate::Env::MANUAL_RESIZE).
+    pub map_size: Option<u64>,
+}
+
+impl EnvStats {
+    /// The amount of allocated pages that are in use.
+    ///
+    /// ```rust
+    /// # use cuprate_database::EnvStats;
+    /// let stats = EnvStats {
+    ///     allocated_pages: 10,
+    ///     free_pages: 3,
+    ///     ..Default::default()
+    /// };
+    /// assert_eq!(stats.used_pages(), 7);
+    /// ```
+    #[inline]
+    pub const fn used_pages(&self) -> u64 {
+        self.allocated_pages.saturating_sub(self.free_pages)
+    }
+}
+
+//---------------------------------------------------------------------------------------------------- Tests
+#[cfg(test)]
+mod test {
+    // use super::*;
+}
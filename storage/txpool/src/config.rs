@@ -0,0 +1,206 @@
+//! Database configuration.
+//!
+//! This module contains the main [`Config`]uration struct
+//! for the database [`Env`](cuprate_database::Env)ironment,
+//! and txpool-specific configuration.
+//!
+//! The main constructor is the [`ConfigBuilder`].
+//!
+//! # Example
+//! ```rust
+//! use cuprate_txpool::{
+//!     cuprate_database::{Env, config::SyncMode},
+//!     config::ConfigBuilder,
+//! };
+//!
+//! # fn main() -> Result<(), Box<dyn std::error::Error>> {
+//! let tmp_dir = tempfile::tempdir()?;
+//! let db_dir = tmp_dir.path().to_owned();
+//!
+//! let config = ConfigBuilder::new()
+//!      // Use a custom database directory.
+//!     .db_directory(db_dir.into())
+//!     // Use the fastest sync mode.
+//!     .sync_mode(SyncMode::Fast)
+//!     // Build into `Config`
+//!     .build();
+//!
+//! // Start a database `service` using this configuration.
+//! let (reader_handle, _) = cuprate_txpool::service::init(config.clone())?;
+//! // It's using the config we provided.
+//! assert_eq!(reader_handle.env().config(), &config.db_config);
+//! # Ok(()) }
+//! ```
+
+//---------------------------------------------------------------------------------------------------- Import
+use std::{borrow::Cow, num::NonZeroUsize, path::Path};
+
+use cuprate_database::{config::SyncMode, resize::ResizeAlgorithm};
+use cuprate_helper::fs::cuprate_txpool_dir;
+
+//---------------------------------------------------------------------------------------------------- ConfigBuilder
+/// Builder for [`Config`].
+#[derive(Debug, Clone, PartialEq, PartialOrd)]
+pub struct ConfigBuilder {
+    /// The database directory, see [`ConfigBuilder::db_directory`].
+    db_directory: Option<Cow<'static, Path>>,
+
+    /// [`Config::db_config`].
+    db_config: cuprate_database::config::ConfigBuilder,
+}
+
+impl ConfigBuilder {
+    /// Create a new [`ConfigBuilder`].
+    ///
+    /// [`ConfigBuilder::build`] can be called immediately
+    /// after this function to use default values.
+    pub fn new() -> Self {
+        Self {
+            db_directory: None,
+            db_config: cuprate_database::config::ConfigBuilder::new(Cow::Borrowed(
+                cuprate_txpool_dir(),
+            )),
+        }
+    }
+
+    /// Build into a [`Config`].
+    ///
+    /// # Default values
+    /// If [`ConfigBuilder::db_directory`] was not called,
+    /// the default [`cuprate_txpool_dir`] will be used.
+    ///
+    /// For all other values, [`Default::default`] is used.
+    pub fn build(self) -> Config {
+        // INVARIANT: all PATH safety checks are done
+        // in `helper::fs`. No need to do them here.
+        let db_directory = self
+            .db_directory
+            .unwrap_or_else(|| Cow::Borrowed(cuprate_txpool_dir()));
+
+        let db_config = self.db_config.db_directory(db_directory).build();
+
+        Config { db_config }
+    }
+
+    /// Set a custom database directory (and file) [`Path`].
+    #[must_use]
+    pub fn db_directory(mut self, db_directory: Cow<'static, Path>) -> Self {
+        self.db_directory = Some(db_directory);
+        self
+    }
+
+    /// Calls [`cuprate_database::config::ConfigBuilder::sync_mode`].
+    #[must_use]
+    pub fn sync_mode(mut self, sync_mode: SyncMode) -> Self {
+        self.db_config = self.db_config.sync_mode(sync_mode);
+        self
+    }
+
+    /// Calls [`cuprate_database::config::ConfigBuilder::resize_algorithm`].
+    #[must_use]
+    pub fn resize_algorithm(mut self, resize_algorithm: ResizeAlgorithm) -> Self {
+        self.db_config = self.db_config.resize_algorithm(resize_algorithm);
+        self
+    }
+
+    /// Calls [`cuprate_database::config::ConfigBuilder::reader_threads`].
+    #[must_use]
+    pub fn reader_threads(mut self, reader_threads: NonZeroUsize) -> Self {
+        self.db_config = self.db_config.reader_threads(reader_threads);
+        self
+    }
+
+    /// Tune the [`ConfigBuilder`] for the highest performing,
+    /// but also most resource-intensive & maybe risky settings.
+    ///
+    /// Good default for testing, and resource-available machines.
+    #[must_use]
+    pub fn fast(mut self) -> Self {
+        self.db_config =
+            cuprate_database::config::ConfigBuilder::new(Cow::Borrowed(cuprate_txpool_dir()))
+                .fast();
+        self
+    }
+
+    /// Tune the [`ConfigBuilder`] for the lowest performing,
+    /// but also least resource-intensive settings.
+    ///
+    /// Good default for resource-limited machines, e.g. a cheap VPS.
+    #[must_use]
+    pub fn low_power(mut self) -> Self {
+        self.db_config =
+            cuprate_database::config::ConfigBuilder::new(Cow::Borrowed(cuprate_txpool_dir()))
+                .low_power();
+        self
+    }
+}
+
+impl Default for ConfigBuilder {
+    fn default() -> Self {
+        let db_directory = Cow::Borrowed(cuprate_txpool_dir());
+        Self {
+            db_directory: Some(db_directory.clone()),
+            db_config: cuprate_database::config::ConfigBuilder::new(db_directory),
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------- Config
+/// `cuprate_txpool` configuration.
+///
+/// This is a configuration built on-top of [`cuprate_database::config::Config`].
+///
+/// For construction, either use [`ConfigBuilder`] or [`Config::default`].
+#[derive(Debug, Clone, PartialEq, PartialOrd)]
+pub struct Config {
+    /// The database configuration.
+    ///
+    /// [`cuprate_database::config::Config::reader_threads`]
+    /// is also used as the `service` reader thread count.
+    pub db_config: cuprate_database::config::Config,
+}
+
+impl Config {
+    /// Create a new [`Config`] with sane default settings.
+    ///
+    /// The [`cuprate_database::config::Config::db_directory`]
+    /// will be set to [`cuprate_txpool_dir`].
+    ///
+    /// All other values will be [`Default::default`].
+    ///
+    /// Same as [`Config::default`].
+    ///
+    /// ```rust
+    /// use cuprate_database::{
+    ///     config::SyncMode,
+    ///     resize::ResizeAlgorithm,
+    ///     DATABASE_DATA_FILENAME,
+    /// };
+    /// use cuprate_helper::fs::*;
+    ///
+    /// use cuprate_txpool::config::*;
+    ///
+    /// let config = Config::new();
+    ///
+    /// assert_eq!(config.db_config.db_directory(), cuprate_txpool_dir());
+    /// assert!(config.db_config.db_file().starts_with(cuprate_txpool_dir()));
+    /// assert!(config.db_config.db_file().ends_with(DATABASE_DATA_FILENAME));
+    /// assert_eq!(config.db_config.sync_mode, SyncMode::default());
+    /// assert_eq!(config.db_config.resize_algorithm, ResizeAlgorithm::default());
+    /// ```
+    pub fn new() -> Self {
+        ConfigBuilder::default().build()
+    }
+}
+
+impl Default for Config {
+    /// Same as [`Config::new`].
+    ///
+    /// ```rust
+    /// # use cuprate_txpool::config::*;
+    /// assert_eq!(Config::default(), Config::new());
+    /// ```
+    fn default() -> Self {
+        Self::new()
+    }
+}
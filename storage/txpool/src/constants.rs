@@ -0,0 +1,29 @@
+//! General constants used throughout `cuprate-txpool`.
+
+//---------------------------------------------------------------------------------------------------- Import
+
+//---------------------------------------------------------------------------------------------------- Version
+/// Current major version of the database.
+///
+/// This is incremented by 1 when `cuprate_txpool`'s
+/// structure/schema/tables change.
+pub const DATABASE_VERSION: u64 = 0;
+
+//---------------------------------------------------------------------------------------------------- Error Messages
+/// Corrupt database error message.
+///
+/// The error message shown to end-users in panic
+/// messages if we think the database is corrupted.
+///
+/// This is meant to be user-friendly.
+pub const DATABASE_CORRUPT_MSG: &str = r"Cuprate has encountered a fatal error. The database may be corrupted.
+
+TODO: instructions on:
+1. What to do
+2. How to fix (re-sync, recover, etc)
+3. General advice for preventing corruption
+4. etc";
+
+//---------------------------------------------------------------------------------------------------- Tests
+#[cfg(test)]
+mod test {}
@@ -0,0 +1,370 @@
+//! Fee-rate ordered functions.
+//!
+//! These use the [`FeeRates`](crate::tables::FeeRates) table, which is sorted
+//! from the highest to the lowest fee-per-byte, so they only ever walk the
+//! start or end of the table instead of loading and sorting the whole pool.
+
+//---------------------------------------------------------------------------------------------------- Import
+use cuprate_database::{DatabaseIter, DatabaseRo, RuntimeError};
+
+use crate::{
+    ops::{macros::doc_error, tx::remove_transaction},
+    tables::{TablesIter, TablesMut},
+    types::{FeePerByte, TransactionHash, TransactionWeight, TxStateFlags},
+};
+
+//---------------------------------------------------------------------------------------------------- Types
+/// A transaction selected by [`block_template_transactions`].
+#[derive(Copy, Clone, Debug, PartialEq, Eq, Hash)]
+pub struct TemplateTransaction {
+    /// The transaction's hash.
+    pub tx_hash: TransactionHash,
+    /// The transaction's weight.
+    pub weight: TransactionWeight,
+    /// The transaction's total fee.
+    pub fee: u64,
+    /// The transaction's fee-per-byte.
+    pub fee_per_byte: FeePerByte,
+}
+
+/// A block template's transactions, i.e. a block without its miner transaction.
+#[derive(Clone, Debug, PartialEq, Eq, Hash)]
+pub struct BlockTemplate {
+    /// The transactions, sorted by their fee-per-byte (highest first).
+    pub txs: Vec<TemplateTransaction>,
+    /// The total weight of `txs`.
+    pub weight: TransactionWeight,
+    /// The total fee of `txs`.
+    pub fee: u64,
+    /// The serialized transaction hashes, i.e. the amount of transactions
+    /// as a varint followed by each hash in `txs`.
+    ///
+    /// This is the end of a block blob, directly after the miner transaction.
+    pub tx_hashes_blob: Vec<u8>,
+}
+
+impl BlockTemplate {
+    /// Create a [`BlockTemplate`] from `txs`.
+    ///
+    /// `txs` must be sorted by their fee-per-byte (highest first).
+    ///
+    /// ```rust
+    /// # use cuprate_txpool::ops::fee_rate::*;
+    /// let tx = TemplateTransaction {
+    ///     tx_hash: [1; 32],
+    ///     weight: 100,
+    ///     fee: 1_000,
+    ///     fee_per_byte: 10,
+    /// };
+    /// let template = BlockTemplate::new(vec![tx, tx]);
+    /// assert_eq!(template.weight, 200);
+    /// assert_eq!(template.fee, 2_000);
+    /// assert_eq!(template.tx_hashes_blob.len(), 1 + 2 * 32);
+    /// assert_eq!(template.tx_hashes_blob[0], 2);
+    /// ```
+    pub fn new(txs: Vec<TemplateTransaction>) -> Self {
+        let mut tx_hashes_blob = Vec::with_capacity(10 + txs.len() * 32);
+
+        let (len, len_bytes) = varint(txs.len());
+        tx_hashes_blob.extend_from_slice(&len[..len_bytes]);
+
+        for tx in &txs {
+            tx_hashes_blob.extend_from_slice(&tx.tx_hash);
+        }
+
+        Self {
+            weight: txs.iter().map(|tx| tx.weight).sum(),
+            fee: txs.iter().map(|tx| tx.fee).sum(),
+            txs,
+            tx_hashes_blob,
+        }
+    }
+
+    /// Add `tx` to the end of the template.
+    ///
+    /// `tx` must not have a higher fee-per-byte than the current last transaction.
+    ///
+    /// ```rust
+    /// # use cuprate_txpool::ops::fee_rate::*;
+    /// let txs = (0..200_u8)
+    ///     .map(|i| TemplateTransaction {
+    ///         tx_hash: [i; 32],
+    ///         weight: 100,
+    ///         fee: 1_000,
+    ///         fee_per_byte: 10,
+    ///     })
+    ///     .collect::<Vec<_>>();
+    ///
+    /// let mut template = BlockTemplate::new(txs[..100].to_vec());
+    /// for tx in &txs[100..] {
+    ///     template.push(*tx);
+    /// }
+    /// assert_eq!(template, BlockTemplate::new(txs.clone()));
+    ///
+    /// template.truncate(50);
+    /// assert_eq!(template, BlockTemplate::new(txs[..50].to_vec()));
+    /// ```
+    pub fn push(&mut self, tx: TemplateTransaction) {
+        let old_len_bytes = self.len_bytes();
+
+        self.weight += tx.weight;
+        self.fee += tx.fee;
+        self.tx_hashes_blob.extend_from_slice(&tx.tx_hash);
+        self.txs.push(tx);
+
+        self.write_len(old_len_bytes);
+    }
+
+    /// Keep only the first `len` transactions of the template.
+    ///
+    /// This does nothing if the template has `len` or less transactions.
+    pub fn truncate(&mut self, len: usize) {
+        if len >= self.txs.len() {
+            return;
+        }
+
+        let old_len_bytes = self.len_bytes();
+
+        for tx in &self.txs[len..] {
+            self.weight -= tx.weight;
+            self.fee -= tx.fee;
+        }
+        self.txs.truncate(len);
+        self.tx_hashes_blob.truncate(old_len_bytes + len * 32);
+
+        self.write_len(old_len_bytes);
+    }
+
+    /// The length of the varint at the start of `tx_hashes_blob`.
+    fn len_bytes(&self) -> usize {
+        self.tx_hashes_blob.len() - self.txs.len() * 32
+    }
+
+    /// Replace the varint at the start of `tx_hashes_blob`, which is
+    /// `old_len_bytes` long, with the current amount of transactions.
+    ///
+    /// The hashes are only moved if the varint's length changed.
+    fn write_len(&mut self, old_len_bytes: usize) {
+        let (len, len_bytes) = varint(self.txs.len());
+
+        if len_bytes == old_len_bytes {
+            self.tx_hashes_blob[..len_bytes].copy_from_slice(&len[..len_bytes]);
+        } else {
+            self.tx_hashes_blob
+                .splice(..old_len_bytes, len[..len_bytes].iter().copied());
+        }
+    }
+}
+
+/// Encode `n` as a Monero varint, 7 bits per byte, least significant first.
+///
+/// This returns the buffer and how many bytes of it are used.
+fn varint(mut n: usize) -> ([u8; 10], usize) {
+    let mut buf = [0; 10];
+    let mut i = 0;
+
+    while n >= 0x80 {
+        #[allow(clippy::cast_possible_truncation)]
+        let byte = (n as u8 & 0x7f) | 0x80;
+        buf[i] = byte;
+        n >>= 7;
+        i += 1;
+    }
+    #[allow(clippy::cast_possible_truncation)]
+    let byte = n as u8;
+    buf[i] = byte;
+
+    (buf, i + 1)
+}
+
+//---------------------------------------------------------------------------------------------------- Free functions
+/// Select the transactions to fill a block template with.
+///
+/// This walks the pool from the highest to the lowest fee-per-byte,
+/// selecting each transaction that still fits within `max_weight`.
+///
+/// Transactions in the Dandelion++ stem state are skipped.
+///
+/// The returned transactions are sorted by their fee-per-byte (highest first).
+#[doc = doc_error!()]
+#[inline]
+pub fn block_template_transactions(
+    max_weight: TransactionWeight,
+    tables: &impl TablesIter,
+) -> Result<Vec<TemplateTransaction>, RuntimeError> {
+    let mut remaining_weight = max_weight;
+    let mut txs = Vec::new();
+
+    for entry in tables.fee_rates_iter().iter()? {
+        // Nothing else can fit.
+        if remaining_weight == 0 {
+            break;
+        }
+
+        let (key, weight) = entry?;
+        if weight > remaining_weight {
+            continue;
+        }
+
+        let info = tables.transaction_infos().get(&key.tx_hash)?;
+        if info.flags.contains(TxStateFlags::STATE_STEM) {
+            continue;
+        }
+
+        remaining_weight -= weight;
+        txs.push(TemplateTransaction {
+            tx_hash: key.tx_hash,
+            weight,
+            fee: info.fee,
+            fee_per_byte: key.fee_per_byte(),
+        });
+    }
+
+    Ok(txs)
+}
+
+/// Remove the transactions with the lowest fee-per-byte from the pool,
+/// until at least `weight` worth of transactions have been removed.
+///
+/// This returns the hashes of the removed transactions,
+/// from the lowest to the highest fee-per-byte.
+///
+/// If the pool contains less than `weight`, all transactions are removed.
+#[doc = doc_error!()]
+#[inline]
+pub fn evict_lowest_fee_rate(
+    weight: TransactionWeight,
+    tables: &mut impl TablesMut,
+) -> Result<Vec<TransactionHash>, RuntimeError> {
+    let mut removed_weight = 0;
+    let mut removed = Vec::new();
+
+    while removed_weight < weight {
+        let (key, tx_weight) = match tables.fee_rates().last() {
+            Ok(last) => last,
+            // The pool is empty.
+            Err(RuntimeError::KeyNotFound) => break,
+            Err(e) => return Err(e),
+        };
+
+        remove_transaction(&key.tx_hash, tables)?;
+        removed_weight += tx_weight;
+        removed.push(key.tx_hash);
+    }
+
+    Ok(removed)
+}
+
+//---------------------------------------------------------------------------------------------------- Tests
+#[cfg(test)]
+mod test {
+    use pretty_assertions::assert_eq;
+
+    use cuprate_database::{DatabaseRw, Env, EnvInner, TxRw};
+    use cuprate_test_utils::data::{tx_v1_sig0, tx_v1_sig2, tx_v2_rct3};
+
+    use super::*;
+
+    use crate::{
+        open_tables::OpenTables,
+        ops::tx::{add_transaction, get_transaction_info},
+        tables::{Tables, TablesMut},
+        tests::{assert_all_tables_are_empty, tmp_concrete_env},
+    };
+
+    /// Tests the fee-rate ordering of templates and eviction.
+    #[test]
+    fn template_and_eviction() {
+        let (env, _tmp) = tmp_concrete_env();
+        let env_inner = env.env_inner();
+
+        let txs = [tx_v1_sig0(), tx_v1_sig2(), tx_v2_rct3()];
+
+        {
+            let tx_rw = env_inner.tx_rw().unwrap();
+            let mut tables = env_inner.open_tables_mut(&tx_rw).unwrap();
+            for tx in txs {
+                assert_eq!(add_transaction(tx, false, &mut tables).unwrap(), None);
+            }
+            drop(tables);
+            TxRw::commit(tx_rw).unwrap();
+        }
+
+        // The expected order, highest fee-per-byte first, ties sorted by hash.
+        let mut expected = txs.to_vec();
+        expected.sort_by_key(|tx| (std::cmp::Reverse(tx.fee / tx.tx_weight as u64), tx.tx_hash));
+
+        {
+            let tx_ro = env_inner.tx_ro().unwrap();
+            let tables = env_inner.open_tables(&tx_ro).unwrap();
+
+            // Everything fits.
+            let template = block_template_transactions(u64::MAX, &tables).unwrap();
+            let hashes = template.iter().map(|tx| tx.tx_hash).collect::<Vec<_>>();
+            let expected_hashes = expected.iter().map(|tx| tx.tx_hash).collect::<Vec<_>>();
+            assert_eq!(hashes, expected_hashes);
+
+            // Only the best transaction fits.
+            let best = expected[0];
+            let template = block_template_transactions(best.tx_weight as u64, &tables).unwrap();
+            assert_eq!(template.len(), 1);
+            assert_eq!(template[0].tx_hash, best.tx_hash);
+
+            // Nothing fits.
+            assert!(block_template_transactions(0, &tables).unwrap().is_empty());
+        }
+
+        // Stem transactions are not in templates.
+        {
+            let tx_rw = env_inner.tx_rw().unwrap();
+            let mut tables = env_inner.open_tables_mut(&tx_rw).unwrap();
+            let best = expected[0];
+            tables
+                .transaction_infos_mut()
+                .update(&best.tx_hash, |mut info| {
+                    info.flags.insert(TxStateFlags::STATE_STEM);
+                    Some(info)
+                })
+                .unwrap();
+            drop(tables);
+            TxRw::commit(tx_rw).unwrap();
+
+            let tx_ro = env_inner.tx_ro().unwrap();
+            let tables = env_inner.open_tables(&tx_ro).unwrap();
+            let template = block_template_transactions(u64::MAX, &tables).unwrap();
+            assert_eq!(template.len(), txs.len() - 1);
+            assert!(template.iter().all(|tx| tx.tx_hash != best.tx_hash));
+            assert!(
+                get_transaction_info(&best.tx_hash, tables.transaction_infos())
+                    .unwrap()
+                    .flags
+                    .contains(TxStateFlags::STATE_STEM)
+            );
+        }
+
+        // Evict the worst transaction, then everything else.
+        {
+            let tx_rw = env_inner.tx_rw().unwrap();
+            let mut tables = env_inner.open_tables_mut(&tx_rw).unwrap();
+
+            let worst = expected[expected.len() - 1];
+            assert_eq!(
+                evict_lowest_fee_rate(1, &mut tables).unwrap(),
+                vec![worst.tx_hash]
+            );
+
+            let rest = evict_lowest_fee_rate(u64::MAX, &mut tables).unwrap();
+            let expected_rest = expected[..expected.len() - 1]
+                .iter()
+                .rev()
+                .map(|tx| tx.tx_hash)
+                .collect::<Vec<_>>();
+            assert_eq!(rest, expected_rest);
+
+            drop(tables);
+            TxRw::commit(tx_rw).unwrap();
+        }
+
+        assert_all_tables_are_empty(&env);
+    }
+}
@@ -0,0 +1,93 @@
+//! Key image functions.
+
+//---------------------------------------------------------------------------------------------------- Import
+use monero_serai::transaction::Input;
+
+use cuprate_database::{DatabaseRo, DatabaseRw, RuntimeError};
+
+use crate::{
+    ops::macros::{doc_add_transaction_inner_invariant, doc_error},
+    tables::SpentKeyImages,
+    types::{KeyImage, TransactionHash},
+};
+
+//---------------------------------------------------------------------------------------------------- Key image functions
+/// Return an [`Iterator`] over the [`KeyImage`]s spent by `inputs`.
+#[inline]
+pub fn tx_key_images(inputs: &[Input]) -> impl Iterator<Item = KeyImage> + '_ {
+    inputs.iter().filter_map(|input| match input {
+        Input::ToKey { key_image, .. } => Some(key_image.compress().to_bytes()),
+        // Miner transactions are never in the pool.
+        Input::Gen(_) => None,
+    })
+}
+
+/// Add the [`KeyImage`]s spent by `inputs` to the spent set, marking them as spent by `tx_hash`.
+///
+/// If any of the key images is already spent by another transaction in the
+/// pool, this returns the hash of that transaction and _no_ key images are added.
+///
+#[doc = doc_add_transaction_inner_invariant!()]
+#[doc = doc_error!()]
+#[inline]
+pub fn add_tx_key_images(
+    inputs: &[Input],
+    tx_hash: &TransactionHash,
+    table_spent_key_images: &mut impl DatabaseRw<SpentKeyImages>,
+) -> Result<Option<TransactionHash>, RuntimeError> {
+    // Check all key images before writing any, so
+    // a double spend does not leave some of them behind.
+    for key_image in tx_key_images(inputs) {
+        match table_spent_key_images.get(&key_image) {
+            Ok(spender) => return Ok(Some(spender)),
+            Err(RuntimeError::KeyNotFound) => (),
+            Err(e) => return Err(e),
+        }
+    }
+
+    for key_image in tx_key_images(inputs) {
+        table_spent_key_images.put(&key_image, tx_hash)?;
+    }
+
+    Ok(None)
+}
+
+/// Remove the [`KeyImage`]s spent by `inputs` from the spent set.
+///
+#[doc = doc_add_transaction_inner_invariant!()]
+#[doc = doc_error!()]
+#[inline]
+pub fn remove_tx_key_images(
+    inputs: &[Input],
+    table_spent_key_images: &mut impl DatabaseRw<SpentKeyImages>,
+) -> Result<(), RuntimeError> {
+    for key_image in tx_key_images(inputs) {
+        table_spent_key_images.delete(&key_image)?;
+    }
+
+    Ok(())
+}
+
+/// Return the hash of the transaction in the pool spending `key_image`, if any.
+#[doc = doc_error!()]
+#[inline]
+pub fn key_image_spender(
+    key_image: &KeyImage,
+    table_spent_key_images: &impl DatabaseRo<SpentKeyImages>,
+) -> Result<Option<TransactionHash>, RuntimeError> {
+    match table_spent_key_images.get(key_image) {
+        Ok(tx_hash) => Ok(Some(tx_hash)),
+        Err(RuntimeError::KeyNotFound) => Ok(None),
+        Err(e) => Err(e),
+    }
+}
+
+/// Check if a [`KeyImage`] is spent by a transaction in the pool.
+#[doc = doc_error!()]
+#[inline]
+pub fn key_image_spent(
+    key_image: &KeyImage,
+    table_spent_key_images: &impl DatabaseRo<SpentKeyImages>,
+) -> Result<bool, RuntimeError> {
+    table_spent_key_images.contains(key_image)
+}
@@ -0,0 +1,84 @@
+//! Abstracted transaction pool database operations.
+//!
+//! This module contains many free functions that use the
+//! traits in this crate to generically call txpool-related
+//! database operations.
+//!
+//! # `impl Table`
+//! `ops/` functions take [`Tables`](crate::tables::Tables) and
+//! [`TablesMut`](crate::tables::TablesMut) directly - these are
+//! _already opened_ database tables.
+//!
+//! As such, the function puts the responsibility
+//! of transactions, tables, etc on the caller.
+//!
+//! # Atomicity
+//! As transactions are handled by the _caller_ of these functions,
+//! it is up to the caller to decide what happens if one them return
+//! an error.
+//!
+//! To maintain atomicity, transactions should be [`abort`](cuprate_database::TxRw::abort)ed
+//! if one of the functions failed.
+//!
+//! # Sub-functions
+//! Practically speaking, you should only be using these functions for mutation:
+//! - [`add_transaction`](tx::add_transaction)
+//! - [`remove_transaction`](tx::remove_transaction)
+//! - [`remove_key_image_spenders`](tx::remove_key_image_spenders)
+//! - [`evict_lowest_fee_rate`](fee_rate::evict_lowest_fee_rate)
+//!
+//! They call sub-functions such as [`add_tx_key_images()`](key_images::add_tx_key_images)
+//! which only modify _particular_ tables.
+//!
+//! # Example
+//! Simple usage of `ops`.
+//!
+//! ```rust
+//! use cuprate_test_utils::data::tx_v2_rct3;
+//! use cuprate_txpool::{
+//!     cuprate_database::{Env, EnvInner, TxRw},
+//!     config::ConfigBuilder,
+//!     OpenTables,
+//!     ops::{
+//!         fee_rate::block_template_transactions,
+//!         tx::{add_transaction, remove_transaction},
+//!     },
+//! };
+//!
+//! # fn main() -> Result<(), Box<dyn std::error::Error>> {
+//! // Create a configuration for the database environment.
+//! let tmp_dir = tempfile::tempdir()?;
+//! let db_dir = tmp_dir.path().to_owned();
+//! let config = ConfigBuilder::new()
+//!     .db_directory(db_dir.into())
+//!     .build();
+//!
+//! // Initialize the database environment.
+//! let env = cuprate_txpool::open(config)?;
+//!
+//! // Open up a transaction + tables for writing.
+//! let env_inner = env.env_inner();
+//! let tx_rw = env_inner.tx_rw()?;
+//! let mut tables = env_inner.open_tables_mut(&tx_rw)?;
+//!
+//! // Add a transaction to the pool, it is not a double spend.
+//! let tx = tx_v2_rct3();
+//! assert_eq!(add_transaction(tx, false, &mut tables)?, None);
+//!
+//! // Commit the data written.
+//! drop(tables);
+//! TxRw::commit(tx_rw)?;
+//!
+//! // Fill a block template.
+//! let tx_ro = env_inner.tx_ro()?;
+//! let tables = env_inner.open_tables(&tx_ro)?;
+//! let template = block_template_transactions(u64::MAX, &tables)?;
+//! assert_eq!(template[0].tx_hash, tx.tx_hash);
+//! # Ok(()) }
+//! ```
+
+pub mod fee_rate;
+pub mod key_images;
+pub mod tx;
+
+mod macros;
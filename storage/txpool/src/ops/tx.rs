@@ -0,0 +1,390 @@
+//! Transaction functions.
+
+//---------------------------------------------------------------------------------------------------- Import
+use bytemuck::TransparentWrapper;
+use monero_serai::transaction::Transaction;
+
+use cuprate_database::{DatabaseRo, DatabaseRw, RuntimeError, StorableVec};
+use cuprate_helper::time::current_unix_timestamp;
+use cuprate_types::VerifiedTransactionInformation;
+
+use crate::{
+    ops::{
+        key_images::{add_tx_key_images, key_image_spender, remove_tx_key_images},
+        macros::doc_error,
+    },
+    tables::{CachedVerificationStates, TablesMut, TransactionBlobs, TransactionInfos},
+    types::{
+        CachedVerificationState, FeeRateKey, KeyImage, RawCachedVerificationState, TransactionHash,
+        TransactionInfo, TxStateFlags,
+    },
+};
+
+//---------------------------------------------------------------------------------------------------- Add/Remove
+/// Add a [`Transaction`] (and related data) to the pool.
+///
+/// If `state_stem` is `true` the transaction is added in the
+/// Dandelion++ stem state, see [`TxStateFlags::STATE_STEM`].
+///
+/// The transaction starts out as [`CachedVerificationState::NotVerified`].
+///
+/// # Double spends
+/// If any of the transaction's key images is already spent by a transaction in the
+/// pool, nothing is added and `Ok(Some(tx_hash))` of that transaction is returned.
+///
+/// # Errors
+/// This returns [`RuntimeError::KeyExists`] if the transaction is already in the
+/// pool, or other `RuntimeError`'s on database errors.
+#[inline]
+pub fn add_transaction(
+    tx: &VerifiedTransactionInformation,
+    state_stem: bool,
+    tables: &mut impl TablesMut,
+) -> Result<Option<TransactionHash>, RuntimeError> {
+    if tables.transaction_infos().contains(&tx.tx_hash)? {
+        return Err(RuntimeError::KeyExists);
+    }
+
+    //------------------------------------------------------ Key Images
+    if let Some(double_spend) = add_tx_key_images(
+        &tx.tx.prefix.inputs,
+        &tx.tx_hash,
+        tables.spent_key_images_mut(),
+    )? {
+        return Ok(Some(double_spend));
+    }
+
+    //------------------------------------------------------ Transaction data
+    let mut flags = TxStateFlags::empty();
+    flags.set(TxStateFlags::STATE_STEM, state_stem);
+
+    let info = TransactionInfo {
+        fee: tx.fee,
+        weight: tx.tx_weight as u64,
+        received_at: current_unix_timestamp(),
+        flags,
+        _padding: [0; 7],
+    };
+
+    tables
+        .transaction_blobs_mut()
+        .put(&tx.tx_hash, StorableVec::wrap_ref(&tx.tx_blob))?;
+    tables.transaction_infos_mut().put(&tx.tx_hash, &info)?;
+    tables.cached_verification_states_mut().put(
+        &tx.tx_hash,
+        &RawCachedVerificationState::from(CachedVerificationState::NotVerified),
+    )?;
+
+    //------------------------------------------------------ Fee-rate index
+    tables.fee_rates_mut().put(
+        &FeeRateKey::new(info.fee_per_byte(), tx.tx_hash),
+        &info.weight,
+    )?;
+
+    Ok(None)
+}
+
+/// Remove a transaction (and related data) from the pool with its [`TransactionHash`].
+///
+/// This returns the removed transaction's [`TransactionInfo`].
+///
+#[doc = doc_error!()]
+#[inline]
+pub fn remove_transaction(
+    tx_hash: &TransactionHash,
+    tables: &mut impl TablesMut,
+) -> Result<TransactionInfo, RuntimeError> {
+    //------------------------------------------------------ Transaction data
+    let info = tables.transaction_infos_mut().take(tx_hash)?;
+    let tx_blob = tables.transaction_blobs_mut().take(tx_hash)?;
+    tables.cached_verification_states_mut().delete(tx_hash)?;
+
+    //------------------------------------------------------ Fee-rate index
+    tables
+        .fee_rates_mut()
+        .delete(&FeeRateKey::new(info.fee_per_byte(), *tx_hash))?;
+
+    //------------------------------------------------------ Key Images
+    let tx = Transaction::read(&mut tx_blob.0.as_slice())?;
+    remove_tx_key_images(&tx.prefix.inputs, tables.spent_key_images_mut())?;
+
+    Ok(info)
+}
+
+/// Remove all transactions in the pool spending any of `key_images`.
+///
+/// This is used when a block is added to the chain, with all the key images
+/// spent by the block; it removes both the mined transactions and the ones
+/// that became double spends, using the [`SpentKeyImages`](crate::tables::SpentKeyImages)
+/// table instead of scanning the pool.
+///
+/// This returns the hashes of the removed transactions.
+///
+#[doc = doc_error!()]
+#[inline]
+pub fn remove_key_image_spenders(
+    key_images: &[KeyImage],
+    tables: &mut impl TablesMut,
+) -> Result<Vec<TransactionHash>, RuntimeError> {
+    let mut removed = Vec::new();
+
+    for key_image in key_images {
+        // The spender may have been removed by a previous key image.
+        if let Some(tx_hash) = key_image_spender(key_image, tables.spent_key_images())? {
+            remove_transaction(&tx_hash, tables)?;
+            removed.push(tx_hash);
+        }
+    }
+
+    Ok(removed)
+}
+
+//---------------------------------------------------------------------------------------------------- State
+/// Move a transaction out of the Dandelion++ stem state, i.e. "fluff" it.
+///
+/// This is a no-op if the transaction is not in the stem state.
+///
+#[doc = doc_error!()]
+#[inline]
+pub fn promote(tx_hash: &TransactionHash, tables: &mut impl TablesMut) -> Result<(), RuntimeError> {
+    tables.transaction_infos_mut().update(tx_hash, |mut info| {
+        info.flags.remove(TxStateFlags::STATE_STEM);
+        Some(info)
+    })
+}
+
+/// Set the [`CachedVerificationState`] of a transaction.
+///
+#[doc = doc_error!()]
+#[inline]
+pub fn update_verification_state(
+    tx_hash: &TransactionHash,
+    state: CachedVerificationState,
+    tables: &mut impl TablesMut,
+) -> Result<(), RuntimeError> {
+    // Only update transactions that exist.
+    tables
+        .cached_verification_states_mut()
+        .update(tx_hash, |_| Some(RawCachedVerificationState::from(state)))
+}
+
+//---------------------------------------------------------------------------------------------------- `get_*`
+/// Retrieve a [`Transaction`] from the pool with its [`TransactionHash`].
+#[doc = doc_error!()]
+#[inline]
+pub fn get_transaction(
+    tx_hash: &TransactionHash,
+    table_transaction_blobs: &impl DatabaseRo<TransactionBlobs>,
+) -> Result<Transaction, RuntimeError> {
+    let tx_blob = table_transaction_blobs.get(tx_hash)?.0;
+    Ok(Transaction::read(&mut tx_blob.as_slice())?)
+}
+
+/// Retrieve the [`TransactionInfo`] of a transaction in the pool.
+#[doc = doc_error!()]
+#[inline]
+pub fn get_transaction_info(
+    tx_hash: &TransactionHash,
+    table_transaction_infos: &impl DatabaseRo<TransactionInfos>,
+) -> Result<TransactionInfo, RuntimeError> {
+    table_transaction_infos.get(tx_hash)
+}
+
+/// Retrieve the [`CachedVerificationState`] of a transaction in the pool.
+#[doc = doc_error!()]
+#[inline]
+pub fn get_verification_state(
+    tx_hash: &TransactionHash,
+    table_cached_verification_states: &impl DatabaseRo<CachedVerificationStates>,
+) -> Result<CachedVerificationState, RuntimeError> {
+    Ok(table_cached_verification_states.get(tx_hash)?.into())
+}
+
+/// Check if a transaction is in the pool.
+#[doc = doc_error!()]
+#[inline]
+pub fn transaction_exists(
+    tx_hash: &TransactionHash,
+    table_transaction_infos: &impl DatabaseRo<TransactionInfos>,
+) -> Result<bool, RuntimeError> {
+    table_transaction_infos.contains(tx_hash)
+}
+
+/// How many transactions are in the pool?
+#[doc = doc_error!()]
+#[inline]
+pub fn get_num_transactions(
+    table_transaction_infos: &impl DatabaseRo<TransactionInfos>,
+) -> Result<u64, RuntimeError> {
+    table_transaction_infos.len()
+}
+
+//---------------------------------------------------------------------------------------------------- Tests
+#[cfg(test)]
+mod test {
+    use pretty_assertions::assert_eq;
+
+    use cuprate_database::{Env, EnvInner, TxRw};
+    use cuprate_test_utils::data::{tx_v1_sig2, tx_v2_rct3};
+
+    use super::*;
+
+    use crate::{
+        open_tables::OpenTables,
+        ops::key_images::{key_image_spender, tx_key_images},
+        tables::{Tables, TablesMut},
+        tests::{assert_all_tables_are_empty, tmp_concrete_env, AssertTableLen},
+    };
+
+    /// Tests all above tx functions when only inputting `Transaction` data (no Block).
+    #[test]
+    fn all_tx_functions() {
+        let (env, _tmp) = tmp_concrete_env();
+        let env_inner = env.env_inner();
+        assert_all_tables_are_empty(&env);
+
+        let txs = [tx_v1_sig2(), tx_v2_rct3()];
+
+        // Add transactions.
+        {
+            let tx_rw = env_inner.tx_rw().unwrap();
+            let mut tables = env_inner.open_tables_mut(&tx_rw).unwrap();
+
+            for (i, tx) in txs.iter().enumerate() {
+                let state_stem = i == 0;
+                assert_eq!(add_transaction(tx, state_stem, &mut tables).unwrap(), None);
+
+                // Adding it again is an error.
+                assert!(matches!(
+                    add_transaction(tx, state_stem, &mut tables),
+                    Err(RuntimeError::KeyExists)
+                ));
+            }
+
+            drop(tables);
+            TxRw::commit(tx_rw).unwrap();
+        }
+
+        // Assert all reads are OK.
+        {
+            let tx_ro = env_inner.tx_ro().unwrap();
+            let tables = env_inner.open_tables(&tx_ro).unwrap();
+
+            let key_images = txs
+                .iter()
+                .map(|tx| tx_key_images(&tx.tx.prefix.inputs).count() as u64)
+                .sum();
+
+            AssertTableLen {
+                cached_verification_states: 2,
+                fee_rates: 2,
+                spent_key_images: key_images,
+                transaction_blobs: 2,
+                transaction_infos: 2,
+            }
+            .assert(&tables);
+
+            for (i, tx) in txs.iter().enumerate() {
+                assert!(transaction_exists(&tx.tx_hash, tables.transaction_infos()).unwrap());
+                assert_eq!(
+                    get_transaction(&tx.tx_hash, tables.transaction_blobs()).unwrap(),
+                    tx.tx
+                );
+                assert_eq!(
+                    get_verification_state(&tx.tx_hash, tables.cached_verification_states())
+                        .unwrap(),
+                    CachedVerificationState::NotVerified
+                );
+
+                let info = get_transaction_info(&tx.tx_hash, tables.transaction_infos()).unwrap();
+                assert_eq!(info.fee, tx.fee);
+                assert_eq!(info.weight, tx.tx_weight as u64);
+                assert_eq!(info.flags.contains(TxStateFlags::STATE_STEM), i == 0);
+
+                for key_image in tx_key_images(&tx.tx.prefix.inputs) {
+                    assert_eq!(
+                        key_image_spender(&key_image, tables.spent_key_images()).unwrap(),
+                        Some(tx.tx_hash)
+                    );
+                }
+            }
+
+            assert_eq!(get_num_transactions(tables.transaction_infos()).unwrap(), 2);
+        }
+
+        // Update state, remove transactions.
+        {
+            let tx_rw = env_inner.tx_rw().unwrap();
+            let mut tables = env_inner.open_tables_mut(&tx_rw).unwrap();
+
+            let state = CachedVerificationState::ValidAtHashAndHF {
+                block_hash: [1; 32],
+                hf: 16,
+            };
+            update_verification_state(&txs[0].tx_hash, state, &mut tables).unwrap();
+            assert_eq!(
+                get_verification_state(&txs[0].tx_hash, tables.cached_verification_states())
+                    .unwrap(),
+                state
+            );
+
+            promote(&txs[0].tx_hash, &mut tables).unwrap();
+            let info = get_transaction_info(&txs[0].tx_hash, tables.transaction_infos()).unwrap();
+            assert!(!info.flags.contains(TxStateFlags::STATE_STEM));
+
+            for tx in &txs {
+                let info = remove_transaction(&tx.tx_hash, &mut tables).unwrap();
+                assert_eq!(info.fee, tx.fee);
+
+                assert!(matches!(
+                    remove_transaction(&tx.tx_hash, &mut tables),
+                    Err(RuntimeError::KeyNotFound)
+                ));
+            }
+
+            drop(tables);
+            TxRw::commit(tx_rw).unwrap();
+        }
+
+        assert_all_tables_are_empty(&env);
+    }
+
+    /// Tests that transactions spending the same key image are rejected.
+    #[test]
+    fn double_spend() {
+        let (env, _tmp) = tmp_concrete_env();
+        let env_inner = env.env_inner();
+
+        let tx = tx_v2_rct3();
+        let mut double_spend = tx.clone();
+        double_spend.tx_hash = [0xFF; 32];
+
+        let tx_rw = env_inner.tx_rw().unwrap();
+        let mut tables = env_inner.open_tables_mut(&tx_rw).unwrap();
+
+        assert_eq!(add_transaction(tx, false, &mut tables).unwrap(), None);
+        assert_eq!(
+            add_transaction(&double_spend, false, &mut tables).unwrap(),
+            Some(tx.tx_hash)
+        );
+
+        // Nothing of the double spend was added.
+        assert!(!transaction_exists(&double_spend.tx_hash, tables.transaction_infos()).unwrap());
+        AssertTableLen {
+            cached_verification_states: 1,
+            fee_rates: 1,
+            spent_key_images: tx_key_images(&tx.tx.prefix.inputs).count() as u64,
+            transaction_blobs: 1,
+            transaction_infos: 1,
+        }
+        .assert(&tables);
+
+        // A block spending the key images removes the transaction.
+        let key_images = tx_key_images(&tx.tx.prefix.inputs).collect::<Vec<_>>();
+        assert_eq!(
+            remove_key_image_spenders(&key_images, &mut tables).unwrap(),
+            vec![tx.tx_hash]
+        );
+        assert!(tables.all_tables_empty().unwrap());
+    }
+}
@@ -0,0 +1,42 @@
+//! General free functions used (related to `cuprate_txpool::service`).
+
+//---------------------------------------------------------------------------------------------------- Import
+use std::sync::Arc;
+
+use cuprate_database::{InitError, RuntimeError};
+
+use crate::{
+    config::Config,
+    service::{memory::MemoryPool, DatabaseReadHandle, DatabaseWriteHandle},
+};
+
+//---------------------------------------------------------------------------------------------------- Init
+#[cold]
+#[inline(never)] // Only called once (?)
+/// Initialize a database & in-memory pool, and return a read/write handle to it.
+///
+/// All transactions in the database are loaded into memory.
+///
+/// Once the returned [`DatabaseWriteHandle`] is [`Drop::drop`]ed, the
+/// writer thread will write any remaining changes and exit automatically.
+///
+/// # Errors
+/// This will forward the error if [`crate::open`] failed,
+/// or if the database could not be loaded into memory.
+pub fn init(config: Config) -> Result<(DatabaseReadHandle, DatabaseWriteHandle), InitError> {
+    // Initialize the database itself.
+    let db = Arc::new(crate::open(config)?);
+
+    // Load the pool into memory.
+    let pool = match MemoryPool::load(&db) {
+        Ok(pool) => Arc::new(pool),
+        Err(RuntimeError::Io(e)) => return Err(InitError::Io(e)),
+        Err(e) => return Err(InitError::Unknown(Box::new(e))),
+    };
+
+    // Create the reader and spawn the writer.
+    let readers = DatabaseReadHandle::init(&db, Arc::clone(&pool));
+    let writer = DatabaseWriteHandle::init(db, pool);
+
+    Ok((readers, writer))
+}
@@ -0,0 +1,169 @@
+//! Txpool [`Request`](TxpoolReadRequest)/[`Response`](TxpoolResponse) definitions.
+//!
+//! These are the request/response types used by the
+//! [`DatabaseReadHandle`](super::DatabaseReadHandle) and
+//! [`DatabaseWriteHandle`](super::DatabaseWriteHandle).
+
+//---------------------------------------------------------------------------------------------------- Import
+use std::{collections::HashSet, sync::Arc};
+
+use cuprate_types::VerifiedTransactionInformation;
+
+use crate::{
+    ops::fee_rate::BlockTemplate,
+    types::{CachedVerificationState, KeyImage, TransactionHash, TransactionWeight},
+};
+
+//---------------------------------------------------------------------------------------------------- ReadRequest
+/// A read request to the txpool database.
+///
+/// This pairs with [`TxpoolResponse`], where each variant here
+/// matches in name with a [`TxpoolResponse`] variant. For example,
+/// the proper response for a [`TxpoolReadRequest::TxBlob`]
+/// would be a [`TxpoolResponse::TxBlob`].
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub enum TxpoolReadRequest {
+    /// Request the blob of a transaction in the pool.
+    ///
+    /// The input is the transaction's hash.
+    TxBlob(TransactionHash),
+
+    /// Request the cached verification state of a transaction in the pool.
+    ///
+    /// The input is the transaction's hash.
+    CachedVerificationState(TransactionHash),
+
+    /// Filter a set of transaction hashes, removing the ones already in the pool.
+    FilterKnownTxs(HashSet<TransactionHash>),
+
+    /// Check if any of the key images are spent by a transaction in the pool.
+    KeyImagesSpent(HashSet<KeyImage>),
+
+    /// Request the transactions to fill a block template with.
+    ///
+    /// The input is the maximum total weight of the transactions, i.e. the
+    /// block weight limit minus the weight reserved for the miner transaction.
+    BlockTemplateTxs(TransactionWeight),
+
+    /// Request the amount of transactions in the pool.
+    NumberOfTxs,
+}
+
+//---------------------------------------------------------------------------------------------------- WriteRequest
+/// A write request to the txpool database.
+///
+/// Each variant here matches in name with a [`TxpoolResponse`] variant,
+/// e.g. [`TxpoolWriteRequest::Promote`] => [`TxpoolResponse::PromoteOk`].
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub enum TxpoolWriteRequest {
+    /// Add a transaction to the pool.
+    AddTransaction {
+        /// The transaction to add.
+        tx: Box<VerifiedTransactionInformation>,
+        /// Add the transaction in the Dandelion++ stem state.
+        state_stem: bool,
+    },
+
+    /// Remove a transaction from the pool.
+    RemoveTransaction(TransactionHash),
+
+    /// Move a transaction out of the Dandelion++ stem state.
+    Promote(TransactionHash),
+
+    /// Set the cached verification state of a transaction.
+    UpdateVerificationState {
+        /// The transaction's hash.
+        tx_hash: TransactionHash,
+        /// The new verification state.
+        state: CachedVerificationState,
+    },
+
+    /// Remove the transactions with the lowest fee-per-byte,
+    /// until at least this much weight has been removed.
+    EvictLowestFeeRate(TransactionWeight),
+
+    /// Remove all transactions spending any of these key images.
+    ///
+    /// This should be sent with all the key images spent by each block added to
+    /// the chain, it removes both the mined transactions and their double spends.
+    RemoveKeyImageSpenders(Vec<KeyImage>),
+
+    /// Wait until all previous write requests have been persisted to the database.
+    ///
+    /// Write requests take effect in the in-memory pool immediately,
+    /// but are only written to the database _behind_ it, in batches.
+    ///
+    /// This returns an error if any previous write request failed to be
+    /// persisted, failed writes are retried with the following batches.
+    Flush,
+}
+
+//---------------------------------------------------------------------------------------------------- Response
+/// A response from the txpool database.
+///
+/// These are the data types returned when sending a `Request`.
+///
+/// This pairs with [`TxpoolReadRequest`] and [`TxpoolWriteRequest`],
+/// see those two for more info.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub enum TxpoolResponse {
+    //------------------------------------------------------ Reads
+    /// Response to [`TxpoolReadRequest::TxBlob`].
+    TxBlob {
+        /// The transaction's blob.
+        tx_blob: Vec<u8>,
+        /// If the transaction is in the Dandelion++ stem state.
+        state_stem: bool,
+    },
+
+    /// Response to [`TxpoolReadRequest::CachedVerificationState`].
+    CachedVerificationState(CachedVerificationState),
+
+    /// Response to [`TxpoolReadRequest::FilterKnownTxs`].
+    ///
+    /// The input set, with the hashes of transactions already in the pool removed.
+    FilterKnownTxs(HashSet<TransactionHash>),
+
+    /// Response to [`TxpoolReadRequest::KeyImagesSpent`].
+    ///
+    /// `true` if any of the key images are spent by a transaction in the pool.
+    KeyImagesSpent(bool),
+
+    /// Response to [`TxpoolReadRequest::BlockTemplateTxs`].
+    ///
+    /// The template is shared with (and cached for) later requests
+    /// until the pool changes.
+    BlockTemplateTxs(Arc<BlockTemplate>),
+
+    /// Response to [`TxpoolReadRequest::NumberOfTxs`].
+    NumberOfTxs(u64),
+
+    //------------------------------------------------------ Writes
+    /// Response to [`TxpoolWriteRequest::AddTransaction`].
+    ///
+    /// If the inner value is [`Some`], the transaction was not added as
+    /// it double spends the transaction in the pool with this hash.
+    AddTransaction(Option<TransactionHash>),
+
+    /// Response to [`TxpoolWriteRequest::RemoveTransaction`].
+    RemoveTransactionOk,
+
+    /// Response to [`TxpoolWriteRequest::Promote`].
+    PromoteOk,
+
+    /// Response to [`TxpoolWriteRequest::UpdateVerificationState`].
+    UpdateVerificationStateOk,
+
+    /// Response to [`TxpoolWriteRequest::EvictLowestFeeRate`].
+    ///
+    /// The hashes of the removed transactions, lowest fee-per-byte first.
+    EvictLowestFeeRate(Vec<TransactionHash>),
+
+    /// Response to [`TxpoolWriteRequest::RemoveKeyImageSpenders`].
+    ///
+    /// The hashes of the removed transactions.
+    RemoveKeyImageSpenders(Vec<TransactionHash>),
+
+    /// Response to [`TxpoolWriteRequest::Flush`].
+    FlushOk,
+}
@@ -0,0 +1,375 @@
+//! The in-memory transaction pool.
+//!
+//! The `service` serves all requests from a [`MemoryPool`],
+//! the database is only written to _behind_ it by the writer thread.
+//!
+//! # Concurrency
+//! The maps keyed by transaction hash and key image are sharded
+//! ([`DashMap`]), so readers only contend with the writer when
+//! they touch the same shard. The fee-rate index must be ordered,
+//! so it is a single [`BTreeMap`] behind a [`Mutex`], which is
+//! only held for the duration of each (short) index operation.
+//!
+//! There is only 1 writer (the [`DatabaseWriteHandle`](super::DatabaseWriteHandle)),
+//! so mutating functions never race each other, however, readers can observe
+//! a transaction that is half added/removed. Readers must handle a transaction
+//! being in the fee-rate index but not in the transaction map (and vice versa).
+//!
+//! # Lock order
+//! No lock is held while taking another, other than the [`TemplateBuilder`]'s
+//! build lock, which only template builds take, and hold while briefly taking
+//! the others, see [`TemplateBuilder`].
+//!
+//! Mutating functions update the [`TemplateBuilder`] _after_ the
+//! fee-rate index, so a template built in between is always redone.
+
+//---------------------------------------------------------------------------------------------------- Import
+use std::{
+    collections::{BTreeMap, HashSet},
+    ops::Bound,
+    sync::{Arc, Mutex},
+};
+
+use dashmap::{mapref::entry::Entry, DashMap};
+use monero_serai::transaction::Transaction;
+
+use cuprate_database::{ConcreteEnv, DatabaseIter, DatabaseRo, Env, EnvInner, RuntimeError};
+use cuprate_helper::time::current_unix_timestamp;
+use cuprate_types::VerifiedTransactionInformation;
+
+use crate::{
+    open_tables::OpenTables,
+    ops::{fee_rate::BlockTemplate, key_images::tx_key_images},
+    service::template::{TemplateBuilder, WALK_CHUNK_LEN},
+    tables::{Tables, TablesIter},
+    types::{
+        CachedVerificationState, FeeRateKey, KeyImage, TransactionHash, TransactionInfo,
+        TransactionWeight, TxStateFlags,
+    },
+};
+
+//---------------------------------------------------------------------------------------------------- PoolTransaction
+/// A transaction in the [`MemoryPool`].
+#[derive(Clone, Debug, PartialEq, Eq)]
+struct PoolTransaction {
+    /// The transaction's blob.
+    blob: Vec<u8>,
+    /// The transaction's info.
+    info: TransactionInfo,
+    /// The transaction's cached verification state.
+    state: CachedVerificationState,
+    /// The key images spent by the transaction.
+    key_images: Vec<KeyImage>,
+}
+
+//---------------------------------------------------------------------------------------------------- MemoryPool
+/// The in-memory transaction pool.
+///
+/// This is the source of truth for the `service`, each function here
+/// has a 1-1 equivalent in [`crate::ops`] that the writer thread uses
+/// to persist the same change to the database afterwards.
+#[derive(Debug, Default)]
+pub(super) struct MemoryPool {
+    /// All transactions in the pool.
+    txs: DashMap<TransactionHash, PoolTransaction>,
+    /// The key images spent by transactions in the pool,
+    /// and the hash of the transaction that spends them.
+    key_images: DashMap<KeyImage, TransactionHash>,
+    /// The fee-rate index, see [`FeeRates`](crate::tables::FeeRates).
+    fee_rates: Mutex<BTreeMap<FeeRateKey, TransactionWeight>>,
+    /// The last block template, and the changes since.
+    template: TemplateBuilder,
+}
+
+impl MemoryPool {
+    /// Load all transactions in the database into a new [`MemoryPool`].
+    ///
+    /// # Errors
+    /// This returns an error if the database could not be read,
+    /// or if a transaction blob in it could not be parsed.
+    #[cold]
+    #[inline(never)] // Only called once.
+    pub(super) fn load(env: &ConcreteEnv) -> Result<Self, RuntimeError> {
+        let env_inner = env.env_inner();
+        let tx_ro = env_inner.tx_ro()?;
+        let tables = env_inner.open_tables(&tx_ro)?;
+
+        let this = Self::default();
+        let mut fee_rates = this.fee_rates.lock().unwrap();
+
+        for entry in tables.transaction_infos_iter().iter()? {
+            let (tx_hash, info) = entry?;
+
+            let blob = tables.transaction_blobs().get(&tx_hash)?.0;
+            let state = tables.cached_verification_states().get(&tx_hash)?.into();
+            let tx = Transaction::read(&mut blob.as_slice())?;
+            let key_images = tx_key_images(&tx.prefix.inputs).collect::<Vec<_>>();
+
+            for key_image in &key_images {
+                this.key_images.insert(*key_image, tx_hash);
+            }
+            fee_rates.insert(FeeRateKey::new(info.fee_per_byte(), tx_hash), info.weight);
+            this.txs.insert(
+                tx_hash,
+                PoolTransaction {
+                    blob,
+                    info,
+                    state,
+                    key_images,
+                },
+            );
+        }
+
+        drop(fee_rates);
+        Ok(this)
+    }
+
+    //------------------------------------------------------ Writes
+    /// Add a transaction to the pool.
+    ///
+    /// See [`crate::ops::tx::add_transaction`].
+    pub(super) fn add_transaction(
+        &self,
+        tx: &VerifiedTransactionInformation,
+        state_stem: bool,
+    ) -> Result<Option<TransactionHash>, RuntimeError> {
+        let tx_hash = tx.tx_hash;
+
+        if self.txs.contains_key(&tx_hash) {
+            return Err(RuntimeError::KeyExists);
+        }
+
+        //------------------------------------------------------ Key Images
+        let key_images = tx_key_images(&tx.tx.prefix.inputs).collect::<Vec<_>>();
+        for (i, key_image) in key_images.iter().enumerate() {
+            match self.key_images.entry(*key_image) {
+                Entry::Vacant(entry) => {
+                    entry.insert(tx_hash);
+                }
+                Entry::Occupied(entry) => {
+                    let double_spend = *entry.get();
+                    // The shard lock must be released before removing below.
+                    drop(entry);
+
+                    for key_image in &key_images[..i] {
+                        self.key_images.remove(key_image);
+                    }
+
+                    return Ok(Some(double_spend));
+                }
+            }
+        }
+
+        //------------------------------------------------------ Transaction data
+        let mut flags = TxStateFlags::empty();
+        flags.set(TxStateFlags::STATE_STEM, state_stem);
+
+        let info = TransactionInfo {
+            fee: tx.fee,
+            weight: tx.tx_weight as u64,
+            received_at: current_unix_timestamp(),
+            flags,
+            _padding: [0; 7],
+        };
+
+        self.txs.insert(
+            tx_hash,
+            PoolTransaction {
+                blob: tx.tx_blob.clone(),
+                info,
+                state: CachedVerificationState::NotVerified,
+                key_images,
+            },
+        );
+
+        //------------------------------------------------------ Fee-rate index
+        let key = FeeRateKey::new(info.fee_per_byte(), tx_hash);
+        self.fee_rates.lock().unwrap().insert(key, info.weight);
+
+        if !state_stem {
+            self.template.candidate_added(key);
+        }
+
+        Ok(None)
+    }
+
+    /// Remove a transaction from the pool.
+    ///
+    /// See [`crate::ops::tx::remove_transaction`].
+    pub(super) fn remove_transaction(
+        &self,
+        tx_hash: &TransactionHash,
+    ) -> Result<TransactionInfo, RuntimeError> {
+        let (_, tx) = self.txs.remove(tx_hash).ok_or(RuntimeError::KeyNotFound)?;
+
+        let key = FeeRateKey::new(tx.info.fee_per_byte(), *tx_hash);
+        self.fee_rates.lock().unwrap().remove(&key);
+        self.template.candidate_removed(key);
+
+        for key_image in &tx.key_images {
+            self.key_images.remove(key_image);
+        }
+
+        Ok(tx.info)
+    }
+
+    /// Move a transaction out of the Dandelion++ stem state.
+    ///
+    /// See [`crate::ops::tx::promote`].
+    pub(super) fn promote(&self, tx_hash: &TransactionHash) -> Result<(), RuntimeError> {
+        let mut tx = self.txs.get_mut(tx_hash).ok_or(RuntimeError::KeyNotFound)?;
+        if !tx.info.flags.contains(TxStateFlags::STATE_STEM) {
+            return Ok(());
+        }
+        tx.info.flags.remove(TxStateFlags::STATE_STEM);
+
+        let key = FeeRateKey::new(tx.info.fee_per_byte(), *tx_hash);
+        // The shard lock must be released before the template lock is taken.
+        drop(tx);
+        self.template.candidate_added(key);
+
+        Ok(())
+    }
+
+    /// Set the [`CachedVerificationState`] of a transaction.
+    ///
+    /// See [`crate::ops::tx::update_verification_state`].
+    pub(super) fn update_verification_state(
+        &self,
+        tx_hash: &TransactionHash,
+        state: CachedVerificationState,
+    ) -> Result<(), RuntimeError> {
+        let mut tx = self.txs.get_mut(tx_hash).ok_or(RuntimeError::KeyNotFound)?;
+        tx.state = state;
+        Ok(())
+    }
+
+    /// Remove the transactions with the lowest fee-per-byte,
+    /// until at least `weight` worth of transactions have been removed.
+    ///
+    /// See [`crate::ops::fee_rate::evict_lowest_fee_rate`].
+    pub(super) fn evict_lowest_fee_rate(&self, weight: TransactionWeight) -> Vec<TransactionHash> {
+        let mut removed_weight = 0;
+        let mut removed = Vec::new();
+
+        while removed_weight < weight {
+            // The index lock must be released before removing the transaction.
+            let Some((key, tx_weight)) = self.fee_rates.lock().unwrap().pop_last() else {
+                // The pool is empty.
+                break;
+            };
+
+            // INVARIANT: there is only 1 writer, so the
+            // transaction is in the pool if it is in the index.
+            self.remove_transaction(&key.tx_hash).unwrap();
+            removed_weight += tx_weight;
+            removed.push(key.tx_hash);
+        }
+
+        removed
+    }
+
+    /// Remove all transactions spending any of `key_images`.
+    ///
+    /// See [`crate::ops::tx::remove_key_image_spenders`].
+    pub(super) fn remove_key_image_spenders(
+        &self,
+        key_images: &[KeyImage],
+    ) -> Vec<TransactionHash> {
+        let mut removed = Vec::new();
+
+        for key_image in key_images {
+            // The shard lock must be released before removing the transaction.
+            let Some(tx_hash) = self.key_images.get(key_image).map(|tx_hash| *tx_hash) else {
+                // Not spent in the pool, or the spender was removed by a previous key image.
+                continue;
+            };
+
+            // INVARIANT: there is only 1 writer, so the
+            // transaction is in the pool if it is in the index.
+            self.remove_transaction(&tx_hash).unwrap();
+            removed.push(tx_hash);
+        }
+
+        removed
+    }
+
+    //------------------------------------------------------ Reads
+    /// Return the blob of a transaction and if it is in the stem state.
+    pub(super) fn tx_blob(
+        &self,
+        tx_hash: &TransactionHash,
+    ) -> Result<(Vec<u8>, bool), RuntimeError> {
+        let tx = self.txs.get(tx_hash).ok_or(RuntimeError::KeyNotFound)?;
+        Ok((
+            tx.blob.clone(),
+            tx.info.flags.contains(TxStateFlags::STATE_STEM),
+        ))
+    }
+
+    /// Return the [`CachedVerificationState`] of a transaction.
+    pub(super) fn verification_state(
+        &self,
+        tx_hash: &TransactionHash,
+    ) -> Result<CachedVerificationState, RuntimeError> {
+        self.txs
+            .get(tx_hash)
+            .map(|tx| tx.state)
+            .ok_or(RuntimeError::KeyNotFound)
+    }
+
+    /// Remove the hashes of the transactions in the pool from `tx_hashes`.
+    pub(super) fn filter_known_txs(&self, tx_hashes: &mut HashSet<TransactionHash>) {
+        tx_hashes.retain(|tx_hash| !self.txs.contains_key(tx_hash));
+    }
+
+    /// Check if any of the `key_images` are spent by a transaction in the pool.
+    pub(super) fn key_images_spent<'a>(
+        &self,
+        mut key_images: impl Iterator<Item = &'a KeyImage>,
+    ) -> bool {
+        key_images.any(|key_image| self.key_images.contains_key(key_image))
+    }
+
+    /// Return the cached block template of at most `max_weight`,
+    /// if the pool did not change since it was built.
+    ///
+    /// This is cheap, unlike [`MemoryPool::block_template`].
+    pub(super) fn cached_block_template(
+        &self,
+        max_weight: TransactionWeight,
+    ) -> Option<Arc<BlockTemplate>> {
+        self.template.cached(max_weight)
+    }
+
+    /// Return a block template of at most `max_weight`.
+    ///
+    /// This is built incrementally from the last template, see [`TemplateBuilder`].
+    ///
+    /// The fee-rate index is only locked to copy out each
+    /// chunk of it, so this does not block the writer.
+    pub(super) fn block_template(&self, max_weight: TransactionWeight) -> Arc<BlockTemplate> {
+        self.template.get(
+            max_weight,
+            |after| {
+                self.fee_rates
+                    .lock()
+                    .unwrap()
+                    .range((after, Bound::Unbounded))
+                    .take(WALK_CHUNK_LEN)
+                    .map(|(key, weight)| (*key, *weight))
+                    .collect()
+            },
+            |key| {
+                // The transaction may be being added or removed.
+                let tx = self.txs.get(&key.tx_hash)?;
+                (!tx.info.flags.contains(TxStateFlags::STATE_STEM)).then_some(tx.info.fee)
+            },
+        )
+    }
+
+    /// How many transactions are in the pool?
+    pub(super) fn len(&self) -> usize {
+        self.txs.len()
+    }
+}
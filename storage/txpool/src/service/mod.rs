@@ -0,0 +1,117 @@
+//! [`tower::Service`] integeration + in-memory pool.
+//!
+//! ## `service`
+//! The `service` module implements the [`tower`] integration,
+//! along with the in-memory pool and database writer system.
+//!
+//! This mirrors `cuprate_blockchain::service`; it allows outside crates to
+//! communicate with it by sending [`TxpoolReadRequest`]s and
+//! [`TxpoolWriteRequest`]s and receiving [`TxpoolResponse`]s `async`hronously.
+//!
+//! The system is managed by this crate, and only requires [`init`] by the user.
+//!
+//! This module must be enabled with the `service` feature.
+//!
+//! ## Handles
+//! The 2 handles to the database are:
+//! - [`DatabaseReadHandle`]
+//! - [`DatabaseWriteHandle`]
+//!
+//! The 1st allows any caller to send [`TxpoolReadRequest`]s.
+//!
+//! The 2nd allows any caller to send [`TxpoolWriteRequest`]s.
+//!
+//! The `DatabaseReadHandle` can be shared as it is cheaply [`Clone`]able, however,
+//! the `DatabaseWriteHandle` cannot be cloned. There is only 1 place in Cuprate that
+//! writes, so it is passed there and used.
+//!
+//! ## Write-behind
+//! Pool churn is far higher than blockchain writes, so requests are not handled
+//! by the database. Instead, [`init`] loads the whole pool into memory and:
+//! - [`TxpoolReadRequest`]s are served from memory
+//! - [`TxpoolWriteRequest`]s are applied to memory, responded to, and then
+//!   journaled to the writer thread
+//!
+//! The writer thread collects journaled changes for a short interval and
+//! writes them all within 1 database transaction. Transactions that are
+//! added and removed within the same interval never touch the database.
+//!
+//! The database therefore lags slightly behind the pool, [`TxpoolWriteRequest::Flush`]
+//! can be used to wait until all prior writes are persisted (e.g. before shutdown).
+//!
+//! ## Shutdown
+//! Upon the [`DatabaseWriteHandle`] being dropped, the writer thread
+//! will write any remaining journaled changes, and then exit.
+//!
+//! # Example
+//! Simple usage of `service`.
+//!
+//! ```rust
+//! use tower::{Service, ServiceExt};
+//!
+//! use cuprate_test_utils::data::tx_v2_rct3;
+//!
+//! use cuprate_txpool::{
+//!     config::ConfigBuilder,
+//!     service::{TxpoolReadRequest, TxpoolResponse, TxpoolWriteRequest},
+//! };
+//!
+//! # #[tokio::main]
+//! # async fn main() -> Result<(), Box<dyn std::error::Error>> {
+//! // Create a configuration for the database environment.
+//! let tmp_dir = tempfile::tempdir()?;
+//! let db_dir = tmp_dir.path().to_owned();
+//! let config = ConfigBuilder::new()
+//!     .db_directory(db_dir.into())
+//!     .build();
+//!
+//! // Initialize the database thread-pool.
+//! let (mut read_handle, mut write_handle) = cuprate_txpool::service::init(config)?;
+//!
+//! // Add a transaction to the pool.
+//! let tx = tx_v2_rct3();
+//! let request = TxpoolWriteRequest::AddTransaction {
+//!     tx: Box::new(tx.clone()),
+//!     state_stem: false,
+//! };
+//! let response = write_handle.ready().await?.call(request).await?;
+//! assert_eq!(response, TxpoolResponse::AddTransaction(None));
+//!
+//! // Fill a block template.
+//! let request = TxpoolReadRequest::BlockTemplateTxs(u64::MAX);
+//! let response = read_handle.ready().await?.call(request).await?;
+//! let TxpoolResponse::BlockTemplateTxs(template) = response else {
+//!     unreachable!()
+//! };
+//! assert_eq!(template.txs[0].tx_hash, tx.tx_hash);
+//!
+//! // Wait until the transaction is written to the database.
+//! let response = write_handle.ready().await?.call(TxpoolWriteRequest::Flush).await?;
+//! assert_eq!(response, TxpoolResponse::FlushOk);
+//!
+//! // This causes the writer thread on the
+//! // other side of this handle to exit.
+//! drop(write_handle);
+//! # Ok(()) }
+//! ```
+
+mod interface;
+pub use interface::{TxpoolReadRequest, TxpoolResponse, TxpoolWriteRequest};
+
+mod read;
+pub use read::DatabaseReadHandle;
+
+mod write;
+pub use write::DatabaseWriteHandle;
+
+mod free;
+pub use free::init;
+
+mod memory;
+mod template;
+
+// Internal type aliases for `service`.
+mod types;
+
+#[cfg(test)]
+mod tests;
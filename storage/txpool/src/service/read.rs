@@ -0,0 +1,234 @@
+//! Database reader handle definitions and logic.
+
+//---------------------------------------------------------------------------------------------------- Import
+use std::{
+    collections::HashSet,
+    sync::Arc,
+    task::{Context, Poll},
+};
+
+use futures::channel::oneshot;
+
+use cuprate_database::{ConcreteEnv, RuntimeError};
+use cuprate_helper::asynch::InfallibleOneshotReceiver;
+
+use crate::{
+    service::{
+        interface::{TxpoolReadRequest, TxpoolResponse},
+        memory::MemoryPool,
+        types::{ResponseReceiver, ResponseResult, ResponseSender},
+    },
+    types::{KeyImage, TransactionHash, TransactionWeight},
+};
+
+//---------------------------------------------------------------------------------------------------- Constants
+/// Name of the template builder thread.
+const TEMPLATE_THREAD_NAME: &str = concat!(module_path!(), "::TemplateBuilder");
+
+//---------------------------------------------------------------------------------------------------- DatabaseReadHandle
+/// Read handle to the txpool.
+///
+/// This is cheaply [`Clone`]able handle that
+/// allows `async`hronously reading from the pool.
+///
+/// Calling [`tower::Service::call`] with a [`DatabaseReadHandle`] & [`TxpoolReadRequest`]
+/// will return an `async`hronous channel that can be `.await`ed upon
+/// to receive the corresponding [`TxpoolResponse`].
+///
+/// Requests are served from the in-memory pool, not the database, so unlike
+/// `cuprate_blockchain`'s reader there is no thread-pool; the request is handled
+/// within [`tower::Service::call`] and the returned channel is already filled.
+///
+/// The exception is [`TxpoolReadRequest::BlockTemplateTxs`] when the cached
+/// template is outdated, the template is then rebuilt by a separate thread.
+#[derive(Clone)]
+pub struct DatabaseReadHandle {
+    /// The in-memory pool.
+    pool: Arc<MemoryPool>,
+
+    /// Sender channel to the template builder thread.
+    templates: crossbeam::channel::Sender<(TransactionWeight, ResponseSender)>,
+
+    /// Access to the database.
+    env: Arc<ConcreteEnv>,
+}
+
+impl DatabaseReadHandle {
+    /// Initialize the `DatabaseReadHandle` reading from `pool`.
+    ///
+    /// Should be called _once_ per actual database.
+    #[cold]
+    #[inline(never)] // Only called once.
+    pub(super) fn init(env: &Arc<ConcreteEnv>, pool: Arc<MemoryPool>) -> Self {
+        let (templates, receiver) = crossbeam::channel::unbounded();
+
+        // Spawn the template builder, it exits once all handles are dropped.
+        let builder_pool = Arc::clone(&pool);
+        std::thread::Builder::new()
+            .name(TEMPLATE_THREAD_NAME.into())
+            .spawn(move || build_templates(&builder_pool, &receiver))
+            .unwrap();
+
+        Self {
+            pool,
+            templates,
+            env: Arc::clone(env),
+        }
+    }
+
+    /// Access to the actual database environment.
+    ///
+    /// # ⚠️ Warning
+    /// This function gives you access to the actual
+    /// underlying database connected to by `self`.
+    ///
+    /// I.e. it allows you to read/write data _directly_
+    /// instead of going through a request.
+    ///
+    /// The database lags behind the in-memory pool,
+    /// see [`TxpoolWriteRequest::Flush`](super::TxpoolWriteRequest::Flush).
+    ///
+    /// Be warned that using the database directly
+    /// in this manner has not been tested.
+    #[inline]
+    pub const fn env(&self) -> &Arc<ConcreteEnv> {
+        &self.env
+    }
+}
+
+impl tower::Service<TxpoolReadRequest> for DatabaseReadHandle {
+    type Response = TxpoolResponse;
+    type Error = RuntimeError;
+    type Future = ResponseReceiver;
+
+    #[inline]
+    fn poll_ready(&mut self, _: &mut Context<'_>) -> Poll<Result<(), Self::Error>> {
+        Poll::Ready(Ok(()))
+    }
+
+    #[inline]
+    fn call(&mut self, request: TxpoolReadRequest) -> Self::Future {
+        // Response channel we `.await` on.
+        let (response_sender, receiver) = oneshot::channel();
+
+        match request {
+            // Outdated templates are rebuilt off of the caller's thread,
+            // the builder responds once it is done.
+            TxpoolReadRequest::BlockTemplateTxs(max_weight) => {
+                match self.pool.cached_block_template(max_weight) {
+                    Some(template) => {
+                        // The receiver is alive, this cannot fail.
+                        drop(response_sender.send(Ok(TxpoolResponse::BlockTemplateTxs(template))));
+                    }
+                    None => self.templates.send((max_weight, response_sender)).unwrap(),
+                }
+            }
+            request => {
+                // The receiver is alive, this cannot fail.
+                drop(response_sender.send(map_request(&self.pool, request)));
+            }
+        }
+
+        InfallibleOneshotReceiver::from(receiver)
+    }
+}
+
+//---------------------------------------------------------------------------------------------------- Template builder
+/// The template builder thread's main function.
+///
+/// This builds a template for each request received,
+/// until all the [`DatabaseReadHandle`]s are dropped.
+#[cold]
+#[inline(never)] // Only called once.
+fn build_templates(
+    pool: &MemoryPool,
+    receiver: &crossbeam::channel::Receiver<(TransactionWeight, ResponseSender)>,
+) {
+    for (max_weight, response_sender) in receiver {
+        // The requester may have stopped waiting.
+        drop(response_sender.send(block_template_txs(pool, max_weight)));
+    }
+}
+
+//---------------------------------------------------------------------------------------------------- Request Mapping
+/// Map [`Request`]'s to specific pool handler functions.
+///
+/// This is the main entrance into all `Request` handler functions.
+/// The basic structure is:
+/// 1. `Request` is mapped to a handler function
+/// 2. Handler function is called
+/// 3. [`TxpoolResponse`] is returned
+fn map_request(
+    pool: &MemoryPool,          // Access to the pool
+    request: TxpoolReadRequest, // The request we must fulfill
+) -> ResponseResult {
+    use TxpoolReadRequest as R;
+
+    match request {
+        R::TxBlob(tx_hash) => tx_blob(pool, &tx_hash),
+        R::CachedVerificationState(tx_hash) => cached_verification_state(pool, &tx_hash),
+        R::FilterKnownTxs(tx_hashes) => filter_known_txs(pool, tx_hashes),
+        R::KeyImagesSpent(key_images) => key_images_spent(pool, &key_images),
+        R::BlockTemplateTxs(max_weight) => block_template_txs(pool, max_weight),
+        R::NumberOfTxs => number_of_txs(pool),
+    }
+}
+
+//---------------------------------------------------------------------------------------------------- Handler functions
+// These are the actual functions that do stuff according to the incoming [`Request`].
+//
+// Each function name is a 1-1 mapping (from CamelCase -> snake_case) to
+// the enum variant name, e.g: `TxBlob` -> `tx_blob`.
+//
+// Each function will return the [`Response`] that we
+// should send back to the caller in [`map_request()`].
+
+/// [`TxpoolReadRequest::TxBlob`].
+#[inline]
+fn tx_blob(pool: &MemoryPool, tx_hash: &TransactionHash) -> ResponseResult {
+    let (tx_blob, state_stem) = pool.tx_blob(tx_hash)?;
+    Ok(TxpoolResponse::TxBlob {
+        tx_blob,
+        state_stem,
+    })
+}
+
+/// [`TxpoolReadRequest::CachedVerificationState`].
+#[inline]
+fn cached_verification_state(pool: &MemoryPool, tx_hash: &TransactionHash) -> ResponseResult {
+    pool.verification_state(tx_hash)
+        .map(TxpoolResponse::CachedVerificationState)
+}
+
+/// [`TxpoolReadRequest::FilterKnownTxs`].
+#[inline]
+#[allow(clippy::unnecessary_wraps)] // signature expected by `map_request()`
+fn filter_known_txs(pool: &MemoryPool, mut tx_hashes: HashSet<TransactionHash>) -> ResponseResult {
+    pool.filter_known_txs(&mut tx_hashes);
+    Ok(TxpoolResponse::FilterKnownTxs(tx_hashes))
+}
+
+/// [`TxpoolReadRequest::KeyImagesSpent`].
+#[inline]
+#[allow(clippy::unnecessary_wraps)] // signature expected by `map_request()`
+fn key_images_spent(pool: &MemoryPool, key_images: &HashSet<KeyImage>) -> ResponseResult {
+    Ok(TxpoolResponse::KeyImagesSpent(
+        pool.key_images_spent(key_images.iter()),
+    ))
+}
+
+/// [`TxpoolReadRequest::BlockTemplateTxs`].
+#[inline]
+#[allow(clippy::unnecessary_wraps)] // signature expected by `map_request()`
+fn block_template_txs(pool: &MemoryPool, max_weight: TransactionWeight) -> ResponseResult {
+    Ok(TxpoolResponse::BlockTemplateTxs(
+        pool.block_template(max_weight),
+    ))
+}
+
+/// [`TxpoolReadRequest::NumberOfTxs`].
+#[inline]
+#[allow(clippy::unnecessary_wraps)] // signature expected by `map_request()`
+fn number_of_txs(pool: &MemoryPool) -> ResponseResult {
+    Ok(TxpoolResponse::NumberOfTxs(pool.len() as u64))
+}
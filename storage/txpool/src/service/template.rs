@@ -0,0 +1,342 @@
+//! Incremental block template building.
+//!
+//! Templates are filled greedily: walking the fee-rate index from the
+//! highest to the lowest fee-per-byte, each transaction that still fits
+//! is selected. Whether a transaction is selected only depends on the
+//! transactions _before_ it, so after the pool changes, only the part of
+//! the template after the first (highest fee-per-byte) change is redone.
+//!
+//! At the chain tip, most changes are low fee-per-byte transactions
+//! entering the pool, which only touch the end of the template (or
+//! nothing, once it is full), and mined transactions leaving it.
+
+//!
+//! # Locking
+//! A template is built without holding any lock the writer takes for longer
+//! than a single index operation; the fee-rate index is copied out in chunks
+//! of [`WALK_CHUNK_LEN`], and changes made during a build are recorded like any
+//! other, so the next build redoes them.
+
+//---------------------------------------------------------------------------------------------------- Import
+use std::{
+    ops::Bound,
+    sync::{Arc, Mutex},
+};
+
+use crate::{
+    ops::fee_rate::{BlockTemplate, TemplateTransaction},
+    types::{FeeRateKey, TransactionWeight},
+};
+
+//---------------------------------------------------------------------------------------------------- Constants
+/// How many fee-rate index entries are copied out at a time while building a template.
+pub(super) const WALK_CHUNK_LEN: usize = 256;
+
+//---------------------------------------------------------------------------------------------------- TemplateBuilder
+/// Caches the last built [`BlockTemplate`], and what changed since.
+#[derive(Debug, Default)]
+pub(super) struct TemplateBuilder {
+    /// Held for a whole build, so only 1 template is built at a time.
+    ///
+    /// This is never taken by the writer.
+    build: Mutex<()>,
+
+    /// The cached template and the changes since, only held briefly.
+    state: Mutex<TemplateState>,
+}
+
+/// The state of a [`TemplateBuilder`].
+#[derive(Debug, Default)]
+struct TemplateState {
+    /// The maximum weight `template` was built with.
+    max_weight: TransactionWeight,
+
+    /// The last built template, [`None`] if none was built
+    /// yet, or if it was taken by an ongoing build.
+    template: Option<Arc<BlockTemplate>>,
+
+    /// The highest fee-per-byte change since `template` was built.
+    ///
+    /// Everything in `template` before this key is still valid.
+    dirty_from: Option<FeeRateKey>,
+
+    /// Is a template being built?
+    building: bool,
+}
+
+impl TemplateState {
+    /// Mark everything after `key` (inclusive) as needing to be redone.
+    fn mark_dirty(&mut self, key: FeeRateKey) {
+        self.dirty_from = Some(self.dirty_from.map_or(key, |dirty| dirty.min(key)));
+    }
+}
+
+impl TemplateBuilder {
+    /// A template candidate was added (or left the stem state).
+    pub(super) fn candidate_added(&self, key: FeeRateKey) {
+        self.state.lock().unwrap().mark_dirty(key);
+    }
+
+    /// A template candidate was removed (or entered the stem state).
+    ///
+    /// Unselected candidates did not affect the template, so this is a no-op for them.
+    pub(super) fn candidate_removed(&self, key: FeeRateKey) {
+        let mut state = self.state.lock().unwrap();
+
+        // The template being built may have selected it.
+        if state.building {
+            state.mark_dirty(key);
+            return;
+        }
+
+        let Some(template) = &state.template else {
+            return;
+        };
+
+        let selected = template
+            .txs
+            .binary_search_by(|tx| template_key(tx).cmp(&key))
+            .is_ok();
+
+        if selected {
+            state.mark_dirty(key);
+        }
+    }
+
+    /// Return the cached template of at most `max_weight`, if nothing changed since it was built.
+    pub(super) fn cached(&self, max_weight: TransactionWeight) -> Option<Arc<BlockTemplate>> {
+        let state = self.state.lock().unwrap();
+
+        match &state.template {
+            Some(template) if state.max_weight == max_weight && state.dirty_from.is_none() => {
+                Some(Arc::clone(template))
+            }
+            _ => None,
+        }
+    }
+
+    /// Return a template of at most `max_weight`.
+    ///
+    /// `next_chunk` returns (up to [`WALK_CHUNK_LEN`]) fee-rate index
+    /// entries after the given bound, in the index's order.
+    ///
+    /// `candidate` returns the fee of a transaction, or [`None`] if
+    /// it cannot be in templates (stem state, or being removed).
+    ///
+    /// This returns the cached template if nothing changed, else the cached
+    /// template is updated in place, unless a previous response still holds it.
+    pub(super) fn get(
+        &self,
+        max_weight: TransactionWeight,
+        mut next_chunk: impl FnMut(Bound<FeeRateKey>) -> Vec<(FeeRateKey, TransactionWeight)>,
+        candidate: impl Fn(&FeeRateKey) -> Option<u64>,
+    ) -> Arc<BlockTemplate> {
+        let _build = self.build.lock().unwrap();
+
+        // Take the previous template, the changes since are
+        // recorded from here on for the next build.
+        let (template, dirty_from) = {
+            let mut state = self.state.lock().unwrap();
+
+            match &state.template {
+                Some(template) if state.max_weight == max_weight && state.dirty_from.is_none() => {
+                    return Arc::clone(template);
+                }
+                _ => (),
+            }
+
+            state.building = true;
+            let template = state.template.take();
+            let dirty_from = state.dirty_from.take();
+
+            // The weight changed, start over.
+            let template = template.filter(|_| state.max_weight == max_weight);
+
+            (template, dirty_from)
+        };
+
+        let mut template = template.unwrap_or_else(|| Arc::new(BlockTemplate::new(Vec::new())));
+        let template_mut = Arc::make_mut(&mut template);
+
+        // Keep the valid part of the previous template.
+        if let Some(dirty_from) = dirty_from {
+            let valid = template_mut
+                .txs
+                .partition_point(|tx| template_key(tx) < dirty_from);
+            template_mut.truncate(valid);
+        }
+
+        let mut remaining_weight = max_weight - template_mut.weight;
+        let mut after = template_mut
+            .txs
+            .last()
+            .map_or(Bound::Unbounded, |last| Bound::Excluded(template_key(last)));
+
+        // Nothing else can fit once `remaining_weight` is 0.
+        while remaining_weight > 0 {
+            let chunk = next_chunk(after);
+            let Some(&(last, _)) = chunk.last() else {
+                break;
+            };
+            after = Bound::Excluded(last);
+
+            for (key, weight) in chunk {
+                if weight > remaining_weight {
+                    continue;
+                }
+
+                let Some(fee) = candidate(&key) else {
+                    continue;
+                };
+
+                remaining_weight -= weight;
+                template_mut.push(TemplateTransaction {
+                    tx_hash: key.tx_hash,
+                    weight,
+                    fee,
+                    fee_per_byte: key.fee_per_byte(),
+                });
+            }
+        }
+
+        let mut state = self.state.lock().unwrap();
+        state.max_weight = max_weight;
+        state.template = Some(Arc::clone(&template));
+        state.building = false;
+
+        template
+    }
+}
+
+/// The [`FeeRateKey`] of a [`TemplateTransaction`].
+#[inline]
+fn template_key(tx: &TemplateTransaction) -> FeeRateKey {
+    FeeRateKey::new(tx.fee_per_byte, tx.tx_hash)
+}
+
+//---------------------------------------------------------------------------------------------------- Tests
+#[cfg(test)]
+mod test {
+    use std::collections::BTreeMap;
+
+    use pretty_assertions::assert_eq;
+
+    use super::*;
+
+    /// A fee-rate index of `(fee_per_byte, weight)` with distinct hashes.
+    fn fee_rates(txs: &[(u64, u64)]) -> BTreeMap<FeeRateKey, TransactionWeight> {
+        txs.iter()
+            .enumerate()
+            .map(|(i, &(fee_per_byte, weight))| {
+                #[allow(clippy::cast_possible_truncation)]
+                let tx_hash = [i as u8; 32];
+                (FeeRateKey::new(fee_per_byte, tx_hash), weight)
+            })
+            .collect()
+    }
+
+    /// Get a template from `builder` using `index`.
+    fn get(
+        builder: &TemplateBuilder,
+        max_weight: TransactionWeight,
+        index: &BTreeMap<FeeRateKey, TransactionWeight>,
+    ) -> Arc<BlockTemplate> {
+        builder.get(
+            max_weight,
+            |after| {
+                index
+                    .range((after, Bound::Unbounded))
+                    .take(WALK_CHUNK_LEN)
+                    .map(|(key, weight)| (*key, *weight))
+                    .collect()
+            },
+            |key| Some(key.fee_per_byte() * index[key]),
+        )
+    }
+
+    /// A template built from scratch.
+    fn fresh(
+        max_weight: TransactionWeight,
+        index: &BTreeMap<FeeRateKey, TransactionWeight>,
+    ) -> Arc<BlockTemplate> {
+        get(&TemplateBuilder::default(), max_weight, index)
+    }
+
+    /// Incrementally built templates equal templates built from scratch.
+    #[test]
+    fn incremental_matches_fresh() {
+        let mut index = fee_rates(&[(50, 10), (40, 30), (30, 20), (20, 5), (10, 40)]);
+
+        let builder = TemplateBuilder::default();
+        let max_weight = 50;
+
+        let template = get(&builder, max_weight, &index);
+        assert_eq!(template, fresh(max_weight, &index));
+        assert_eq!(template.weight, 45);
+
+        // Nothing changed, the same template is returned.
+        assert!(Arc::ptr_eq(&template, &get(&builder, max_weight, &index)));
+        assert!(Arc::ptr_eq(&template, &builder.cached(max_weight).unwrap()));
+        drop(template);
+
+        // A high fee-per-byte transaction pushes others out.
+        let key = FeeRateKey::new(45, [100; 32]);
+        index.insert(key, 25);
+        builder.candidate_added(key);
+        assert!(builder.cached(max_weight).is_none());
+        let template = get(&builder, max_weight, &index);
+        assert_eq!(template, fresh(max_weight, &index));
+
+        // A selected transaction is mined.
+        let key = FeeRateKey::new(50, [0; 32]);
+        index.remove(&key);
+        builder.candidate_removed(key);
+        let template = get(&builder, max_weight, &index);
+        assert_eq!(template, fresh(max_weight, &index));
+
+        // An unselected transaction leaving does not change the template.
+        let key = *index.keys().last().unwrap();
+        index.remove(&key);
+        builder.candidate_removed(key);
+        assert!(builder.state.lock().unwrap().dirty_from.is_none());
+
+        // A different weight starts over.
+        let template = get(&builder, 100, &index);
+        assert_eq!(template, fresh(100, &index));
+    }
+
+    /// Templates spanning many chunks of the index equal
+    /// templates built from scratch after each change.
+    #[test]
+    fn many_chunks() {
+        let txs = (0..600)
+            .map(|i| (1_000 - i, 1 + i % 7))
+            .collect::<Vec<(u64, u64)>>();
+        let mut index = txs
+            .iter()
+            .enumerate()
+            .map(|(i, &(fee_per_byte, weight))| {
+                let mut tx_hash = [0; 32];
+                tx_hash[..8].copy_from_slice(&(i as u64).to_le_bytes());
+                (FeeRateKey::new(fee_per_byte, tx_hash), weight)
+            })
+            .collect::<BTreeMap<FeeRateKey, TransactionWeight>>();
+
+        let builder = TemplateBuilder::default();
+        let max_weight = 1_500;
+
+        let template = get(&builder, max_weight, &index);
+        assert_eq!(template, fresh(max_weight, &index));
+        assert!(template.txs.len() > WALK_CHUNK_LEN);
+
+        // Remove selected transactions from the middle of the template.
+        for key in template.txs[200..210].iter().map(template_key) {
+            index.remove(&key);
+            builder.candidate_removed(key);
+        }
+        drop(template);
+
+        let template = get(&builder, max_weight, &index);
+        assert_eq!(template, fresh(max_weight, &index));
+    }
+}
@@ -0,0 +1,383 @@
+//! `crate::service` tests.
+//!
+//! This module contains general tests for the `service` implementation.
+
+//---------------------------------------------------------------------------------------------------- Use
+use std::{borrow::Cow, collections::HashSet};
+
+use pretty_assertions::assert_eq;
+use tower::{Service, ServiceExt};
+
+use cuprate_test_utils::data::{tx_v1_sig2, tx_v2_rct3};
+use cuprate_types::VerifiedTransactionInformation;
+
+use cuprate_database::{Env, EnvInner};
+
+use crate::{
+    config::ConfigBuilder,
+    open_tables::OpenTables,
+    ops::{key_images::tx_key_images, tx},
+    service::{
+        init,
+        memory::MemoryPool,
+        write::{write_entries, JournalEntry},
+        DatabaseReadHandle, DatabaseWriteHandle, TxpoolReadRequest, TxpoolResponse,
+        TxpoolWriteRequest,
+    },
+    tables::Tables,
+    tests::{assert_all_tables_are_empty, tmp_concrete_env, AssertTableLen},
+    types::CachedVerificationState,
+};
+
+//---------------------------------------------------------------------------------------------------- Helper functions
+/// Initialize the `service`.
+fn init_service() -> (DatabaseReadHandle, DatabaseWriteHandle, tempfile::TempDir) {
+    let tempdir = tempfile::tempdir().unwrap();
+    let config = ConfigBuilder::new()
+        .db_directory(Cow::Owned(tempdir.path().into()))
+        .low_power()
+        .build();
+    let (reader, writer) = init(config).unwrap();
+    (reader, writer, tempdir)
+}
+
+/// Send `request` to `service` and return the response.
+async fn call<S, R>(service: &mut S, request: R) -> TxpoolResponse
+where
+    S: Service<R, Response = TxpoolResponse>,
+    S::Error: std::fmt::Debug,
+{
+    service.ready().await.unwrap().call(request).await.unwrap()
+}
+
+//---------------------------------------------------------------------------------------------------- Tests
+/// Simply `init()` the service and then drop it.
+///
+/// If this test fails, something is very wrong.
+#[test]
+fn init_drop() {
+    let (_reader, _writer, _tempdir) = init_service();
+}
+
+/// Add, read, update, then evict transactions through the service.
+#[tokio::test]
+async fn add_read_evict() {
+    let (mut reader, mut writer, _tempdir) = init_service();
+
+    let txs = [tx_v1_sig2(), tx_v2_rct3()];
+
+    //----------------------------------------------------------------------- Write requests
+    for tx in txs {
+        let request = TxpoolWriteRequest::AddTransaction {
+            tx: Box::new(tx.clone()),
+            state_stem: true,
+        };
+        assert_eq!(
+            call(&mut writer, request).await,
+            TxpoolResponse::AddTransaction(None)
+        );
+    }
+
+    let tx = txs[0];
+    assert_eq!(
+        call(&mut writer, TxpoolWriteRequest::Promote(tx.tx_hash)).await,
+        TxpoolResponse::PromoteOk
+    );
+
+    let state = CachedVerificationState::ValidAtHashAndHF {
+        block_hash: [1; 32],
+        hf: 16,
+    };
+    let request = TxpoolWriteRequest::UpdateVerificationState {
+        tx_hash: tx.tx_hash,
+        state,
+    };
+    assert_eq!(
+        call(&mut writer, request).await,
+        TxpoolResponse::UpdateVerificationStateOk
+    );
+
+    //----------------------------------------------------------------------- Read requests
+    assert_eq!(
+        call(&mut reader, TxpoolReadRequest::NumberOfTxs).await,
+        TxpoolResponse::NumberOfTxs(txs.len() as u64)
+    );
+
+    assert_eq!(
+        call(&mut reader, TxpoolReadRequest::TxBlob(tx.tx_hash)).await,
+        TxpoolResponse::TxBlob {
+            tx_blob: tx.tx_blob.clone(),
+            state_stem: false,
+        }
+    );
+
+    assert_eq!(
+        call(
+            &mut reader,
+            TxpoolReadRequest::CachedVerificationState(tx.tx_hash)
+        )
+        .await,
+        TxpoolResponse::CachedVerificationState(state)
+    );
+
+    let unknown = [2; 32];
+    let request = TxpoolReadRequest::FilterKnownTxs(HashSet::from([tx.tx_hash, unknown]));
+    assert_eq!(
+        call(&mut reader, request).await,
+        TxpoolResponse::FilterKnownTxs(HashSet::from([unknown]))
+    );
+
+    // Only the promoted transaction can be in a template.
+    let TxpoolResponse::BlockTemplateTxs(template) =
+        call(&mut reader, TxpoolReadRequest::BlockTemplateTxs(u64::MAX)).await
+    else {
+        panic!("wrong response");
+    };
+    assert_eq!(template.txs.len(), 1);
+    assert_eq!(template.txs[0].tx_hash, tx.tx_hash);
+
+    // Promoting the other transaction updates the template.
+    assert_eq!(
+        call(&mut writer, TxpoolWriteRequest::Promote(txs[1].tx_hash)).await,
+        TxpoolResponse::PromoteOk
+    );
+    let TxpoolResponse::BlockTemplateTxs(template) =
+        call(&mut reader, TxpoolReadRequest::BlockTemplateTxs(u64::MAX)).await
+    else {
+        panic!("wrong response");
+    };
+    assert_eq!(template.txs.len(), txs.len());
+
+    //----------------------------------------------------------------------- Eviction
+    let TxpoolResponse::EvictLowestFeeRate(evicted) = call(
+        &mut writer,
+        TxpoolWriteRequest::EvictLowestFeeRate(u64::MAX),
+    )
+    .await
+    else {
+        panic!("wrong response");
+    };
+    assert_eq!(evicted.len(), txs.len());
+
+    assert_eq!(
+        call(&mut reader, TxpoolReadRequest::NumberOfTxs).await,
+        TxpoolResponse::NumberOfTxs(0)
+    );
+
+    // Nothing was ever written to the database, the
+    // transactions were added and removed in 1 batch.
+    assert_eq!(
+        call(&mut writer, TxpoolWriteRequest::Flush).await,
+        TxpoolResponse::FlushOk
+    );
+    assert_all_tables_are_empty(reader.env());
+}
+
+/// Adding a block removes the mined transactions and their double spends.
+#[tokio::test]
+async fn remove_key_image_spenders() {
+    let (mut reader, mut writer, _tempdir) = init_service();
+
+    let tx = tx_v2_rct3();
+    let mut double_spend = tx.clone();
+    double_spend.tx_hash = [0xFF; 32];
+
+    let request = TxpoolWriteRequest::AddTransaction {
+        tx: Box::new(tx.clone()),
+        state_stem: false,
+    };
+    assert_eq!(
+        call(&mut writer, request).await,
+        TxpoolResponse::AddTransaction(None)
+    );
+
+    // The double spend is detected with the key image index.
+    let request = TxpoolWriteRequest::AddTransaction {
+        tx: Box::new(double_spend),
+        state_stem: false,
+    };
+    assert_eq!(
+        call(&mut writer, request).await,
+        TxpoolResponse::AddTransaction(Some(tx.tx_hash))
+    );
+
+    let key_images = tx_key_images(&tx.tx.prefix.inputs).collect::<Vec<_>>();
+    let request = TxpoolReadRequest::KeyImagesSpent(key_images.iter().copied().collect());
+    assert_eq!(
+        call(&mut reader, request).await,
+        TxpoolResponse::KeyImagesSpent(true)
+    );
+
+    // A block spending the key images arrives.
+    let request = TxpoolWriteRequest::RemoveKeyImageSpenders(key_images);
+    assert_eq!(
+        call(&mut writer, request).await,
+        TxpoolResponse::RemoveKeyImageSpenders(vec![tx.tx_hash])
+    );
+    assert_eq!(
+        call(&mut reader, TxpoolReadRequest::NumberOfTxs).await,
+        TxpoolResponse::NumberOfTxs(0)
+    );
+}
+
+/// Journaled writes are persisted upon a flush, and loaded back into memory.
+#[tokio::test]
+async fn flush_and_load() {
+    let (reader, mut writer, _tempdir) = init_service();
+
+    let txs = [tx_v1_sig2(), tx_v2_rct3()];
+
+    for tx in txs {
+        let request = TxpoolWriteRequest::AddTransaction {
+            tx: Box::new(tx.clone()),
+            state_stem: false,
+        };
+        assert_eq!(
+            call(&mut writer, request).await,
+            TxpoolResponse::AddTransaction(None)
+        );
+    }
+
+    assert_eq!(
+        call(&mut writer, TxpoolWriteRequest::Flush).await,
+        TxpoolResponse::FlushOk
+    );
+
+    // The transactions are in the database.
+    let env = reader.env();
+    {
+        let env_inner = env.env_inner();
+        let tx_ro = env_inner.tx_ro().unwrap();
+        let tables = env_inner.open_tables(&tx_ro).unwrap();
+        let key_images = txs
+            .iter()
+            .map(|tx| tx_key_images(&tx.tx.prefix.inputs).count())
+            .sum::<usize>();
+
+        AssertTableLen {
+            cached_verification_states: txs.len() as u64,
+            fee_rates: txs.len() as u64,
+            spent_key_images: key_images as u64,
+            transaction_blobs: txs.len() as u64,
+            transaction_infos: txs.len() as u64,
+        }
+        .assert(&tables);
+    }
+
+    // A restarted pool would contain the same transactions.
+    let pool = MemoryPool::load(env).unwrap();
+    assert_eq!(pool.len(), txs.len());
+    for tx in txs {
+        assert_eq!(
+            pool.tx_blob(&tx.tx_hash).unwrap(),
+            (tx.tx_blob.clone(), false)
+        );
+    }
+}
+
+/// A transaction added and removed before a flush is never written,
+/// while the other journaled writes in the same batch are.
+#[tokio::test]
+async fn flush_coalesced() {
+    let (reader, mut writer, _tempdir) = init_service();
+
+    let [removed, kept] = [tx_v1_sig2(), tx_v2_rct3()];
+
+    for tx in [removed, kept] {
+        let request = TxpoolWriteRequest::AddTransaction {
+            tx: Box::new(tx.clone()),
+            state_stem: true,
+        };
+        assert_eq!(
+            call(&mut writer, request).await,
+            TxpoolResponse::AddTransaction(None)
+        );
+    }
+
+    // Entries in between the add and remove are skipped too.
+    assert_eq!(
+        call(&mut writer, TxpoolWriteRequest::Promote(removed.tx_hash)).await,
+        TxpoolResponse::PromoteOk
+    );
+    assert_eq!(
+        call(
+            &mut writer,
+            TxpoolWriteRequest::RemoveTransaction(removed.tx_hash)
+        )
+        .await,
+        TxpoolResponse::RemoveTransactionOk
+    );
+    assert_eq!(
+        call(&mut writer, TxpoolWriteRequest::Flush).await,
+        TxpoolResponse::FlushOk
+    );
+
+    // Only the kept transaction is in the database.
+    let env = reader.env();
+    {
+        let env_inner = env.env_inner();
+        let tx_ro = env_inner.tx_ro().unwrap();
+        let tables = env_inner.open_tables(&tx_ro).unwrap();
+
+        AssertTableLen {
+            cached_verification_states: 1,
+            fee_rates: 1,
+            spent_key_images: tx_key_images(&kept.tx.prefix.inputs).count() as u64,
+            transaction_blobs: 1,
+            transaction_infos: 1,
+        }
+        .assert(&tables);
+    }
+
+    let pool = MemoryPool::load(env).unwrap();
+    assert_eq!(pool.len(), 1);
+    assert_eq!(
+        pool.tx_blob(&kept.tx_hash).unwrap(),
+        (kept.tx_blob.clone(), true)
+    );
+}
+
+/// Journal entries for a transaction whose add was dropped are skipped,
+/// rather than failing the whole batch.
+#[test]
+fn dropped_add_then_promote() {
+    let (env, _tempdir) = tmp_concrete_env();
+
+    let tx = tx_v2_rct3();
+    let mut double_spend = tx.clone();
+    double_spend.tx_hash = [0xFF; 32];
+
+    let add = |tx: &VerifiedTransactionInformation| JournalEntry::AddTransaction {
+        tx: Box::new(tx.clone()),
+        state_stem: true,
+    };
+
+    write_entries(&env, &[&add(tx)]).unwrap();
+
+    // The double spend's add writes nothing, the entries after it must still apply.
+    let entries = [
+        add(&double_spend),
+        JournalEntry::Promote(double_spend.tx_hash),
+        JournalEntry::UpdateVerificationState {
+            tx_hash: double_spend.tx_hash,
+            state: CachedVerificationState::NotVerified,
+        },
+        JournalEntry::Promote(tx.tx_hash),
+    ];
+    write_entries(&env, &entries.iter().collect::<Vec<_>>()).unwrap();
+
+    let env_inner = env.env_inner();
+    let tx_ro = env_inner.tx_ro().unwrap();
+    let tables = env_inner.open_tables(&tx_ro).unwrap();
+
+    AssertTableLen {
+        cached_verification_states: 1,
+        fee_rates: 1,
+        spent_key_images: tx_key_images(&tx.tx.prefix.inputs).count() as u64,
+        transaction_blobs: 1,
+        transaction_infos: 1,
+    }
+    .assert(&tables);
+    assert!(!tx::transaction_exists(&double_spend.tx_hash, tables.transaction_infos()).unwrap());
+    assert!(tx::transaction_exists(&tx.tx_hash, tables.transaction_infos()).unwrap());
+}
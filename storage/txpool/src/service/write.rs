@@ -0,0 +1,566 @@
+//! Txpool writer definitions and logic.
+//!
+//! Write requests are applied to the in-memory pool within
+//! [`tower::Service::call`], and then appended to a journal (a channel)
+//! that the single writer thread persists to the database in batches.
+
+//---------------------------------------------------------------------------------------------------- Import
+use std::{
+    collections::HashMap,
+    sync::Arc,
+    task::{Context, Poll},
+    time::{Duration, Instant},
+};
+
+use futures::channel::oneshot;
+
+use cuprate_database::{ConcreteEnv, Env, EnvInner, RuntimeError, TxRw};
+use cuprate_helper::asynch::InfallibleOneshotReceiver;
+use cuprate_types::VerifiedTransactionInformation;
+
+use crate::{
+    open_tables::OpenTables,
+    ops::tx,
+    service::{
+        interface::{TxpoolResponse, TxpoolWriteRequest},
+        memory::MemoryPool,
+        types::{ResponseReceiver, ResponseResult, ResponseSender},
+    },
+    tables::TablesMut,
+    types::{CachedVerificationState, KeyImage, TransactionHash, TransactionWeight},
+};
+
+//---------------------------------------------------------------------------------------------------- Constants
+/// Name of the writer thread.
+const WRITER_THREAD_NAME: &str = concat!(module_path!(), "::DatabaseWriter");
+
+/// How long the writer waits for more [`JournalEntry`]s
+/// after receiving one, before writing them all.
+///
+/// This bounds how far the database lags behind the in-memory pool.
+const JOURNAL_FLUSH_INTERVAL: Duration = Duration::from_millis(500);
+
+/// The maximum amount of [`JournalEntry`]s the writer will write within 1 write transaction.
+const JOURNAL_GROUP_LIMIT: usize = 4096;
+
+/// How many times the writer will attempt to write a [`JournalEntry`]
+/// before it is dropped, see [`DatabaseWriter::write_batch`].
+const JOURNAL_WRITE_ATTEMPTS: usize = 3;
+
+//---------------------------------------------------------------------------------------------------- JournalEntry
+/// A change to the in-memory pool that must be persisted to the database.
+///
+/// Each variant (other than [`JournalEntry::Flush`]) maps 1-1
+/// to a successful [`TxpoolWriteRequest`], requests removing many transactions
+/// are journaled as a [`JournalEntry::RemoveTransaction`] per removed transaction.
+#[derive(Debug)]
+pub(super) enum JournalEntry {
+    /// [`TxpoolWriteRequest::AddTransaction`].
+    AddTransaction {
+        /// The added transaction.
+        tx: Box<VerifiedTransactionInformation>,
+        /// If the transaction was added in the stem state.
+        state_stem: bool,
+    },
+    /// [`TxpoolWriteRequest::RemoveTransaction`].
+    RemoveTransaction(TransactionHash),
+    /// [`TxpoolWriteRequest::Promote`].
+    Promote(TransactionHash),
+    /// [`TxpoolWriteRequest::UpdateVerificationState`].
+    UpdateVerificationState {
+        /// The transaction's hash.
+        tx_hash: TransactionHash,
+        /// The new verification state.
+        state: CachedVerificationState,
+    },
+    /// [`TxpoolWriteRequest::Flush`].
+    ///
+    /// The response is sent once all prior entries are committed.
+    Flush(ResponseSender),
+}
+
+//---------------------------------------------------------------------------------------------------- DatabaseWriteHandle
+/// Write handle to the txpool.
+///
+/// This is handle that allows `async`hronously writing to the pool,
+/// it is not [`Clone`]able as there is only ever 1 place within Cuprate
+/// that writes.
+///
+/// Calling [`tower::Service::call`] with a [`DatabaseWriteHandle`] & [`TxpoolWriteRequest`]
+/// will return an `async`hronous channel that can be `.await`ed upon
+/// to receive the corresponding [`TxpoolResponse`].
+///
+/// Responses are sent as soon as the in-memory pool is updated,
+/// use [`TxpoolWriteRequest::Flush`] to wait for the database.
+#[derive(Debug)]
+pub struct DatabaseWriteHandle {
+    /// The in-memory pool.
+    pool: Arc<MemoryPool>,
+
+    /// Sender channel to the database writer thread.
+    journal: crossbeam::channel::Sender<JournalEntry>,
+}
+
+impl DatabaseWriteHandle {
+    /// Initialize the single `DatabaseWriter` thread.
+    ///
+    /// `pool` must have been loaded from `env`.
+    #[cold]
+    #[inline(never)] // Only called once.
+    pub(super) fn init(env: Arc<ConcreteEnv>, pool: Arc<MemoryPool>) -> Self {
+        // Initialize the journal channel.
+        let (journal, receiver) = crossbeam::channel::unbounded();
+
+        // Spawn the writer.
+        std::thread::Builder::new()
+            .name(WRITER_THREAD_NAME.into())
+            .spawn(move || {
+                let this = DatabaseWriter {
+                    receiver,
+                    env,
+                    pending: Vec::new(),
+                    failed_attempts: 0,
+                    dropped: None,
+                };
+                DatabaseWriter::main(this);
+            })
+            .unwrap();
+
+        Self { pool, journal }
+    }
+
+    /// Append `entry` to the journal.
+    #[inline]
+    fn journal(&self, entry: JournalEntry) {
+        self.journal.send(entry).unwrap();
+    }
+}
+
+impl tower::Service<TxpoolWriteRequest> for DatabaseWriteHandle {
+    type Response = TxpoolResponse;
+    type Error = RuntimeError;
+    type Future = ResponseReceiver;
+
+    #[inline]
+    fn poll_ready(&mut self, _: &mut Context<'_>) -> Poll<Result<(), Self::Error>> {
+        Poll::Ready(Ok(()))
+    }
+
+    #[inline]
+    fn call(&mut self, request: TxpoolWriteRequest) -> Self::Future {
+        // Response channel we `.await` on.
+        let (response_sender, receiver) = oneshot::channel();
+
+        if matches!(request, TxpoolWriteRequest::Flush) {
+            // The writer responds once it is done.
+            self.journal(JournalEntry::Flush(response_sender));
+        } else {
+            // The receiver is alive, this cannot fail.
+            drop(response_sender.send(map_request(self, request)));
+        }
+
+        InfallibleOneshotReceiver::from(receiver)
+    }
+}
+
+//---------------------------------------------------------------------------------------------------- Request Mapping
+/// Map [`Request`]'s to specific pool handler functions.
+///
+/// The basic structure is:
+/// 1. `Request` is mapped to a handler function
+/// 2. Handler function is called on the in-memory pool
+/// 3. The change is journaled, if the request succeeded
+/// 4. [`TxpoolResponse`] is returned
+#[inline]
+fn map_request(handle: &DatabaseWriteHandle, request: TxpoolWriteRequest) -> ResponseResult {
+    use TxpoolWriteRequest as W;
+
+    match request {
+        W::AddTransaction { tx, state_stem } => add_transaction(handle, tx, state_stem),
+        W::RemoveTransaction(tx_hash) => remove_transaction(handle, tx_hash),
+        W::Promote(tx_hash) => promote(handle, tx_hash),
+        W::UpdateVerificationState { tx_hash, state } => {
+            update_verification_state(handle, tx_hash, state)
+        }
+        W::EvictLowestFeeRate(weight) => evict_lowest_fee_rate(handle, weight),
+        W::RemoveKeyImageSpenders(key_images) => remove_key_image_spenders(handle, &key_images),
+        W::Flush => unreachable!("flushes are sent to the writer"),
+    }
+}
+
+//---------------------------------------------------------------------------------------------------- Handler functions
+// These are the actual functions that do stuff according to the incoming [`Request`].
+//
+// Each function name is a 1-1 mapping (from CamelCase -> snake_case) to
+// the enum variant name, e.g: `AddTransaction` -> `add_transaction`.
+//
+// Each function will return the [`Response`] that we
+// should send back to the caller in [`map_request()`].
+
+/// [`TxpoolWriteRequest::AddTransaction`].
+#[inline]
+fn add_transaction(
+    handle: &DatabaseWriteHandle,
+    tx: Box<VerifiedTransactionInformation>,
+    state_stem: bool,
+) -> ResponseResult {
+    let double_spend = handle.pool.add_transaction(&tx, state_stem)?;
+
+    // Double spends do not change the pool.
+    if double_spend.is_none() {
+        handle.journal(JournalEntry::AddTransaction { tx, state_stem });
+    }
+
+    Ok(TxpoolResponse::AddTransaction(double_spend))
+}
+
+/// [`TxpoolWriteRequest::RemoveTransaction`].
+#[inline]
+fn remove_transaction(handle: &DatabaseWriteHandle, tx_hash: TransactionHash) -> ResponseResult {
+    handle.pool.remove_transaction(&tx_hash)?;
+    handle.journal(JournalEntry::RemoveTransaction(tx_hash));
+    Ok(TxpoolResponse::RemoveTransactionOk)
+}
+
+/// [`TxpoolWriteRequest::Promote`].
+#[inline]
+fn promote(handle: &DatabaseWriteHandle, tx_hash: TransactionHash) -> ResponseResult {
+    handle.pool.promote(&tx_hash)?;
+    handle.journal(JournalEntry::Promote(tx_hash));
+    Ok(TxpoolResponse::PromoteOk)
+}
+
+/// [`TxpoolWriteRequest::UpdateVerificationState`].
+#[inline]
+fn update_verification_state(
+    handle: &DatabaseWriteHandle,
+    tx_hash: TransactionHash,
+    state: CachedVerificationState,
+) -> ResponseResult {
+    handle.pool.update_verification_state(&tx_hash, state)?;
+    handle.journal(JournalEntry::UpdateVerificationState { tx_hash, state });
+    Ok(TxpoolResponse::UpdateVerificationStateOk)
+}
+
+/// [`TxpoolWriteRequest::EvictLowestFeeRate`].
+#[inline]
+#[allow(clippy::unnecessary_wraps)] // signature expected by `map_request()`
+fn evict_lowest_fee_rate(
+    handle: &DatabaseWriteHandle,
+    weight: TransactionWeight,
+) -> ResponseResult {
+    let evicted = handle.pool.evict_lowest_fee_rate(weight);
+
+    for tx_hash in &evicted {
+        handle.journal(JournalEntry::RemoveTransaction(*tx_hash));
+    }
+
+    Ok(TxpoolResponse::EvictLowestFeeRate(evicted))
+}
+
+/// [`TxpoolWriteRequest::RemoveKeyImageSpenders`].
+#[inline]
+#[allow(clippy::unnecessary_wraps)] // signature expected by `map_request()`
+fn remove_key_image_spenders(
+    handle: &DatabaseWriteHandle,
+    key_images: &[KeyImage],
+) -> ResponseResult {
+    let removed = handle.pool.remove_key_image_spenders(key_images);
+
+    for tx_hash in &removed {
+        handle.journal(JournalEntry::RemoveTransaction(*tx_hash));
+    }
+
+    Ok(TxpoolResponse::RemoveKeyImageSpenders(removed))
+}
+
+//---------------------------------------------------------------------------------------------------- DatabaseWriter
+/// The single database writer thread.
+pub(super) struct DatabaseWriter {
+    /// Receiver side of the journal.
+    receiver: crossbeam::channel::Receiver<JournalEntry>,
+
+    /// Access to the database.
+    env: Arc<ConcreteEnv>,
+
+    /// Entries of batches that failed to be written,
+    /// these are retried at the start of the next batch.
+    pending: Vec<JournalEntry>,
+
+    /// How many times the entries in `pending` have failed to be written.
+    failed_attempts: usize,
+
+    /// The error of the last entries dropped after
+    /// [`JOURNAL_WRITE_ATTEMPTS`] failed attempts,
+    /// this is returned to the next [`JournalEntry::Flush`].
+    dropped: Option<RuntimeError>,
+}
+
+impl Drop for DatabaseWriter {
+    fn drop(&mut self) {
+        // TODO: log the writer thread has exited?
+    }
+}
+
+impl DatabaseWriter {
+    /// The `DatabaseWriter`'s main function.
+    ///
+    /// The writer just loops in this function, writing journal entries
+    /// until the journal is dropped or a panic occurs.
+    #[cold]
+    #[inline(never)] // Only called once.
+    fn main(mut self) {
+        // 1. Hang on the journal
+        // 2. Collect entries until the flush interval passes (or a flush is requested)
+        // 3. Write all the entries within 1 transaction and commit
+        // 4. Respond to the flush, if any
+        loop {
+            let Ok(entry) = self.receiver.recv() else {
+                // If this receive errors, it means that the channel is empty
+                // and disconnected, meaning the write handle has been dropped
+                // and all of its entries are written. This means "shutdown",
+                // and we return here to exit the thread.
+                //
+                // Previously failed entries get 1 last attempt.
+                if !self.pending.is_empty() {
+                    self.write_batch(Vec::new());
+                }
+                return;
+            };
+
+            let deadline = Instant::now() + JOURNAL_FLUSH_INTERVAL;
+            let mut batch = vec![entry];
+
+            while batch.len() < JOURNAL_GROUP_LIMIT
+                && !matches!(batch.last(), Some(JournalEntry::Flush(_)))
+            {
+                // This also stops on disconnection, the
+                // next `recv()` will drain whatever is left.
+                let Ok(entry) = self.receiver.recv_deadline(deadline) else {
+                    break;
+                };
+                batch.push(entry);
+            }
+
+            self.write_batch(batch);
+        }
+    }
+
+    /// Write a batch of [`JournalEntry`]s within 1 write transaction.
+    ///
+    /// # Failures
+    /// If the write fails, the entries are kept and retried (in order) at the
+    /// start of the next batch, until they have failed [`JOURNAL_WRITE_ATTEMPTS`]
+    /// times, after which they are dropped. The in-memory pool is still correct,
+    /// the dropped entries are only lost upon restarting.
+    ///
+    /// A flush responds with the error if its batch failed to be written,
+    /// or if entries were dropped since the previous flush.
+    ///
+    /// INVARIANT: only the last entry can be a [`JournalEntry::Flush`].
+    #[inline]
+    fn write_batch(&mut self, mut batch: Vec<JournalEntry>) {
+        let flush = match batch.pop() {
+            Some(JournalEntry::Flush(response_sender)) => Some(response_sender),
+            Some(entry) => {
+                batch.push(entry);
+                None
+            }
+            None => None,
+        };
+
+        // Retry the previously failed entries first.
+        let mut entries = std::mem::take(&mut self.pending);
+        entries.append(&mut batch);
+
+        let result = {
+            let skip = coalesce(&entries);
+            let entries = entries
+                .iter()
+                .zip(skip)
+                .filter_map(|(entry, skip)| (!skip).then_some(entry))
+                .collect::<Vec<_>>();
+
+            if entries.is_empty() {
+                Ok(())
+            } else {
+                self.env.retry_on_resize(|env| write_entries(env, &entries))
+            }
+        };
+
+        let result = match result {
+            Ok(()) => {
+                self.failed_attempts = 0;
+                match self.dropped.take() {
+                    Some(e) => Err(e),
+                    None => Ok(()),
+                }
+            }
+            Err(e) => {
+                self.failed_attempts += 1;
+
+                // TODO: use tracing.
+                println!("database writer failed to write txpool journal: {e:?}");
+
+                if self.failed_attempts < JOURNAL_WRITE_ATTEMPTS {
+                    self.pending = entries;
+                } else {
+                    // TODO: use tracing.
+                    println!(
+                        "database writer dropped {} txpool journal entries",
+                        entries.len()
+                    );
+                    self.failed_attempts = 0;
+                }
+
+                Err(e)
+            }
+        };
+
+        match (flush, result) {
+            (Some(response_sender), result) => {
+                send_response(response_sender, result.map(|()| TxpoolResponse::FlushOk));
+            }
+            (None, Err(e)) if self.pending.is_empty() => {
+                // The entries were dropped, report it to the next flush.
+                self.dropped = Some(e);
+            }
+            (None, _) => (),
+        }
+    }
+}
+
+/// Send a response back to the requester, whether if it's an `Ok` or `Err`.
+#[inline]
+fn send_response(response_sender: ResponseSender, response: ResponseResult) {
+    if let Err(e) = response_sender.send(response) {
+        // TODO: use tracing.
+        println!("database writer failed to send response: {e:?}");
+    }
+}
+
+/// Find the [`JournalEntry`]s in `batch` that do not need to be written.
+///
+/// A transaction that is both added and removed within the same batch never
+/// needs to touch the database, so those entries (and any in between for
+/// the same transaction) are skipped. At the chain tip, this is common as
+/// transactions are often mined shortly after being received.
+///
+/// The returned `Vec` is the same length as `batch`, `true` means skip.
+fn coalesce(batch: &[JournalEntry]) -> Vec<bool> {
+    let mut skip = vec![false; batch.len()];
+
+    // Transactions added within this batch, and the indices of their entries.
+    let mut added = HashMap::<TransactionHash, Vec<usize>>::new();
+
+    for (i, entry) in batch.iter().enumerate() {
+        match entry {
+            JournalEntry::AddTransaction { tx, .. } => {
+                added.insert(tx.tx_hash, vec![i]);
+            }
+            JournalEntry::Promote(tx_hash)
+            | JournalEntry::UpdateVerificationState { tx_hash, .. } => {
+                if let Some(indices) = added.get_mut(tx_hash) {
+                    indices.push(i);
+                }
+            }
+            JournalEntry::RemoveTransaction(tx_hash) => {
+                if let Some(indices) = added.remove(tx_hash) {
+                    for j in indices {
+                        skip[j] = true;
+                    }
+                    skip[i] = true;
+                }
+            }
+            JournalEntry::Flush(_) => (),
+        }
+    }
+
+    skip
+}
+
+/// Write all `entries` within a single write transaction.
+///
+/// Upon [`Ok`], the transaction has been committed.
+///
+/// Upon [`Err`], the transaction has been aborted, i.e. none of the entries took effect.
+pub(super) fn write_entries(
+    env: &ConcreteEnv,
+    entries: &[&JournalEntry],
+) -> Result<(), RuntimeError> {
+    let env_inner = env.env_inner();
+    let tx_rw = env_inner.tx_rw()?;
+
+    let result = {
+        let mut tables_mut = env_inner.open_tables_mut(&tx_rw)?;
+        entries
+            .iter()
+            .try_for_each(|entry| write_entry(&mut tables_mut, entry))
+    };
+
+    match result {
+        Ok(()) => TxRw::commit(tx_rw),
+        Err(e) => {
+            // INVARIANT: ensure database atomicity by aborting
+            // the transaction on failures.
+            TxRw::abort(tx_rw)
+                .expect("could not maintain database atomicity by aborting write transaction");
+            Err(e)
+        }
+    }
+}
+
+/// Write a single [`JournalEntry`] to the database.
+///
+/// The database mirrors the in-memory pool, so the entry should always apply.
+///
+/// Entries that were already applied (the transaction to add already exists,
+/// or the transaction to remove does not) are skipped, this is checked before
+/// anything is written. Entries updating a transaction that is not in the
+/// database are skipped too, its add may have been dropped as a double spend
+/// or with a batch that failed all attempts. Any other error fails the whole batch, as the entry
+/// may have been partially written.
+#[inline]
+fn write_entry(tables_mut: &mut impl TablesMut, entry: &JournalEntry) -> Result<(), RuntimeError> {
+    match entry {
+        JournalEntry::AddTransaction { tx, state_stem } => {
+            if tx::transaction_exists(&tx.tx_hash, tables_mut.transaction_infos())? {
+                return Ok(());
+            }
+
+            if let Some(double_spend) = tx::add_transaction(tx, *state_stem, tables_mut)? {
+                // Nothing was written for this entry.
+                //
+                // TODO: use tracing.
+                println!(
+                    "txpool journal: {:?} double spends persisted {double_spend:?}",
+                    tx.tx_hash
+                );
+            }
+
+            Ok(())
+        }
+        JournalEntry::RemoveTransaction(tx_hash) => {
+            if !tx::transaction_exists(tx_hash, tables_mut.transaction_infos())? {
+                return Ok(());
+            }
+
+            tx::remove_transaction(tx_hash, tables_mut).map(|_| ())
+        }
+        JournalEntry::Promote(tx_hash) => {
+            if !tx::transaction_exists(tx_hash, tables_mut.transaction_infos())? {
+                return Ok(());
+            }
+
+            tx::promote(tx_hash, tables_mut)
+        }
+        JournalEntry::UpdateVerificationState { tx_hash, state } => {
+            if !tx::transaction_exists(tx_hash, tables_mut.transaction_infos())? {
+                return Ok(());
+            }
+
+            tx::update_verification_state(tx_hash, *state, tables_mut)
+        }
+        JournalEntry::Flush(_) => Ok(()),
+    }
+}
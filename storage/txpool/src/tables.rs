@@ -0,0 +1,374 @@
+//! Database tables.
+//!
+//! # Table marker structs
+//! This module contains all the table definitions used by `cuprate_txpool`.
+//!
+//! The zero-sized structs here represents the table type;
+//! they all are essentially marker types that implement [`Table`].
+//!
+//! Table structs are `CamelCase`, and their static string
+//! names used by the actual database backend are `snake_case`.
+//!
+//! For example: [`TransactionBlobs`] -> `transaction_blobs`.
+//!
+//! # Traits
+//! This module also contains a set of traits for
+//! accessing _all_ tables defined here at once.
+//!
+//! For example, this is the object returned by [`OpenTables::open_tables`](crate::OpenTables::open_tables).
+
+//---------------------------------------------------------------------------------------------------- Import
+use cuprate_database::{DatabaseIter, DatabaseRo, DatabaseRw, Table, TableStats};
+
+use crate::types::{
+    FeeRateKey, KeyImage, RawCachedVerificationState, TransactionBlob, TransactionHash,
+    TransactionInfo, TransactionWeight,
+};
+
+//---------------------------------------------------------------------------------------------------- Sealed
+/// Private module, should not be accessible outside this crate.
+pub(super) mod private {
+    /// Private sealed trait.
+    ///
+    /// Cannot be implemented outside this crate.
+    pub trait Sealed {}
+}
+
+//---------------------------------------------------------------------------------------------------- `trait Tables[Mut]`
+/// Creates:
+/// - `pub trait Tables`
+/// - `pub trait TablesIter`
+/// - `pub trait TablesMut`
+/// - Blanket implementation for `(tuples, containing, all, open, database, tables, ...)`
+///
+/// For why this exists, see: <https://github.com/Cuprate/cuprate/pull/102#pullrequestreview-1978348871>.
+macro_rules! define_trait_tables {
+    ($(
+        // The `T: Table` type     The index in a tuple
+        // |                       containing all tables
+        // v                         v
+        $table:ident => $index:literal
+    ),* $(,)?) => { paste::paste! {
+        /// Object containing all opened [`Table`]s in read-only mode.
+        ///
+        /// This is an encapsulated object that contains all
+        /// available [`Table`]'s in read-only mode.
+        ///
+        /// It is a `Sealed` trait and is only implemented on a
+        /// `(tuple, containing, all, table, types, ...)`.
+        ///
+        /// This is used to return a _single_ object from functions like
+        /// [`OpenTables::open_tables`](crate::OpenTables::open_tables) rather
+        /// than the tuple containing the tables itself.
+        ///
+        /// To replace `tuple.0` style indexing, `field_accessor_functions()`
+        /// are provided on this trait, which essentially map the object to
+        /// fields containing the particular database table, for example:
+        /// ```rust,ignore
+        /// let tables = open_tables();
+        ///
+        /// // The accessor function `transaction_infos()` returns the field
+        /// // containing an open database table for `TransactionInfos`.
+        /// let _ = tables.transaction_infos();
+        /// ```
+        ///
+        /// See also:
+        /// - [`TablesMut`]
+        /// - [`TablesIter`]
+        pub trait Tables: private::Sealed {
+            // This expands to creating `fn field_accessor_functions()`
+            // for each passed `$table` type.
+            //
+            // It is essentially a mapping to the field
+            // containing the proper opened database table.
+            //
+            // The function name of the function is
+            // the table type in `snake_case`, e.g., `block_info_v1s()`.
+            $(
+                /// Access an opened
+                #[doc = concat!("[`", stringify!($table), "`]")]
+                /// database.
+                fn [<$table:snake>](&self) -> &impl DatabaseRo<$table>;
+            )*
+
+            /// This returns `true` if all tables are empty.
+            ///
+            /// # Errors
+            /// This returns errors on regular database errors.
+            fn all_tables_empty(&self) -> Result<bool, cuprate_database::RuntimeError>;
+
+            /// This returns the name and [`TableStats`] of all tables,
+            /// in the order they are defined.
+            ///
+            /// # Errors
+            /// This returns errors on regular database errors.
+            fn all_tables_stats(&self) -> Result<Vec<(&'static str, TableStats)>, cuprate_database::RuntimeError>;
+        }
+
+        /// Object containing all opened [`Table`]s in read + iter mode.
+        ///
+        /// This is the same as [`Tables`] but includes `_iter()` variants.
+        ///
+        /// Note that this trait is a supertrait of `Tables`,
+        /// as in it can use all of its functions as well.
+        ///
+        /// See [`Tables`] for documentation - this trait exists for the same reasons.
+        pub trait TablesIter: private::Sealed + Tables {
+            $(
+                /// Access an opened read-only + iterable
+                #[doc = concat!("[`", stringify!($table), "`]")]
+                /// database.
+                fn [<$table:snake _iter>](&self) -> &(impl DatabaseRo<$table> + DatabaseIter<$table>);
+            )*
+        }
+
+        /// Object containing all opened [`Table`]s in write mode.
+        ///
+        /// This is the same as [`Tables`] but for mutable accesses.
+        ///
+        /// Note that this trait is a supertrait of `Tables`,
+        /// as in it can use all of its functions as well.
+        ///
+        /// See [`Tables`] for documentation - this trait exists for the same reasons.
+        pub trait TablesMut: private::Sealed + Tables {
+            $(
+                /// Access an opened
+                #[doc = concat!("[`", stringify!($table), "`]")]
+                /// database.
+                fn [<$table:snake _mut>](&mut self) -> &mut impl DatabaseRw<$table>;
+            )*
+        }
+
+        // Implement `Sealed` for all table types.
+        impl<$([<$table:upper>]),*> private::Sealed for ($([<$table:upper>]),*) {}
+
+        // This creates a blanket-implementation for
+        // `(tuple, containing, all, table, types)`.
+        //
+        // There is a generic defined here _for each_ `$table` input.
+        // Specifically, the generic letters are just the table types in UPPERCASE.
+        // Concretely, this expands to something like:
+        // ```rust
+        // impl<BLOCKINFOSV1S, BLOCKINFOSV2S, BLOCKINFOSV3S, [...]>
+        // ```
+        impl<$([<$table:upper>]),*> Tables
+            // We are implementing `Tables` on a tuple that
+            // contains all those generics specified, i.e.,
+            // a tuple containing all open table types.
+            //
+            // Concretely, this expands to something like:
+            // ```rust
+            // (BLOCKINFOSV1S, BLOCKINFOSV2S, BLOCKINFOSV3S, [...])
+            // ```
+            // which is just a tuple of the generics defined above.
+            for ($([<$table:upper>]),*)
+        where
+            // This expands to a where bound that asserts each element
+            // in the tuple implements some database table type.
+            //
+            // Concretely, this expands to something like:
+            // ```rust
+            // BLOCKINFOSV1S: DatabaseRo<BlockInfoV1s> + DatabaseIter<BlockInfoV1s>,
+            // BLOCKINFOSV2S: DatabaseRo<BlockInfoV2s> + DatabaseIter<BlockInfoV2s>,
+            // [...]
+            // ```
+            $(
+                [<$table:upper>]: DatabaseRo<$table>,
+            )*
+        {
+            $(
+                // The function name of the accessor function is
+                // the table type in `snake_case`, e.g., `block_info_v1s()`.
+                #[inline]
+                fn [<$table:snake>](&self) -> &impl DatabaseRo<$table> {
+                    // The index of the database table in
+                    // the tuple implements the table trait.
+                    &self.$index
+                }
+            )*
+
+            fn all_tables_empty(&self) -> Result<bool, cuprate_database::RuntimeError> {
+                $(
+                     if !DatabaseRo::is_empty(&self.$index)? {
+                        return Ok(false);
+                     }
+                )*
+                Ok(true)
+            }
+
+            fn all_tables_stats(&self) -> Result<Vec<(&'static str, TableStats)>, cuprate_database::RuntimeError> {
+                Ok(vec![
+                    $(
+                        (<$table as Table>::NAME, DatabaseRo::stats(&self.$index)?),
+                    )*
+                ])
+            }
+        }
+
+        // This is the same as the above
+        // `Tables`, but for `TablesIter`.
+        impl<$([<$table:upper>]),*> TablesIter
+            for ($([<$table:upper>]),*)
+        where
+            $(
+                [<$table:upper>]: DatabaseRo<$table> + DatabaseIter<$table>,
+            )*
+        {
+            $(
+                // The function name of the accessor function is
+                // the table type in `snake_case` + `_iter`, e.g., `block_info_v1s_iter()`.
+                #[inline]
+                fn [<$table:snake _iter>](&self) -> &(impl DatabaseRo<$table> + DatabaseIter<$table>) {
+                    &self.$index
+                }
+            )*
+        }
+
+        // This is the same as the above
+        // `Tables`, but for `TablesMut`.
+        impl<$([<$table:upper>]),*> TablesMut
+            for ($([<$table:upper>]),*)
+        where
+            $(
+                [<$table:upper>]: DatabaseRw<$table>,
+            )*
+        {
+            $(
+                // The function name of the mutable accessor function is
+                // the table type in `snake_case` + `_mut`, e.g., `block_info_v1s_mut()`.
+                #[inline]
+                fn [<$table:snake _mut>](&mut self) -> &mut impl DatabaseRw<$table> {
+                    &mut self.$index
+                }
+            )*
+        }
+    }};
+}
+
+// Input format: $table_type => $index
+//
+// The $index:
+// - Simply increments by 1 for each table
+// - Must be 0..
+// - Must end at the total amount of table types - 1
+//
+// Compile errors will occur if these aren't satisfied.
+//
+// $index is just the `tuple.$index`, as the above [`define_trait_tables`]
+// macro has a blanket impl for `(all, table, types, ...)` and we must map
+// each type to a tuple index explicitly.
+//
+// FIXME: there's definitely an automatic way to this :)
+define_trait_tables! {
+    CachedVerificationStates => 0,
+    FeeRates => 1,
+    SpentKeyImages => 2,
+    TransactionBlobs => 3,
+    TransactionInfos => 4,
+}
+
+//---------------------------------------------------------------------------------------------------- Table macro
+/// Create all tables, should be used _once_.
+///
+/// Generating this macro once and using `$()*` is probably
+/// faster for compile times than calling the macro _per_ table.
+///
+/// All tables are zero-sized table structs, and implement the `Table` trait.
+///
+/// Table structs are automatically `CamelCase`,
+/// and their static string names are automatically `snake_case`.
+macro_rules! tables {
+    (
+        $(
+            $(#[$attr:meta])* // Documentation and any `derive`'s.
+            $table:ident,     // The table name + doubles as the table struct name.
+            $key:ty =>        // Key type.
+            $value:ty         // Value type.
+        ),* $(,)?
+    ) => {
+        paste::paste! { $(
+            // Table struct.
+            $(#[$attr])*
+            // The below test show the `snake_case` table name in cargo docs.
+            #[doc = concat!("- Key: [`", stringify!($key), "`]")]
+            #[doc = concat!("- Value: [`", stringify!($value), "`]")]
+            ///
+            /// ## Table Name
+            /// ```rust
+            /// # use cuprate_txpool::{*,tables::*};
+            /// use cuprate_database::Table;
+            #[doc = concat!(
+                "assert_eq!(",
+                stringify!([<$table:camel>]),
+                "::NAME, \"",
+                stringify!([<$table:snake>]),
+                "\");",
+            )]
+            /// ```
+            #[cfg_attr(feature = "serde", derive(serde::Serialize, serde::Deserialize))]
+            #[derive(Copy, Clone, Debug, PartialEq, PartialOrd, Eq, Ord, Hash)]
+            pub struct [<$table:camel>];
+
+            // Implement the `Sealed` in this file.
+            // Required by `Table`.
+            impl private::Sealed for [<$table:camel>] {}
+
+            // Table trait impl.
+            impl Table for [<$table:camel>] {
+                const NAME: &'static str = stringify!([<$table:snake>]);
+                type Key = $key;
+                type Value = $value;
+            }
+        )* }
+    };
+}
+
+//---------------------------------------------------------------------------------------------------- Tables
+// Notes:
+// - Keep this sorted A-Z (by table name)
+// - Tables are defined in plural to avoid name conflicts with types
+// - If adding/changing a table also edit:
+//   - `call_fn_on_all_tables_or_early_return!()` macro in `src/open_tables.rs`
+//   - `AssertTableLen` in `src/tests.rs`
+tables! {
+    /// Cached transaction verification states.
+    ///
+    /// Contains the chain state each transaction was last verified against.
+    CachedVerificationStates,
+    TransactionHash => RawCachedVerificationState,
+
+    /// The fee-per-byte index.
+    ///
+    /// Contains all transactions sorted from the highest to
+    /// the lowest fee-per-byte, see [`FeeRateKey`].
+    ///
+    /// The value is the transaction's weight, such that block
+    /// templates can be filled by only iterating this table.
+    FeeRates,
+    FeeRateKey => TransactionWeight,
+
+    /// Spent key images.
+    ///
+    /// Contains all key images spent by transactions in the pool,
+    /// mapped to the transaction that spends it.
+    SpentKeyImages,
+    KeyImage => TransactionHash,
+
+    /// Transaction blobs (bytes).
+    ///
+    /// Contains the serialized version of all transactions.
+    TransactionBlobs,
+    TransactionHash => TransactionBlob,
+
+    /// Transaction information.
+    ///
+    /// Contains metadata of all transactions.
+    TransactionInfos,
+    TransactionHash => TransactionInfo,
+}
+
+//---------------------------------------------------------------------------------------------------- Tests
+#[cfg(test)]
+mod test {
+    // use super::*;
+}
@@ -0,0 +1,66 @@
+//! Utilities for `cuprate_txpool` testing.
+//!
+//! These types/fn's are only:
+//! - enabled on #[cfg(test)]
+//! - only used internally
+
+//---------------------------------------------------------------------------------------------------- Import
+use std::borrow::Cow;
+
+use pretty_assertions::assert_eq;
+
+use cuprate_database::{ConcreteEnv, DatabaseRo, Env, EnvInner};
+
+use crate::{config::ConfigBuilder, open_tables::OpenTables, tables::Tables};
+
+//---------------------------------------------------------------------------------------------------- Struct
+/// Named struct to assert the length of all tables.
+///
+/// This is a struct with fields instead of a function
+/// so that callers can name arguments, otherwise the call-site
+/// is a little confusing, i.e. `assert_table_len(0, 25, 1, 123)`.
+#[derive(Copy, Clone, Debug, Default, PartialEq, Eq, PartialOrd, Ord, Hash)]
+pub(crate) struct AssertTableLen {
+    pub(crate) cached_verification_states: u64,
+    pub(crate) fee_rates: u64,
+    pub(crate) spent_key_images: u64,
+    pub(crate) transaction_blobs: u64,
+    pub(crate) transaction_infos: u64,
+}
+
+impl AssertTableLen {
+    /// Assert the length of all tables.
+    pub(crate) fn assert(self, tables: &impl Tables) {
+        let other = Self {
+            cached_verification_states: tables.cached_verification_states().len().unwrap(),
+            fee_rates: tables.fee_rates().len().unwrap(),
+            spent_key_images: tables.spent_key_images().len().unwrap(),
+            transaction_blobs: tables.transaction_blobs().len().unwrap(),
+            transaction_infos: tables.transaction_infos().len().unwrap(),
+        };
+
+        assert_eq!(self, other);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------- fn
+/// Create an `Env` in a temporarily directory.
+/// The directory is automatically removed after the `TempDir` is dropped.
+pub(crate) fn tmp_concrete_env() -> (ConcreteEnv, tempfile::TempDir) {
+    let tempdir = tempfile::tempdir().unwrap();
+    let config = ConfigBuilder::new()
+        .db_directory(Cow::Owned(tempdir.path().into()))
+        .low_power()
+        .build();
+    let env = crate::open(config).unwrap();
+
+    (env, tempdir)
+}
+
+/// Assert all the tables in the environment are empty.
+pub(crate) fn assert_all_tables_are_empty(env: &ConcreteEnv) {
+    let env_inner = env.env_inner();
+    let tx_ro = env_inner.tx_ro().unwrap();
+    let tables = env_inner.open_tables(&tx_ro).unwrap();
+    assert!(tables.all_tables_empty().unwrap());
+}
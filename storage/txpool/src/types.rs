@@ -0,0 +1,334 @@
+//! Database [table](crate::tables) types.
+//!
+//! This module contains all types used by the database tables,
+//! and aliases for common Monero-related types that use the same underlying
+//! primitive type.
+//!
+//! See `cuprate_blockchain`'s `types` module for the
+//! `bytemuck` invariants these types must uphold.
+
+// actually i still don't trust you. no unsafe.
+#![forbid(unsafe_code)] // if you remove this line i will steal your monero
+
+//---------------------------------------------------------------------------------------------------- Import
+use bytemuck::{Pod, Zeroable};
+
+use cuprate_database::{Key, StorableVec};
+
+//---------------------------------------------------------------------------------------------------- Aliases
+// These type aliases exist as many Monero-related types are the exact same.
+// For clarity, they're given type aliases as to not confuse them.
+
+/// A block's hash.
+pub type BlockHash = [u8; 32];
+
+/// A transaction's fee-per-byte, i.e. its fee divided by its weight.
+pub type FeePerByte = u64;
+
+/// A key image.
+pub type KeyImage = [u8; 32];
+
+/// A serialized transaction.
+pub type TransactionBlob = StorableVec<u8>;
+
+/// A transaction's hash.
+pub type TransactionHash = [u8; 32];
+
+/// A transaction's weight.
+pub type TransactionWeight = u64;
+
+//---------------------------------------------------------------------------------------------------- TxStateFlags
+bitflags::bitflags! {
+    /// Bit flags for the state of a transaction in the pool.
+    ///
+    /// ```rust
+    /// # use cuprate_txpool::types::*;
+    /// use cuprate_database::Storable;
+    ///
+    /// // Assert Storable is correct.
+    /// let a = TxStateFlags::STATE_STEM;
+    /// let b = Storable::as_bytes(&a);
+    /// let c: TxStateFlags = Storable::from_bytes(b);
+    /// assert_eq!(a, c);
+    /// ```
+    ///
+    /// # Size & Alignment
+    /// ```rust
+    /// # use cuprate_txpool::types::*;
+    /// # use std::mem::*;
+    /// assert_eq!(size_of::<TxStateFlags>(), 1);
+    /// assert_eq!(align_of::<TxStateFlags>(), 1);
+    /// ```
+    #[derive(Copy, Clone, Debug, PartialEq, PartialOrd, Eq, Ord, Hash, Pod, Zeroable)]
+    #[repr(transparent)]
+    pub struct TxStateFlags: u8 {
+        /// This transaction is in the Dandelion++ stem state.
+        ///
+        /// Stem transactions must not be broadcast (fluffed)
+        /// or included in block templates.
+        const STATE_STEM = 0b0000_0001;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------- TransactionInfo
+/// Information on a transaction in the pool.
+///
+/// This is the value in the [`TransactionInfos`](crate::tables::TransactionInfos) table.
+///
+/// ```rust
+/// # use cuprate_txpool::types::*;
+/// use cuprate_database::Storable;
+///
+/// // Assert Storable is correct.
+/// let a = TransactionInfo {
+///     fee: 1,
+///     weight: 2,
+///     received_at: 3,
+///     flags: TxStateFlags::STATE_STEM,
+///     _padding: [0; 7],
+/// };
+/// let b = Storable::as_bytes(&a);
+/// let c: TransactionInfo = Storable::from_bytes(b);
+/// assert_eq!(a, c);
+/// ```
+///
+/// # Size & Alignment
+/// ```rust
+/// # use cuprate_txpool::types::*;
+/// # use std::mem::*;
+/// assert_eq!(size_of::<TransactionInfo>(), 32);
+/// assert_eq!(align_of::<TransactionInfo>(), 8);
+/// ```
+#[derive(Copy, Clone, Debug, PartialEq, PartialOrd, Eq, Ord, Hash, Pod, Zeroable)]
+#[repr(C)]
+pub struct TransactionInfo {
+    /// The transaction's total fee.
+    pub fee: u64,
+    /// The transaction's weight.
+    pub weight: TransactionWeight,
+    /// The UNIX timestamp of when this transaction was added to the pool.
+    pub received_at: u64,
+    /// The state of this transaction.
+    pub flags: TxStateFlags,
+    /// Explicit padding, `bytemuck` does not allow implicit padding.
+    ///
+    /// This should always be zeroed.
+    #[allow(clippy::pub_underscore_fields)]
+    pub _padding: [u8; 7],
+}
+
+impl TransactionInfo {
+    /// This transaction's [`FeePerByte`].
+    ///
+    /// Transactions with a weight of `0` (which are invalid) have a fee-per-byte of `fee`.
+    ///
+    /// ```rust
+    /// # use cuprate_txpool::types::*;
+    /// let info = TransactionInfo {
+    ///     fee: 1_000,
+    ///     weight: 100,
+    ///     received_at: 0,
+    ///     flags: TxStateFlags::empty(),
+    ///     _padding: [0; 7],
+    /// };
+    /// assert_eq!(info.fee_per_byte(), 10);
+    /// ```
+    #[inline]
+    pub const fn fee_per_byte(&self) -> FeePerByte {
+        if self.weight == 0 {
+            self.fee
+        } else {
+            self.fee / self.weight
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------- FeeRateKey
+/// The key to the [`FeeRates`](crate::tables::FeeRates) table.
+///
+/// This is a transaction's [`FeePerByte`] followed by its [`TransactionHash`],
+/// which makes each key unique even if transactions have the same fee-per-byte.
+///
+/// # Ordering
+/// The fee-per-byte is stored as its bitwise-NOT in big-endian, so a straight byte
+/// comparison (the default [`Key`] comparison) sorts keys from the _highest_ to the
+/// _lowest_ fee-per-byte, for both database backends.
+///
+/// ```rust
+/// # use cuprate_txpool::types::*;
+/// use cuprate_database::{Key, Storable};
+///
+/// let high = FeeRateKey::new(1_000, [0; 32]);
+/// let low = FeeRateKey::new(999, [255; 32]);
+/// assert_eq!(high.fee_per_byte(), 1_000);
+///
+/// // Higher fee-per-bytes are sorted first...
+/// assert!(high < low);
+/// // ...by the database as well.
+/// let compare = <FeeRateKey as Key>::KEY_COMPARE.as_compare_fn::<FeeRateKey>();
+/// assert_eq!(
+///     compare(Storable::as_bytes(&high), Storable::as_bytes(&low)),
+///     std::cmp::Ordering::Less,
+/// );
+/// ```
+///
+/// # Size & Alignment
+/// ```rust
+/// # use cuprate_txpool::types::*;
+/// # use std::mem::*;
+/// assert_eq!(size_of::<FeeRateKey>(), 40);
+/// assert_eq!(align_of::<FeeRateKey>(), 1);
+/// ```
+#[derive(Copy, Clone, Debug, PartialEq, PartialOrd, Eq, Ord, Hash, Pod, Zeroable)]
+#[repr(C)]
+pub struct FeeRateKey {
+    /// The bitwise-NOT of the fee-per-byte, in big-endian.
+    inverted_fee_per_byte: [u8; 8],
+    /// The transaction's hash.
+    pub tx_hash: TransactionHash,
+}
+
+impl FeeRateKey {
+    /// Create a new [`FeeRateKey`].
+    #[inline]
+    pub const fn new(fee_per_byte: FeePerByte, tx_hash: TransactionHash) -> Self {
+        Self {
+            inverted_fee_per_byte: (!fee_per_byte).to_be_bytes(),
+            tx_hash,
+        }
+    }
+
+    /// Return the [`FeePerByte`] of this key.
+    #[inline]
+    pub const fn fee_per_byte(&self) -> FeePerByte {
+        !u64::from_be_bytes(self.inverted_fee_per_byte)
+    }
+}
+
+impl Key for FeeRateKey {}
+
+//---------------------------------------------------------------------------------------------------- CachedVerificationState
+/// The cached verification state of a transaction.
+///
+/// Verifying a transaction is expensive, so the pool remembers
+/// the chain state a transaction was last verified against.
+/// If the chain has not changed, it does not need to be re-verified.
+#[derive(Copy, Clone, Debug, PartialEq, Eq, Hash)]
+pub enum CachedVerificationState {
+    /// The transaction has not been verified.
+    NotVerified,
+    /// The transaction is valid at the block with this hash and hard-fork.
+    ValidAtHashAndHF {
+        /// The top block hash at verification time.
+        block_hash: BlockHash,
+        /// The hard-fork at verification time.
+        hf: u8,
+    },
+    /// The transaction is valid at the block with this hash and hard-fork,
+    /// and contains a time-based lock that is unlocked past `time_lock`.
+    ValidAtHashAndHFWithTimeBasedLock {
+        /// The top block hash at verification time.
+        block_hash: BlockHash,
+        /// The hard-fork at verification time.
+        hf: u8,
+        /// The UNIX timestamp the time-based lock expires at.
+        time_lock: u64,
+    },
+}
+
+/// The raw, storable form of [`CachedVerificationState`].
+///
+/// This is the value in the [`CachedVerificationStates`](crate::tables::CachedVerificationStates) table.
+///
+/// Use the [`From`] implementations to convert between the 2.
+///
+/// ```rust
+/// # use cuprate_txpool::types::*;
+/// use cuprate_database::Storable;
+///
+/// let state = CachedVerificationState::ValidAtHashAndHFWithTimeBasedLock {
+///     block_hash: [1; 32],
+///     hf: 16,
+///     time_lock: 123,
+/// };
+///
+/// // Assert Storable is correct.
+/// let a = RawCachedVerificationState::from(state);
+/// let b = Storable::as_bytes(&a);
+/// let c: RawCachedVerificationState = Storable::from_bytes(b);
+/// assert_eq!(a, c);
+/// assert_eq!(CachedVerificationState::from(c), state);
+///
+/// // A not verified state is always zeroed.
+/// let a = RawCachedVerificationState::from(CachedVerificationState::NotVerified);
+/// assert_eq!(CachedVerificationState::from(a), CachedVerificationState::NotVerified);
+/// ```
+///
+/// # Size & Alignment
+/// ```rust
+/// # use cuprate_txpool::types::*;
+/// # use std::mem::*;
+/// assert_eq!(size_of::<RawCachedVerificationState>(), 41);
+/// assert_eq!(align_of::<RawCachedVerificationState>(), 1);
+/// ```
+#[derive(Copy, Clone, Debug, PartialEq, PartialOrd, Eq, Ord, Hash, Pod, Zeroable)]
+#[repr(C)]
+pub struct RawCachedVerificationState {
+    /// The top block hash at verification time.
+    raw_valid_at_hash: [u8; 32],
+    /// The hard-fork at verification time.
+    ///
+    /// `0` means the transaction is not verified,
+    /// as there is no hard-fork `0`.
+    raw_hf: u8,
+    /// The time-based lock expiry in little-endian, `0` if there is none.
+    raw_valid_past_timestamp: [u8; 8],
+}
+
+impl From<CachedVerificationState> for RawCachedVerificationState {
+    fn from(state: CachedVerificationState) -> Self {
+        match state {
+            CachedVerificationState::NotVerified => Self::zeroed(),
+            CachedVerificationState::ValidAtHashAndHF { block_hash, hf } => Self {
+                raw_valid_at_hash: block_hash,
+                raw_hf: hf,
+                raw_valid_past_timestamp: [0; 8],
+            },
+            CachedVerificationState::ValidAtHashAndHFWithTimeBasedLock {
+                block_hash,
+                hf,
+                time_lock,
+            } => Self {
+                raw_valid_at_hash: block_hash,
+                raw_hf: hf,
+                raw_valid_past_timestamp: time_lock.to_le_bytes(),
+            },
+        }
+    }
+}
+
+impl From<RawCachedVerificationState> for CachedVerificationState {
+    fn from(raw: RawCachedVerificationState) -> Self {
+        if raw.raw_hf == 0 {
+            return Self::NotVerified;
+        }
+
+        match u64::from_le_bytes(raw.raw_valid_past_timestamp) {
+            0 => Self::ValidAtHashAndHF {
+                block_hash: raw.raw_valid_at_hash,
+                hf: raw.raw_hf,
+            },
+            time_lock => Self::ValidAtHashAndHFWithTimeBasedLock {
+                block_hash: raw.raw_valid_at_hash,
+                hf: raw.raw_hf,
+                time_lock,
+            },
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------- Tests
+#[cfg(test)]
+mod test {
+    // use super::*;
+}
@@ -87,6 +87,17 @@ pub enum BCReadRequest {
     ///
     /// Input is a set of key images.
     KeyImagesSpent(HashSet<[u8; 32]>),
+
+    /// Fulfill multiple requests within the same database snapshot.
+    ///
+    /// The input is a list of requests, which are handled in order.
+    ///
+    /// All requests will see the same state of the database, i.e.
+    /// a write that happens while this request is being handled
+    /// will either be visible to all of the inner requests, or none.
+    ///
+    /// If any of the inner requests fail, the whole request fails.
+    Batch(Vec<BCReadRequest>),
 }
 
 //---------------------------------------------------------------------------------------------------- WriteRequest
@@ -164,6 +175,12 @@ pub enum BCResponse {
     /// The inner value is `false` if _none_ of the key images were spent.
     KeyImagesSpent(bool),
 
+    /// Response to [`BCReadRequest::Batch`].
+    ///
+    /// Inner value is the response to each inner request,
+    /// in the same order the requests were given.
+    Batch(Vec<BCResponse>),
+
     //------------------------------------------------------ Writes
     /// Response to [`BCWriteRequest::WriteBlock`].
     ///
@@ -88,7 +88,8 @@
 
 mod types;
 pub use types::{
-    ExtendedBlockHeader, OutputOnChain, VerifiedBlockInformation, VerifiedTransactionInformation,
+    ExtendedBlockHeader, OutputOnChain, UnverifiedBlockInformation,
+    UnverifiedTransactionInformation, VerifiedBlockInformation, VerifiedTransactionInformation,
 };
 
 //---------------------------------------------------------------------------------------------------- Feature-gated
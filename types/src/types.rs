@@ -59,6 +59,48 @@ pub struct VerifiedTransactionInformation {
     pub tx_hash: [u8; 32],
 }
 
+//---------------------------------------------------------------------------------------------------- UnverifiedTransactionInformation
+/// Information of a transaction that has not been verified yet.
+///
+/// This holds the data calculated when the transaction was first
+/// deserialized, so it does not have to be calculated again.
+#[derive(Clone, Debug, PartialEq, Eq)]
+pub struct UnverifiedTransactionInformation {
+    /// The transaction itself.
+    pub tx: Transaction,
+    /// The serialized byte form of [`Self::tx`].
+    ///
+    /// This must be equal to [`Transaction::serialize`].
+    pub tx_blob: Vec<u8>,
+    /// The transaction's hash.
+    ///
+    /// This must be equal to [`Transaction::hash`].
+    pub tx_hash: [u8; 32],
+}
+
+//---------------------------------------------------------------------------------------------------- UnverifiedBlockInformation
+/// Information of a block that has not been verified yet.
+///
+/// This holds the data calculated when the block was first
+/// deserialized, so it does not have to be calculated again.
+#[derive(Clone, Debug, PartialEq, Eq)]
+pub struct UnverifiedBlockInformation {
+    /// The block itself.
+    pub block: Block,
+    /// The serialized byte form of [`Self::block`].
+    ///
+    /// This must be equal to [`Block::serialize`].
+    pub block_blob: Vec<u8>,
+    /// The block's hash.
+    ///
+    /// This must be equal to [`Block::hash`].
+    pub block_hash: [u8; 32],
+    /// All the transactions in the block, excluding the [`Block::miner_tx`].
+    ///
+    /// These are not necessarily in the order given in [`Block::txs`].
+    pub txs: Vec<UnverifiedTransactionInformation>,
+}
+
 //---------------------------------------------------------------------------------------------------- VerifiedBlockInformation
 /// Verified information of a block.
 ///